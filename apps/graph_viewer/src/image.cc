@@ -7,6 +7,7 @@
 #define STB_IMAGE_WRITE_IMPLEMENTATION
 #include "stb_image_write.h"
 
+#include <algorithm>
 #include <cmath>
 #include <iostream>
 
@@ -14,6 +15,27 @@ Image::Image(int width, int height): width(width), height(height) {
     pixels = new unsigned char[width*height*4];
 }
 
+Image::Image(const Image& other): width(other.width), height(other.height) {
+    pixels = new unsigned char[width*height*4];
+    std::copy(other.pixels, other.pixels + width*height*4, pixels);
+}
+
+Image& Image::operator=(const Image& other) {
+    if (this != &other) {
+        unsigned char* copy = new unsigned char[other.width*other.height*4];
+        std::copy(other.pixels, other.pixels + other.width*other.height*4, copy);
+        delete[] pixels;
+        pixels = copy;
+        width = other.width;
+        height = other.height;
+    }
+    return *this;
+}
+
+Image::~Image() {
+    delete[] pixels;
+}
+
 void Image::SaveAs(const std::string& filename) const {
     stbi_write_png(filename.c_str(), width, height, 4, pixels, width*4);
 }
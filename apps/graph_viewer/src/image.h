@@ -7,6 +7,9 @@
 class Image {
 public:
     Image(int width, int height);
+    Image(const Image& other);
+    Image& operator=(const Image& other);
+    ~Image();
     void SaveAs(const std::string& filename) const;
 
     Color GetPixel(int x, int y) const;
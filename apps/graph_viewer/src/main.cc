@@ -1,9 +1,18 @@
+#include <fstream>
 #include <iostream>
+#include <string>
+#include "compact_graph.h"
+#include "parsers/osm/osm_importer.h"
+#include "query_metrics.h"
 #include "routing_api.h"
+#include "segment_index.h"
 #include "image.h"
+#include "routing/arc_flags.h"
 #include "routing/astar.h"
 #include "routing/depth_first_search.h"
 #include "routing/dijkstra.h"
+#include "routing/hub_labels.h"
+#include "strategy_comparison.h"
 
 void drawPath(Image& image, const routing::BoundingBox& bb, std::vector< std::vector<float> >& path, Color color) {
     std::vector<float> lastPos;
@@ -20,34 +29,17 @@ void drawPath(Image& image, const routing::BoundingBox& bb, std::vector< std::ve
     }
 }
 
-int main(int argc, char**argv) {
-    using namespace routing;
-
-    if (argc < 3) {
-        std::cout << "Usage: ./build/bin/graph_viewer /path/to/graph /path/to/output.png" << std::endl;
-        return 0;
-    }
-
-    RoutingAPI api;
-    const IGraph* graph = api.LoadFromFile(argv[1]);
-    if (!graph) { 
-        std::cout << "Unable to parse graph file." << std::endl;
-        return 1;
-    }
-
-    BoundingBox bb = graph->GetBoundingBox();
-    std::cout << "Bounding Box: " << bb << std::endl;
-
+Image drawGraph(const routing::IGraph* graph, const routing::BoundingBox& bb) {
     float aspectRatio = (bb.max[2]-bb.min[2])/(bb.max[0] - bb.min[0]);
 
     int resolution = 1024;
     Image output(resolution,resolution*aspectRatio);
     output.Clear(Color(0,0,0,1));
 
-    const std::vector<IGraphNode*>& nodes = graph->GetNodes();
+    const std::vector<routing::IGraphNode*>& nodes = graph->GetNodes();
     for (int i = 0; i < nodes.size(); i++) {
         std::vector<float> normalizedPoint = bb.Normalize(nodes[i]->GetPosition());
-        const std::vector<IGraphNode*>& neighbors = nodes[i]->GetNeighbors();
+        const std::vector<routing::IGraphNode*>& neighbors = nodes[i]->GetNeighbors();
         for (int j = 0; j < neighbors.size(); j++) {
             std::vector<float> neighborPos = bb.Normalize(neighbors[j]->GetPosition());
             int startX = normalizedPoint[0]*output.GetWidth();
@@ -57,6 +49,121 @@ int main(int argc, char**argv) {
             output.DrawLine(startX, startY, endX, endY, Color(0.5,0.5,1,1));
         }
     }
+    return output;
+}
+
+// Runs random OD pairs through every strategy and writes the per-query
+// results to <prefix>.csv and overlays of the worst queries (optimal path in
+// green, the strategy's in red) to <prefix>-<strategy>-<rank>.png.
+int compareStrategies(const std::string& file, const std::string& prefix, int queries, unsigned seed) {
+    using namespace routing;
+
+    RoutingAPI api;
+    const IGraph* graph = api.LoadFromFile(file);
+    if (!graph) {
+        std::cout << "Unable to parse graph file." << std::endl;
+        return 1;
+    }
+
+    CompactGraph compact(graph);
+    ArcFlags flags(compact);
+    ArcFlagAStar arcFlags(flags);
+    const RoutingStrategy& astar = *api.GetStrategy("astar");
+
+    StrategyComparison comparison(graph);
+    comparison.AddStrategies(api);
+    comparison.AddStrategy(arcFlags.GetName(), arcFlags);
+    comparison.AddStrategy("astar-e0.25", astar, 0.25f);
+    comparison.AddStrategy("astar-2ms", astar, 0.05f, 2);
+    comparison.AddRandomPairs(queries, seed);
+    comparison.Run();
+
+    comparison.PrintSummary(std::cout);
+    std::ofstream csv((prefix + ".csv").c_str());
+    comparison.WriteCsv(csv);
+
+    BoundingBox bb = graph->GetBoundingBox();
+    Image background = drawGraph(graph, bb);
+    for (int i = 0; i < comparison.NumStrategies(); i++) {
+        std::vector<int> worst = comparison.Worst(i, 3);
+        for (int rank = 0; rank < worst.size(); rank++) {
+            const StrategyComparison::Sample& sample = comparison.GetSamples(i)[worst[rank]];
+            std::vector< std::vector<float> > optimal = comparison.GetOptimal(sample.pair).path;
+            std::vector< std::vector<float> > path = sample.path;
+            Image overlay = background;
+            drawPath(overlay, bb, optimal, Color(0,1,0,1));
+            drawPath(overlay, bb, path, Color(1,0,0,1));
+            overlay.SaveAs(prefix + "-" + comparison.GetName(i) + "-" + std::to_string(rank + 1) + ".png");
+        }
+    }
+
+    delete graph;
+    return 0;
+}
+
+int main(int argc, char**argv) {
+    using namespace routing;
+
+    if (argc >= 4 && std::string(argv[1]) == "--import") {
+        // convert a map too large for memory straight into a snapshot
+        OsmImporter::Options options;
+        if (argc >= 5) {
+            options.memoryBudget = std::stol(argv[4]) << 20;
+        }
+        OsmImporter::Stats stats = OsmImporter::Import(argv[2], argv[3], options);
+        std::cout << "Imported " << stats.nodes << " nodes and " << stats.edges << " edges ("
+            << stats.nodesRead << " nodes, " << stats.waySegments << " way segments read, "
+            << stats.runFiles << " run files)" << std::endl;
+        return 0;
+    }
+
+    if (argc >= 4 && std::string(argv[1]) == "--compare") {
+        int queries = argc >= 5 ? std::stoi(argv[4]) : 200;
+        unsigned seed = argc >= 6 ? std::stoul(argv[5]) : 1;
+        return compareStrategies(argv[2], argv[3], queries, seed);
+    }
+
+    if (argc < 3) {
+        std::cout << "Usage: ./build/bin/graph_viewer /path/to/graph /path/to/output.png [--hub-labels /path/to/graph.hlab] [--memory]" << std::endl;
+        std::cout << "       ./build/bin/graph_viewer --import /path/to/map.osm /path/to/map.snap [memory budget in MB]" << std::endl;
+        std::cout << "       ./build/bin/graph_viewer --compare /path/to/graph /path/to/output/prefix [queries] [seed]" << std::endl;
+        return 0;
+    }
+
+    RoutingAPI api;
+    const IGraph* graph = api.LoadFromFile(argv[1]);
+    if (!graph) { 
+        std::cout << "Unable to parse graph file." << std::endl;
+        return 1;
+    }
+
+    for (int i = 3; i < argc; i++) {
+        if (std::string(argv[i]) == "--hub-labels" && i + 1 < argc) {
+            CompactGraph compact(graph);
+            HubLabels labels(compact);
+            std::ofstream out(argv[++i], std::ios::binary);
+            labels.Save(out);
+            std::cout << "Hub labels: " << labels.NumEntries() << " entries, "
+                << labels.AverageLabelSize() << " per label" << std::endl;
+        }
+        else if (std::string(argv[i]) == "--memory") {
+            // the graph with the indices a routing server would build
+            EdgePoint point;
+            graph->NearestEdgePoint(graph->GetBoundingBox().min, point);
+            CompactGraph compact(graph);
+            HubLabels labels(compact);
+            MemoryReport report = graph->GetMemoryReport();
+            report.Merge(compact.GetMemoryReport(), "compact graph/");
+            report.Merge(labels.GetMemoryReport(), "hub labels/");
+            std::cout << "Memory:" << std::endl;
+            report.Print(std::cout);
+        }
+    }
+
+    BoundingBox bb = graph->GetBoundingBox();
+    std::cout << "Bounding Box: " << bb << std::endl;
+
+    Image output = drawGraph(graph, bb);
 
     /*for (int i = 0; i < nodes.size(); i++) {
         std::vector<float> normalizedPoint = bb.Normalize(nodes[i]->GetPosition());
@@ -78,6 +185,8 @@ int main(int argc, char**argv) {
     path = graph->GetPath(start, end, Dijkstra::Default());
     drawPath(output, bb, path, Color(1,0.5,0,1));
 
+    QueryMetrics::Global().Print(std::cout);
+
     output.SaveAs(argv[2]);
 
     delete graph;
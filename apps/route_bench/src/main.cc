@@ -0,0 +1,382 @@
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+#include "compact_graph.h"
+#include "parsers/osm/osm_graph_factory.h"
+#include "routing_api.h"
+#include "routing/arc_flags.h"
+#include "routing/hub_labels.h"
+#include "segment_index.h"
+
+// Routing micro-benchmark.  Every map is loaded with its phases timed, then
+// the same seeded random OD pairs run through each strategy registered with
+// RoutingAPI (plus the arc-flag and hub-label indices) and through
+// NearestNode / NearestEdgePoint.  Results go to stdout (or --out) as JSON so
+// runs can be diffed; progress goes to stderr.
+//
+//   route_bench [--queries N] [--seed S] [--out results.json] [map ...]
+
+using namespace routing;
+
+typedef std::chrono::steady_clock Clock;
+
+static double secondsSince(Clock::time_point start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+// Resident and peak resident set size in KB, 0 where /proc is unavailable,
+// and heap bytes in use, 0 without glibc.  Freed heap is reused before the
+// process grows, so heap deltas measure a phase better than RSS deltas.
+struct Memory {
+    long rssKb;
+    long peakKb;
+    long heapBytes;
+};
+
+static Memory readMemory() {
+    Memory memory = {0, 0, 0};
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || __GLIBC_MINOR__ >= 33)
+    memory.heapBytes = mallinfo2().uordblks;
+#endif
+    std::ifstream status("/proc/self/status");
+    std::string key;
+    while (status >> key) {
+        if (key == "VmRSS:") {
+            status >> memory.rssKb;
+        }
+        else if (key == "VmHWM:") {
+            status >> memory.peakKb;
+        }
+        status.ignore(256, '\n');
+    }
+    return memory;
+}
+
+// Minimal streaming JSON writer; keys and strings are written verbatim, so
+// they must not need escaping.
+class JsonWriter {
+public:
+    JsonWriter(std::ostream& out) : out(out) { out << std::setprecision(9); }
+
+    void Begin(const char* key, char bracket) {
+        separate(key);
+        out << bracket;
+        first.push_back(true);
+    }
+    void End(char bracket) {
+        first.pop_back();
+        out << bracket;
+        if (first.empty()) {
+            out << std::endl;
+        }
+    }
+    void Field(const char* key, double value) {
+        separate(key);
+        out << value;
+    }
+    void Field(const char* key, const std::string& value) {
+        separate(key);
+        out << '"' << value << '"';
+    }
+
+private:
+    void separate(const char* key) {
+        if (!first.empty()) {
+            out << (first.back() ? "" : ",");
+            first.back() = false;
+        }
+        if (key) {
+            out << '"' << key << "\":";
+        }
+    }
+
+    std::ostream& out;
+    std::vector<bool> first;
+};
+
+struct OdPair {
+    std::vector<float> src;
+    std::vector<float> dest;
+};
+
+// Per-query timings of one workload.
+struct Workload {
+    Workload(const std::string& name) : name(name), seconds(0), settled(0), unreachable(0), checksum(0) {}
+
+    std::string name;
+    std::vector<double> micros;
+    double seconds;
+    long settled;
+    int unreachable;
+    // sum of the path lengths found; equal between runs that route the same
+    double checksum;
+};
+
+static double percentile(const std::vector<double>& sorted, double p) {
+    if (sorted.empty()) {
+        return 0;
+    }
+    int rank = std::max(1, (int)std::ceil(p/100.0*sorted.size()));
+    return sorted[rank - 1];
+}
+
+static void writeWorkload(JsonWriter& json, Workload& workload) {
+    std::vector<double> sorted = workload.micros;
+    std::sort(sorted.begin(), sorted.end());
+    json.Begin(NULL, '{');
+    json.Field("name", workload.name);
+    json.Field("queries", sorted.size());
+    json.Field("seconds", workload.seconds);
+    json.Field("throughput", workload.seconds > 0 ? sorted.size()/workload.seconds : 0);
+    json.Field("p50Micros", percentile(sorted, 50));
+    json.Field("p99Micros", percentile(sorted, 99));
+    json.Field("maxMicros", sorted.empty() ? 0 : sorted.back());
+    json.Field("meanSettled", sorted.empty() ? 0 : (double)workload.settled/sorted.size());
+    json.Field("unreachable", workload.unreachable);
+    json.Field("checksum", workload.checksum);
+    json.End('}');
+}
+
+static std::vector<float> randomPoint(std::mt19937& rng, const BoundingBox& bb) {
+    std::uniform_real_distribution<float> unit(0, 1);
+    std::vector<float> point(bb.min.size());
+    for (int i = 0; i < point.size(); i++) {
+        point[i] = bb.min[i] + unit(rng)*(bb.max[i] - bb.min[i]);
+    }
+    return point;
+}
+
+static Workload runStrategy(const IGraph* graph, const std::string& name, const RoutingStrategy& strategy, const std::vector<OdPair>& pairs) {
+    Workload workload(name);
+    Clock::time_point start = Clock::now();
+    for (const OdPair& pair : pairs) {
+        Clock::time_point query = Clock::now();
+        QueryResult result;
+        graph->GetPath(pair.src, pair.dest, strategy, QueryOptions(), &result);
+        workload.micros.push_back(secondsSince(query)*1e6);
+        workload.settled += result.stats.nodesSettled;
+        if (result.path.empty()) {
+            workload.unreachable++;
+        }
+        else {
+            workload.checksum += result.length;
+        }
+    }
+    workload.seconds = secondsSince(start);
+    return workload;
+}
+
+static void benchmarkMap(JsonWriter& json, const RoutingAPI& api, const std::string& file, int queries, unsigned seed) {
+    std::cerr << "Loading " << file << std::endl;
+    Memory before = readMemory();
+
+    // .osm maps are parsed and filtered in two timed steps; other formats
+    // load in one
+    double parseSeconds = 0, filterSeconds = -1;
+    long parsedNodes = 0;
+    Clock::time_point start = Clock::now();
+    const IGraph* graph;
+    if (file.size() >= 4 && file.substr(file.size() - 4) == ".osm") {
+        IGraph* parsed = OSMGraphFactory::Parse(file);
+        parseSeconds = secondsSince(start);
+        parsedNodes = parsed->GetNodes().size();
+        start = Clock::now();
+        graph = OSMGraphFactory::LargestComponent(parsed);
+        filterSeconds = secondsSince(start);
+        delete parsed;
+    }
+    else {
+        graph = api.LoadFromFile(file);
+        parseSeconds = secondsSince(start);
+    }
+    if (!graph) {
+        std::cerr << "Unable to load " << file << std::endl;
+        return;
+    }
+    Memory loaded = readMemory();
+
+    start = Clock::now();
+    EdgePoint point;
+    graph->NearestEdgePoint(graph->GetBoundingBox().min, point);
+    double segmentSeconds = secondsSince(start);
+    start = Clock::now();
+    CompactGraph compact(graph);
+    double compactSeconds = secondsSince(start);
+    start = Clock::now();
+    ArcFlags flags(compact);
+    double arcFlagSeconds = secondsSince(start);
+    start = Clock::now();
+    HubLabels labels(compact);
+    double hubLabelSeconds = secondsSince(start);
+    Memory indexed = readMemory();
+
+    json.Begin(NULL, '{');
+    json.Field("map", file);
+    json.Field("nodes", compact.NumNodes());
+    json.Field("edges", compact.NumEdges());
+    json.Begin("load", '{');
+    json.Field("parseSeconds", parseSeconds);
+    if (filterSeconds >= 0) {
+        json.Field("filterSeconds", filterSeconds);
+        json.Field("parsedNodes", parsedNodes);
+    }
+    json.End('}');
+    json.Begin("index", '{');
+    json.Field("segmentIndexSeconds", segmentSeconds);
+    json.Field("compactGraphSeconds", compactSeconds);
+    json.Field("arcFlagSeconds", arcFlagSeconds);
+    json.Field("hubLabelSeconds", hubLabelSeconds);
+    json.Field("hubLabelEntries", labels.NumEntries());
+    json.End('}');
+    json.Begin("memory", '{');
+    json.Field("graphHeapBytes", loaded.heapBytes - before.heapBytes);
+    json.Field("indexHeapBytes", indexed.heapBytes - loaded.heapBytes);
+    json.Field("rssKb", indexed.rssKb);
+    json.Field("peakRssKb", indexed.peakKb);
+    json.End('}');
+
+    // one OD set per map, so every workload routes the same pairs
+    std::mt19937 rng(seed);
+    BoundingBox bb = graph->GetBoundingBox();
+    std::vector<OdPair> pairs(queries);
+    for (OdPair& pair : pairs) {
+        pair.src = randomPoint(rng, bb);
+        pair.dest = randomPoint(rng, bb);
+    }
+
+    json.Begin("workloads", '[');
+    for (const RoutingStrategy* strategy : api.GetStrategies()) {
+        std::cerr << "  " << strategy->GetName() << std::endl;
+        Workload workload = runStrategy(graph, strategy->GetName(), *strategy, pairs);
+        writeWorkload(json, workload);
+    }
+    // the same A* queries as one batch on every core; per-query times are the
+    // snap and search times the queries report
+    std::cerr << "  astar-batch" << std::endl;
+    std::vector<PathRequest> requests;
+    for (const OdPair& pair : pairs) {
+        requests.push_back(PathRequest(pair.src, pair.dest, api.GetStrategy("astar")));
+    }
+    Workload batch("astar-batch");
+    start = Clock::now();
+    std::vector<Route> routes = api.GetPaths(graph, requests);
+    batch.seconds = secondsSince(start);
+    for (const Route& route : routes) {
+        batch.micros.push_back((route.result.stats.snapSeconds + route.result.stats.searchSeconds)*1e6);
+        batch.settled += route.result.stats.nodesSettled;
+        if (route.result.path.empty()) {
+            batch.unreachable++;
+        }
+        else {
+            batch.checksum += route.result.length;
+        }
+    }
+    writeWorkload(json, batch);
+
+    ArcFlagAStar arcFlags(flags);
+    Workload arcFlagWorkload = runStrategy(graph, arcFlags.GetName(), arcFlags, pairs);
+    writeWorkload(json, arcFlagWorkload);
+
+    // hub labels answer distances between nodes, so snap outside the timing
+    std::vector< std::pair<std::string, std::string> > nodes;
+    for (const OdPair& pair : pairs) {
+        nodes.push_back(std::make_pair(graph->NearestNode(pair.src, EuclideanDistance())->GetName(),
+            graph->NearestNode(pair.dest, EuclideanDistance())->GetName()));
+    }
+    Workload hubLabelWorkload("hub-labels");
+    start = Clock::now();
+    for (const auto& od : nodes) {
+        Clock::time_point query = Clock::now();
+        float distance = labels.GetDistance(graph, od.first, od.second);
+        hubLabelWorkload.micros.push_back(secondsSince(query)*1e6);
+        if (std::isinf(distance)) {
+            hubLabelWorkload.unreachable++;
+        }
+        else {
+            hubLabelWorkload.checksum += distance;
+        }
+    }
+    hubLabelWorkload.seconds = secondsSince(start);
+    writeWorkload(json, hubLabelWorkload);
+
+    Workload nearestNode("nearest-node");
+    Workload nearestEdge("nearest-edge");
+    for (Workload* workload : {&nearestNode, &nearestEdge}) {
+        start = Clock::now();
+        for (const OdPair& pair : pairs) {
+            Clock::time_point query = Clock::now();
+            if (workload == &nearestNode) {
+                const IGraphNode* node = graph->NearestNode(pair.src, EuclideanDistance());
+                workload->checksum += EuclideanDistance().Calculate(node->GetPosition(), pair.src);
+            }
+            else if (graph->NearestEdgePoint(pair.src, point)) {
+                workload->checksum += point.distance;
+            }
+            workload->micros.push_back(secondsSince(query)*1e6);
+        }
+        workload->seconds = secondsSince(start);
+        writeWorkload(json, *workload);
+    }
+    json.End(']');
+    json.End('}');
+
+    delete graph;
+}
+
+int main(int argc, char** argv) {
+    int queries = 200;
+    unsigned seed = 1;
+    std::string outFile;
+    std::vector<std::string> maps;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--queries" && i + 1 < argc) {
+            queries = std::stoi(argv[++i]);
+        }
+        else if (arg == "--seed" && i + 1 < argc) {
+            seed = std::stoul(argv[++i]);
+        }
+        else if (arg == "--out" && i + 1 < argc) {
+            outFile = argv[++i];
+        }
+        else if (arg.compare(0, 2, "--") == 0) {
+            std::cerr << "usage: route_bench [--queries N] [--seed S] [--out results.json] [map ...]" << std::endl;
+            return 1;
+        }
+        else {
+            maps.push_back(arg);
+        }
+    }
+    if (maps.empty()) {
+        maps.push_back("libs/routing/data/umn_st_paul.osm");
+        maps.push_back("libs/routing/data/teapot.obj");
+    }
+
+    std::ofstream file;
+    if (!outFile.empty()) {
+        file.open(outFile.c_str());
+    }
+    JsonWriter json(outFile.empty() ? std::cout : file);
+
+    RoutingAPI api;
+    json.Begin(NULL, '{');
+    json.Field("seed", seed);
+    json.Field("queries", queries);
+    json.Begin("maps", '[');
+    for (const std::string& map : maps) {
+        benchmarkMap(json, api, map, queries, seed);
+    }
+    json.End(']');
+    json.End('}');
+    return 0;
+}
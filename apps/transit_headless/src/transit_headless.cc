@@ -0,0 +1,324 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "SimulationLoop.h"
+#include "SimulationModel.h"
+#include "graph_store.h"
+#include "route_service.h"
+
+// Runs the transit simulation without a web server, as fast as it goes, for
+// capacity tests and performance baselines.  A scene (the format of
+// web/scenes/umn.json) and any number of trip scripts in the same format are
+// replayed into the model; entries may carry a "time" in simulated seconds
+// and are issued once the simulation reaches it.  The model is then stepped
+// for the requested number of simulated minutes and a JSON report goes to
+// stdout (or --out).  The model's own logging goes to stderr.  Routes are
+// planned inline and without time budgets, so a run's results do not depend
+// on how fast the machine is.
+//
+//   transit_headless [--minutes N] [--dt S] [--threads T] [--map file|none]
+//                    [--poi file] [--events events.jsonl] [--out report.json]
+//                    scene.json [trips.json ...]
+
+typedef std::chrono::steady_clock Clock;
+
+static double SecondsSince(Clock::time_point start) {
+  return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+/// Stands in for the view.  Every event is counted and, given a stream,
+/// recorded as one JSON object per line.  Entity updates are only counted:
+/// one arrives per entity per tick.
+class HeadlessController : public IController {
+ public:
+  explicit HeadlessController(std::ostream* record) : record(record) {}
+
+  void AddEntity(const IEntity& entity) {
+    JsonObject details;
+    details["id"] = entity.GetId();
+    details["details"] = entity.GetDetails();
+    Record("AddEntity", details);
+  }
+
+  void UpdateEntity(const IEntity& entity) { counts["UpdateEntity"]++; }
+
+  void RemoveEntity(const JsonObject& details) {
+    Record("RemoveEntity", details);
+  }
+
+  void AddPath(int id, const std::vector< std::vector<float> >& path) {
+    JsonObject details;
+    details["id"] = id;
+    details["points"] = static_cast<int>(path.size());
+    Record("AddPath", details);
+  }
+
+  void RemovePath(int id) {
+    JsonObject details;
+    details["id"] = id;
+    Record("RemovePath", details);
+  }
+
+  void SendEventToView(const std::string& event, const JsonObject& details) {
+    Record(event, details);
+  }
+
+  void Notify(const std::string& message) {
+    JsonObject details;
+    details["info"] = message;
+    Record("observe", details);
+  }
+
+  /// Simulated time stamped on the events recorded from now on
+  void SetTime(double time) { this->time = time; }
+
+  const std::map<std::string, long>& GetCounts() const { return counts; }
+
+ private:
+  void Record(const std::string& event, const JsonObject& details) {
+    counts[event]++;
+    if (record) {
+      JsonObject entry;
+      entry["time"] = time;
+      entry["event"] = event;
+      entry["details"] = details;
+      *record << entry.ToString() << '\n';
+    }
+  }
+
+  std::ostream* record;
+  double time = 0;
+  std::map<std::string, long> counts;
+};
+
+/// An entry of a scene or trip script
+struct Command {
+  double time;
+  std::string name;
+  JsonObject params;
+};
+
+static bool ReadCommands(const std::string& file,
+                         std::vector<Command>& commands) {
+  std::ifstream in(file.c_str());
+  if (!in) {
+    std::cerr << "Unable to open " << file << std::endl;
+    return false;
+  }
+  picojson::value value;
+  std::string error = picojson::parse(value, in);
+  if (!error.empty() || !value.is<picojson::array>()) {
+    std::cerr << file << ": not a JSON array of commands " << error
+              << std::endl;
+    return false;
+  }
+  for (picojson::value& entry : value.get<picojson::array>()) {
+    if (!entry.is<picojson::object>()) {
+      continue;
+    }
+    JsonObject object(entry.get<picojson::object>());
+    if (!object.Contains("command") || !object.Contains("params")) {
+      continue;
+    }
+    Command command;
+    command.time = object.Contains("time") ? (double)object["time"] : 0;
+    command.name = (std::string)object["command"];
+    command.params = object["params"];
+    commands.push_back(command);
+  }
+  return true;
+}
+
+// scenes also set up the view (SetScene, AddMesh); those are skipped
+static void Issue(SimulationModel& model, Command& command) {
+  if (command.name == "CreateEntity") {
+    model.CreateEntity(command.params);
+  } else if (command.name == "ScheduleTrip") {
+    model.ScheduleTrip(command.params);
+  }
+}
+
+static double Percentile(const std::vector<double>& sorted, double p) {
+  if (sorted.empty()) {
+    return 0;
+  }
+  int rank = std::max(1, (int)std::ceil(p / 100.0 * sorted.size()));
+  return sorted[rank - 1];
+}
+
+static int Usage() {
+  std::cerr << "usage: transit_headless [--minutes N] [--dt S] [--threads T]"
+               " [--map file|none] [--poi file] [--events events.jsonl]"
+               " [--out report.json] scene.json [trips.json ...]"
+            << std::endl;
+  return 1;
+}
+
+int main(int argc, char** argv) {
+  double minutes = 10;
+  double dt = SimulationLoop::MAX_ROUND;
+  int threads = 0;
+  std::string mapFile = "libs/routing/data/umn_st_paul.osm";
+  std::string poiFile;
+  std::string eventsFile;
+  std::string outFile;
+  std::vector<std::string> scripts;
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    if (arg == "--minutes" && i + 1 < argc) {
+      minutes = std::atof(argv[++i]);
+    } else if (arg == "--dt" && i + 1 < argc) {
+      dt = std::atof(argv[++i]);
+    } else if (arg == "--threads" && i + 1 < argc) {
+      threads = std::atoi(argv[++i]);
+    } else if (arg == "--map" && i + 1 < argc) {
+      mapFile = argv[++i];
+    } else if (arg == "--poi" && i + 1 < argc) {
+      poiFile = argv[++i];
+    } else if (arg == "--events" && i + 1 < argc) {
+      eventsFile = argv[++i];
+    } else if (arg == "--out" && i + 1 < argc) {
+      outFile = argv[++i];
+    } else if (arg.compare(0, 2, "--") == 0) {
+      return Usage();
+    } else {
+      scripts.push_back(arg);
+    }
+  }
+  if (scripts.empty() || minutes <= 0 || dt <= 0) {
+    return Usage();
+  }
+
+  // commands issued at the same time keep the order of their files
+  std::vector<Command> commands;
+  for (const std::string& script : scripts) {
+    if (!ReadCommands(script, commands)) {
+      return 1;
+    }
+  }
+  std::stable_sort(commands.begin(), commands.end(),
+                   [](const Command& a, const Command& b) {
+    return a.time < b.time;
+  });
+
+  // the report owns stdout
+  std::ostream report(std::cout.rdbuf());
+  std::cout.rdbuf(std::cerr.rdbuf());
+  std::ofstream out;
+  if (!outFile.empty()) {
+    out.open(outFile.c_str());
+    report.rdbuf(out.rdbuf());
+  }
+  std::ofstream events;
+  if (!eventsFile.empty()) {
+    events.open(eventsFile.c_str());
+  }
+
+  routing::RouteService::Shared().SetSynchronous(true);
+  routing::GraphStore graphs;
+  HeadlessController controller(eventsFile.empty() ? nullptr : &events);
+  SimulationModel model(controller, threads);
+  // loaded the way transit_service loads it, but up front
+  double mapSeconds = 0;
+  if (mapFile != "none") {
+    graphs.SetHubLabels(true);
+    graphs.SetPoiFile(poiFile);
+    Clock::time_point start = Clock::now();
+    if (!graphs.Load(mapFile)) {
+      std::cerr << "Unable to load " << mapFile << std::endl;
+      return 1;
+    }
+    mapSeconds = SecondsSince(start);
+    model.SetGraphStore(&graphs);
+  }
+
+  long ticks = std::lround(minutes * 60 / dt);
+  long steps = 0;
+  int next = 0;
+  std::vector<double> tickMicros;
+  tickMicros.reserve(ticks);
+  Clock::time_point start = Clock::now();
+  for (long tick = 0; tick < ticks; tick++) {
+    controller.SetTime(tick * dt);
+    for (; next < commands.size() && commands[next].time <= tick * dt;
+         next++) {
+      Issue(model, commands[next]);
+    }
+    Clock::time_point update = Clock::now();
+    steps += model.Update(dt);
+    tickMicros.push_back(SecondsSince(update) * 1e6);
+  }
+  double wallSeconds = SecondsSince(start);
+  std::sort(tickMicros.begin(), tickMicros.end());
+
+  JsonArray inputs;
+  for (const std::string& script : scripts) {
+    inputs.Push(script);
+  }
+  JsonObject result;
+  result["scripts"] = inputs;
+  result["map"] = mapFile;
+  result["mapSeconds"] = mapSeconds;
+  result["threads"] = model.GetNumThreads();
+  result["dt"] = dt;
+  result["simSeconds"] = ticks * dt;
+  result["ticks"] = static_cast<double>(ticks);
+  result["steps"] = static_cast<double>(steps);
+  result["wallSeconds"] = wallSeconds;
+  result["ticksPerSecond"] = wallSeconds > 0 ? ticks / wallSeconds : 0;
+  // simulated seconds per wall-clock second
+  result["speed"] = wallSeconds > 0 ? ticks * dt / wallSeconds : 0;
+
+  JsonObject tick;
+  double total = 0;
+  for (double micros : tickMicros) {
+    total += micros;
+  }
+  tick["meanMicros"] = tickMicros.empty() ? 0 : total / tickMicros.size();
+  tick["p50Micros"] = Percentile(tickMicros, 50);
+  tick["p99Micros"] = Percentile(tickMicros, 99);
+  tick["maxMicros"] = tickMicros.empty() ? 0 : tickMicros.back();
+  result["tick"] = tick;
+
+  const SimulationModel::PhaseTimes& times = model.GetPhaseTimes();
+  JsonObject phases;
+  phases["weather"] = times.weather;
+  phases["entities"] = times.entities;
+  phases["commit"] = times.commit;
+  phases["dispatch"] = times.dispatch;
+  phases["view"] = times.view;
+  result["phaseSeconds"] = phases;
+
+  const TripScheduler& trips = model.GetTripScheduler();
+  const TripScheduler::Stats& stats = trips.GetStats();
+  JsonObject deliveries;
+  deliveries["scheduled"] = static_cast<double>(stats.scheduled);
+  deliveries["dispatched"] = static_cast<double>(stats.dispatched);
+  deliveries["delivered"] = static_cast<double>(stats.delivered);
+  deliveries["pending"] = trips.GetPending();
+  deliveries["idleDrones"] = trips.GetIdleDrones();
+  deliveries["meanWaitSeconds"] =
+    stats.dispatched > 0 ? stats.waited / stats.dispatched : 0;
+  deliveries["meanPickupDistance"] =
+    stats.dispatched > 0 ? stats.pickupDistance / stats.dispatched : 0;
+  deliveries["meanTripSeconds"] =
+    stats.delivered > 0 ? stats.tripTime / stats.delivered : 0;
+  deliveries["perMinute"] = stats.delivered / minutes;
+  result["deliveries"] = deliveries;
+
+  JsonObject counts;
+  for (const auto& entry : controller.GetCounts()) {
+    counts[entry.first] = static_cast<double>(entry.second);
+  }
+  result["events"] = counts;
+
+  report << result.ToString() << std::endl;
+  return 0;
+}
@@ -1,56 +1,172 @@
 #include <map>
-#include <chrono>
+#include <mutex>
 #include "WebServer.h"
+#include "SimulationLoop.h"
 #include "SimulationModel.h"
-#include "routing_api.h"
+#include "graph_store.h"
+#include "query_metrics.h"
 
 //--------------------  Controller ----------------------------
 
-/// A Transit Service that communicates with a web page through web sockets.  It also acts as the controller
-/// in the model view controller pattern.
-class TransitService : public JsonSession, public IController {
+/// A web page connected through web sockets.  Commands change the shared model; the simulation itself is
+/// stepped by the server's SimulationLoop, which pushes the new state to every session after each tick.
+class TransitService : public JsonSession {
 public:
-  TransitService(SimulationModel& model) : model(model), start(std::chrono::system_clock::now()), time(0.0) {
-    routing::RoutingAPI api;
-		routing::IGraph* graph = api.LoadFromFile("libs/routing/data/umn.osm");
-    model.SetGraph(graph);
-  }
+  TransitService(SimulationModel& model, routing::GraphStore& graphs, SimulationLoop& loop) : model(model), graphs(graphs), loop(loop) {}
 
   /// Handles specific commands from the web server
   void ReceiveCommand(const std::string& cmd, JsonObject& data, JsonObject& returnValue) {
     //std::cout << cmd << ": " << data << std::endl;
     if (cmd == "CreateEntity") {
+      std::unique_lock<std::mutex> lock = loop.Lock();
       model.CreateEntity(data);
     }
     else if (cmd == "ScheduleTrip") {
+      std::unique_lock<std::mutex> lock = loop.Lock();
       model.ScheduleTrip(data);
     }
     else if (cmd == "ping") {
       returnValue["response"] = data;
     }
+    else if (cmd == "QueryStats") {
+      // per-strategy routing statistics since startup (or the last reset)
+      routing::QueryMetrics& metrics = routing::QueryMetrics::Global();
+      for (const std::string& name : metrics.GetStrategies()) {
+        returnValue[name] = QueryStatsToJson(metrics.Get(name));
+      }
+      if (data.Contains("reset") && (bool)data["reset"]) {
+        metrics.Reset();
+      }
+    }
+    else if (cmd == "MemoryReport") {
+      // heap used by the current map and its indices
+      std::shared_ptr<const routing::GraphSnapshot> snapshot = graphs.Get();
+      if (snapshot) {
+        routing::MemoryReport report = snapshot->GetMemoryReport();
+        JsonObject bytes;
+        for (const auto& entry : report.GetBytes()) {
+          bytes[entry.first] = (double)entry.second;
+        }
+        JsonObject counts;
+        for (const auto& entry : report.GetCounts()) {
+          counts[entry.first] = (double)entry.second;
+        }
+        returnValue["map"] = snapshot->GetSource();
+        returnValue["bytes"] = bytes;
+        returnValue["counts"] = counts;
+        returnValue["total"] = (double)report.Total();
+      }
+    }
+    else if (cmd == "LoadMap") {
+      // parsed in the background, the model switches over once it is ready
+      std::string file = data["file"];
+      graphs.LoadAsync(file);
+    }
     else if (cmd == "Update") {
-      updateEntites.clear();
+      // pages still poll with their speed slider value; the server ticks on
+      // its own, so polling only sets the speed
+      loop.SetSpeed(data["simSpeed"]);
+      SimulationLoop::Stats stats = loop.GetStats();
+      returnValue["ticks"] = (double)stats.ticks;
+      returnValue["simTime"] = stats.simTime;
+    }
+    else if (cmd == "SimulationStats") {
+      // how well the loop keeps up with the requested speed
+      SimulationLoop::Stats stats = loop.GetStats();
+      returnValue["ticks"] = (double)stats.ticks;
+      returnValue["rounds"] = (double)stats.rounds;
+      returnValue["steps"] = (double)stats.steps;
+      returnValue["lastSteps"] = stats.lastSteps;
+      returnValue["overruns"] = (double)stats.overruns;
+      returnValue["simTime"] = stats.simTime;
+      returnValue["droppedTime"] = stats.droppedTime;
+      returnValue["lastTickSeconds"] = stats.lastTickSeconds;
+      returnValue["maxTickSeconds"] = stats.maxTickSeconds;
+      returnValue["speed"] = loop.GetSpeed();
+      returnValue["budget"] = loop.GetBudget();
+    }
+  }
 
-      std::chrono::time_point<std::chrono::system_clock> end = std::chrono::system_clock::now();
-      std::chrono::duration<double> diff = end - start;
-      double delta = diff.count() - time;
-      time += delta;
+  static JsonObject HistogramToJson(const routing::Histogram& histogram) {
+    JsonObject result;
+    result["mean"] = histogram.Mean();
+    result["p50"] = histogram.Percentile(50);
+    result["p90"] = histogram.Percentile(90);
+    result["p99"] = histogram.Percentile(99);
+    result["max"] = histogram.Max();
+    return result;
+  }
 
-      double simSpeed = data["simSpeed"];
-      delta *= simSpeed;
+  static JsonObject QueryStatsToJson(const routing::StrategyMetrics& metrics) {
+    JsonObject result;
+    result["queries"] = (double)metrics.queries;
+    result["interrupted"] = (double)metrics.interrupted;
+    result["unreachable"] = (double)metrics.unreachable;
+    result["searchMicros"] = HistogramToJson(metrics.searchMicros);
+    result["snapMicros"] = HistogramToJson(metrics.snapMicros);
+    result["nodesSettled"] = HistogramToJson(metrics.nodesSettled);
+    result["edgesRelaxed"] = HistogramToJson(metrics.edgesRelaxed);
+    result["heapPushes"] = HistogramToJson(metrics.heapPushes);
+    result["peakQueue"] = HistogramToJson(metrics.peakQueue);
+    result["pathLength"] = HistogramToJson(metrics.pathLength);
+    JsonArray slowest;
+    for (const routing::QuerySample& sample : metrics.slowest) {
+      JsonObject query;
+      JsonArray src, dest;
+      for (float v : sample.src) src.Push(v);
+      for (float v : sample.dest) dest.Push(v);
+      query["src"] = src;
+      query["dest"] = dest;
+      query["searchMicros"] = sample.stats.searchSeconds*1e6;
+      query["nodesSettled"] = (double)sample.stats.nodesSettled;
+      slowest.Push(query);
+    }
+    result["slowest"] = slowest;
+    return result;
+  }
 
-      if (delta > 0.1) {
-        for (float f = 0.0; f < delta; f+=0.01) {
-          model.Update(0.01);
-        }
-      }
-      else {
-        model.Update(delta);
-      }
+private:
+  // Simulation Model
+  SimulationModel& model;
+  // The map shared by every session
+  routing::GraphStore& graphs;
+  // Steps the model; held while a command changes it
+  SimulationLoop& loop;
+};
+
+
+//--------------------  View / Web Server Code ----------------------------
+
+/// The TransitWebServer holds the simulation and updates sessions.  It is the model's controller: events the
+/// model raises are serialized once into an outbox, and the outbox is sent to every session from the thread
+/// running service(), since web socket writes must happen there.
+class TransitWebServer : public WebServerBase, public IController {
+public:
+	TransitWebServer(int port = 8081, const std::string& webDir = ".", const std::string& mapFile = "libs/routing/data/umn.osm", const std::string& poiFile = "", double tickRate = 30) : WebServerBase(port, webDir), model(*this), loop(model, tickRate) {
+    // the map is parsed once for the whole process, not per session; hub
+    // labels give dispatch constant-time road distances, and trips between
+    // listed POIs use routes computed at load time
+    graphs.SetHubLabels(true);
+    graphs.SetPoiFile(poiFile);
+    graphs.LoadAsync(mapFile);
+    model.SetGraphStore(&graphs);
+    loop.Start([this]() { PublishTick(); });
+  }
 
-      for (std::map<int, const IEntity*>::iterator it = updateEntites.begin(); it != updateEntites.end(); it++) {
-        // Send updated entities
-        SendEntity("UpdateEntity", *it->second, false);
+  ~TransitWebServer() {
+    loop.Stop();
+  }
+
+  /// Sends everything the model raised since the last call to every session.
+  void Flush() {
+    std::vector<std::string> messages;
+    {
+      std::lock_guard<std::mutex> lock(outboxMutex);
+      messages.swap(outbox);
+    }
+    for (const std::string& message : messages) {
+      for (int i = 0; i < sessions.size(); i++) {
+        sessions[i]->sendMessage(message);
       }
     }
   }
@@ -76,9 +192,10 @@ public:
   void AddEntity(const IEntity& entity) {
     SendEntity("AddEntity", entity, true);
   }
-    
+
+  // called with the model locked, like PublishTick
   void UpdateEntity(const IEntity& entity) {
-    updateEntites[entity.GetId()] = &entity;
+    updatedEntities[entity.GetId()] = &entity;
   }
 
   void RemoveEntity(const JsonObject& details) {
@@ -115,7 +232,8 @@ public:
     JsonObject eventData;
     eventData["event"] = event;
     eventData["details"] = details;
-    sendMessage(eventData.ToString());
+    std::lock_guard<std::mutex> lock(outboxMutex);
+    outbox.push_back(eventData.ToString());
   }
 
   void Notify(const std::string& message) {
@@ -124,70 +242,29 @@ public:
     SendEventToView("observe", eventData);
   }
 
-private:
-  // Simulation Model
-  SimulationModel& model;
-  // Used for tracking time since last update
-  std::chrono::time_point<std::chrono::system_clock> start;
-  // The total time the server has been running.
-  double time;
-  // Current entities to update
-  std::map<int, const IEntity*> updateEntites;
-};
-
-
-//--------------------  View / Web Server Code ----------------------------
-
-/// The TransitWebServer holds the simulation and updates sessions.
-class TransitWebServer : public WebServerBase, public IController {
-public:
-	TransitWebServer(int port = 8081, const std::string& webDir = ".") : WebServerBase(port, webDir), model(*this) {}
-  void AddEntity(const IEntity& entity) {
-    for (int i = 0; i < sessions.size(); i++) {
-      static_cast<TransitService*>(sessions[i])->AddEntity(entity);
-    }
-  }
-    
-  void UpdateEntity(const IEntity& entity) {
-    for (int i = 0; i < sessions.size(); i++) {
-      static_cast<TransitService*>(sessions[i])->UpdateEntity(entity);
-    }
-  }
-
-  void RemoveEntity(const JsonObject& details) {
-    for (int i = 0; i < sessions.size(); i++) {
-      static_cast<TransitService*>(sessions[i])->RemoveEntity(details);
-    }
-  }
-
-  void AddPath(int id, const std::vector< std::vector<float> >& path) {
-    for (int i = 0; i < sessions.size(); i++) {
-      static_cast<TransitService*>(sessions[i])->AddPath(id, path);
-    }
-  }
-
-  void RemovePath(int id) {
-    for (int i = 0; i < sessions.size(); i++) {
-      static_cast<TransitService*>(sessions[i])->RemovePath(id);
-    }
-  }
-
-  void SendEventToView(const std::string& event, const JsonObject& details) {
-    for (int i = 0; i < sessions.size(); i++) {
-      static_cast<TransitService*>(sessions[i])->SendEventToView(event, details);
-    }
-  }
+protected:
+	Session* createSession() { return new TransitService(model, graphs, loop); }
 
-  void Notify(const std::string& message) {
-    for (int i = 0; i < sessions.size(); i++) {
-      static_cast<TransitService*>(sessions[i])->Notify(message);
+private:
+  /// Runs on the simulation thread after every tick: queues the entities
+  /// that moved and wakes service() to send them.
+  void PublishTick() {
+    for (const auto& entry : updatedEntities) {
+      SendEntity("UpdateEntity", *entry.second, false);
     }
+    updatedEntities.clear();
+    lws_cancel_service(context);
   }
 
-protected:
-	Session* createSession() { return new TransitService(model); }
-private:
+  routing::GraphStore graphs;
+  // serialized events waiting for Flush
+  std::vector<std::string> outbox;
+  std::mutex outboxMutex;
+  // entities updated in the current tick
+  std::map<int, const IEntity*> updatedEntities;
   SimulationModel model;
+  // declared last so it stops before anything it uses goes away
+  SimulationLoop loop;
 };
 
 /// The main program that handels starting the web sockets service.
@@ -195,15 +272,22 @@ int main(int argc, char**argv) {
   if (argc > 1) {
     int port = std::atoi(argv[1]);
     std::string webDir = std::string(argv[2]);
-    TransitWebServer server(port, webDir);
+    std::string mapFile = argc > 3 ? std::string(argv[3]) : "libs/routing/data/umn.osm";
+    std::string poiFile = argc > 4 ? std::string(argv[4]) : "";
+    double tickRate = argc > 5 ? std::atof(argv[5]) : 30;
+    if (tickRate <= 0) {
+      std::cout << "Tick rate must be positive" << std::endl;
+      return 1;
+    }
+    TransitWebServer server(port, webDir, mapFile, poiFile, tickRate);
     while (true) {
       server.service();
+      server.Flush();
     }
   }
   else {
-    std::cout << "Usage: ./build/bin/transit_service <port> apps/transit_service/web/" << std::endl;
+    std::cout << "Usage: ./build/bin/transit_service <port> apps/transit_service/web/ [map file] [poi file] [ticks per second]" << std::endl;
   }
   
 	return 0;
 }
-
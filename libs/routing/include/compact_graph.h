@@ -0,0 +1,80 @@
+#ifndef COMPACT_GRAPH_H_
+#define COMPACT_GRAPH_H_
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "graph.h"
+
+namespace routing {
+
+// Index-based (CSR) copy of an IGraph's topology for the search algorithms
+// that need flat arrays: node i's out-edges are [EdgeBegin(i), EdgeEnd(i)),
+// and every edge also appears once in the reverse adjacency so backward
+// searches can walk incoming edges.  Edge weights default to the Euclidean
+// distance between endpoints, the same cost AStar uses.
+class CompactGraph {
+public:
+    CompactGraph(const IGraph* graph);
+    CompactGraph(const IGraph* graph, const DistanceFunction& cost);
+    virtual ~CompactGraph() {}
+
+    const IGraph* GetGraph() const { return graph; }
+    int NumNodes() const { return nodes.size(); }
+    int NumEdges() const { return targets.size(); }
+    MemoryReport GetMemoryReport() const;
+    // Hash of the positions, adjacency and weights; indices saved for this
+    // graph store it and are only loaded back for an identical one.
+    uint64_t GetFingerprint() const;
+
+    const IGraphNode* GetNode(int node) const { return nodes[node]; }
+    // -1 if the node is not part of this graph
+    int IndexOf(const IGraphNode* node) const;
+    int IndexOf(const std::string& name) const;
+    const float* GetPosition(int node) const { return &positions[3*node]; }
+
+    int EdgeBegin(int node) const { return offsets[node]; }
+    int EdgeEnd(int node) const { return offsets[node+1]; }
+    int EdgeTarget(int edge) const { return targets[edge]; }
+    float EdgeWeight(int edge) const { return weights[edge]; }
+    // Source of an edge, found by binary search over the offsets.
+    int EdgeSource(int edge) const;
+    // Edge index of node->target, or -1.
+    int FindEdge(int node, int target) const;
+
+    // Incoming edges of node: ReverseEdge(r) is the forward edge index and
+    // ReverseSource(r) its source.
+    int ReverseBegin(int node) const { return reverseOffsets[node]; }
+    int ReverseEnd(int node) const { return reverseOffsets[node+1]; }
+    int ReverseSource(int r) const { return reverseSources[r]; }
+    int ReverseEdge(int r) const { return reverseEdges[r]; }
+
+    // Straight-line distance between two nodes, the admissible A* estimate
+    // for the default weights.
+    float Distance(int a, int b) const;
+    float MaxEdgeWeight() const;
+    float MeanEdgeWeight() const;
+
+    // Weight overlay (e.g. closures or congestion) applied on top of the
+    // geometric weights.
+    void SetEdgeWeight(int edge, float weight) { weights[edge] = weight; }
+
+private:
+    void build(const DistanceFunction& cost);
+
+    const IGraph* graph;
+    std::vector<const IGraphNode*> nodes;
+    std::unordered_map<const IGraphNode*, int> indices;
+    std::vector<float> positions;
+    std::vector<int> offsets;
+    std::vector<int> targets;
+    std::vector<float> weights;
+    std::vector<int> reverseOffsets;
+    std::vector<int> reverseSources;
+    std::vector<int> reverseEdges;
+};
+
+}
+
+#endif
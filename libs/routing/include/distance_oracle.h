@@ -0,0 +1,22 @@
+#ifndef DISTANCE_ORACLE_H_
+#define DISTANCE_ORACLE_H_
+
+#include <string>
+#include "graph.h"
+
+namespace routing {
+
+class IGraph;
+
+// Distance-only counterpart of RoutingStrategy: answers "how far by road"
+// without materializing the path.  Returns infinity when `to` cannot be
+// reached from `from`.
+class DistanceOracle {
+public:
+	virtual ~DistanceOracle() {}
+	virtual float GetDistance(const IGraph* graph, const std::string& from, const std::string& to) const = 0;
+};
+
+}
+
+#endif
@@ -1,43 +1,108 @@
 #ifndef GRAPH_H_
 #define GRAPH_H_
 
+#include <atomic>
 #include <iostream>
 #include <string>
 #include <vector>
 #include <cmath>
+#include <mutex>
 #include "routing_strategy.h"
+#include "query_options.h"
 #include "distance_function.h"
 #include "bounding_box.h"
+#include "memory_report.h"
 
 namespace routing {
 
 class IGraphNode;
 class RoutingStrategy;
+class SegmentIndex;
+struct EdgePoint;
+
+// A finished position-based query (IGraph::GetPath).
+struct Route {
+	std::vector< std::vector<float> > path;
+	QueryResult result;
+};
+
+// One query of a batch (IGraph::GetPaths).  epsilon and budgetMs become its
+// QueryOptions; the budget starts when the query does, not when the batch
+// does.
+struct PathRequest {
+	PathRequest() : strategy(NULL), epsilon(0), budgetMs(0) {}
+	PathRequest(const std::vector<float>& src, const std::vector<float>& dest, const RoutingStrategy* strategy, float epsilon = 0, int budgetMs = 0)
+		: src(src), dest(dest), strategy(strategy), epsilon(epsilon), budgetMs(budgetMs) {}
+
+	std::vector<float> src;
+	std::vector<float> dest;
+	const RoutingStrategy* strategy;
+	float epsilon;
+	int budgetMs;
+};
 
 class IGraph {
 public:
 	virtual ~IGraph() {}
 	virtual const IGraphNode* GetNode(const std::string& name) const = 0;
 	virtual const std::vector<IGraphNode*>& GetNodes() const = 0;
+	// Neighbors of node in this graph; differs from node->GetNeighbors() only
+	// for overlays that add edges.
+	virtual const std::vector<IGraphNode*>& GetNeighbors(const IGraphNode* node) const = 0;
 	virtual BoundingBox GetBoundingBox() const = 0;
 	virtual const IGraphNode* NearestNode(std::vector<float> point, const DistanceFunction& distance) const = 0;
+	// Closest point on any edge (see segment_index.h); false if there are no edges.
+	virtual bool NearestEdgePoint(const std::vector<float>& point, EdgePoint& result) const = 0;
 	virtual const std::vector< std::vector<float> > GetPath(std::vector<float> src, std::vector<float> dest, const RoutingStrategy& strategy) const = 0;
+	// Same, within the limits of options.  If no path was found (in time) the
+	// result is just the two nearest nodes.  Details go to result if given.
+	virtual const std::vector< std::vector<float> > GetPath(std::vector<float> src, std::vector<float> dest, const RoutingStrategy& strategy, const QueryOptions& options, QueryResult* result = NULL) const = 0;
+	// Runs every request on up to threads threads (threads <= 0 means
+	// DefaultThreadCount()): the caller and workers of a process-wide pool.
+	// Returns the routes in request order.  If a query throws (or has no
+	// strategy), the first exception is rethrown once the batch is done.
+	// Must not be called from a query running in such a batch.
+	virtual std::vector<Route> GetPaths(const std::vector<PathRequest>& requests, int threads = 0) const = 0;
+	// Heap used by the graph and its caches, with node, edge and (weakly
+	// connected) component counts.
+	virtual MemoryReport GetMemoryReport() const = 0;
 };
 
 class IGraphNode {
 public:
 	virtual ~IGraphNode() {}
-	virtual const std::string& GetName() const = 0;
+	// Returned by value so graphs with numeric ids (OSMGraph) can format
+	// them on demand instead of keeping a string per node.
+	virtual std::string GetName() const = 0;
 	virtual const std::vector<IGraphNode*>& GetNeighbors() const = 0;
 	virtual const std::vector<float> GetPosition() const = 0;
 };
 
+// Routes start and end at virtual nodes placed on the edges nearest to the
+// requested positions, unless the strategy cannot handle an overlay graph,
+// in which case they snap to the nearest nodes.
 class GraphBase : public IGraph {
 public:
-	virtual ~GraphBase() {}
+	GraphBase() : segments(NULL) {}
+	virtual ~GraphBase();
+	const std::vector<IGraphNode*>& GetNeighbors(const IGraphNode* node) const { return node->GetNeighbors(); }
 	BoundingBox GetBoundingBox() const;
 	const IGraphNode* NearestNode(std::vector<float> point, const DistanceFunction& distance) const;
+	bool NearestEdgePoint(const std::vector<float>& point, EdgePoint& result) const;
 	const std::vector< std::vector<float> > GetPath(std::vector<float> src, std::vector<float> dest, const RoutingStrategy& strategy) const;
+	const std::vector< std::vector<float> > GetPath(std::vector<float> src, std::vector<float> dest, const RoutingStrategy& strategy, const QueryOptions& options, QueryResult* result = NULL) const;
+	std::vector<Route> GetPaths(const std::vector<PathRequest>& requests, int threads = 0) const;
+	// Counts names, neighbor lists, the node list and the segment index;
+	// subclasses add their node objects and lookup tables in addMemory.
+	MemoryReport GetMemoryReport() const;
+
+protected:
+	virtual void addMemory(MemoryReport& report) const {}
+
+private:
+	// built on first use
+	mutable std::once_flag segmentsBuilt;
+	mutable std::atomic<SegmentIndex*> segments;
 };
 
 }
@@ -0,0 +1,79 @@
+#ifndef GRAPH_SNAPSHOT_H_
+#define GRAPH_SNAPSHOT_H_
+
+#include <memory>
+#include <string>
+#include "compact_graph.h"
+#include "graph.h"
+#include "poi_table.h"
+#include "routing/hub_labels.h"
+
+namespace routing {
+
+// A loaded map, immutable once published.  The snapshot owns its graph and is
+// shared through std::shared_ptr, so a snapshot that has been swapped out stays
+// alive until the last entity or route still using it lets go.
+class GraphSnapshot {
+public:
+    GraphSnapshot(const IGraph* graph, const std::string& source, int version)
+        : graph(graph), source(source), version(version) {}
+    virtual ~GraphSnapshot() {
+        // indices point into the graph, so drop them first
+        poiTable.reset();
+        hubLabels.reset();
+        compact.reset();
+        delete graph;
+    }
+
+    const IGraph* GetGraph() const { return graph; }
+    const std::string& GetSource() const { return source; }
+    int GetVersion() const { return version; }
+
+    // Optional indices, attached before the snapshot is published.  Null when
+    // the store was not asked to build them.
+    std::shared_ptr<const CompactGraph> GetCompactGraph() const { return compact; }
+    std::shared_ptr<const HubLabels> GetHubLabels() const { return hubLabels; }
+    void SetCompactGraph(std::shared_ptr<const CompactGraph> compact) { this->compact = compact; }
+    void SetHubLabels(std::shared_ptr<const HubLabels> hubLabels) { this->hubLabels = hubLabels; }
+    std::shared_ptr<const PoiTable> GetPoiTable() const { return poiTable; }
+    void SetPoiTable(std::shared_ptr<const PoiTable> poiTable) { this->poiTable = poiTable; }
+
+    // The graph's report with the attached indices under "compact graph/",
+    // "hub labels/" and "poi table/".
+    MemoryReport GetMemoryReport() const {
+        MemoryReport report = graph->GetMemoryReport();
+        if (compact) {
+            report.Merge(compact->GetMemoryReport(), "compact graph/");
+        }
+        if (hubLabels) {
+            report.Merge(hubLabels->GetMemoryReport(), "hub labels/");
+        }
+        if (poiTable) {
+            report.Merge(poiTable->GetMemoryReport(), "poi table/");
+        }
+        return report;
+    }
+
+    // Returns a handle to the graph that keeps the whole snapshot alive.
+    static std::shared_ptr<const IGraph> GraphOf(const std::shared_ptr<const GraphSnapshot>& snapshot) {
+        if (!snapshot) {
+            return std::shared_ptr<const IGraph>();
+        }
+        return std::shared_ptr<const IGraph>(snapshot, snapshot->GetGraph());
+    }
+
+    GraphSnapshot(const GraphSnapshot&) = delete;
+    GraphSnapshot& operator=(const GraphSnapshot&) = delete;
+
+private:
+    const IGraph* graph;
+    std::string source;
+    int version;
+    std::shared_ptr<const CompactGraph> compact;
+    std::shared_ptr<const HubLabels> hubLabels;
+    std::shared_ptr<const PoiTable> poiTable;
+};
+
+}
+
+#endif
@@ -0,0 +1,96 @@
+#ifndef GRAPH_STORE_H_
+#define GRAPH_STORE_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include "graph_snapshot.h"
+#include "routing_api.h"
+
+namespace routing {
+
+// Holds the process-wide current map.  The map is parsed once (optionally on a
+// background thread) and published as an immutable GraphSnapshot.  Readers
+// grab the current snapshot with Get(); a newer map is published with Swap(),
+// which is a single atomic pointer exchange and never waits on readers.
+class GraphStore {
+public:
+    enum State { EMPTY, LOADING, READY, FAILED };
+
+    GraphStore();
+    virtual ~GraphStore();
+
+    // Parses the file on the calling thread and publishes it.  Returns false
+    // (and keeps the current snapshot) if the file could not be loaded.
+    bool Load(const std::string& file);
+
+    // Same as Load, but parses on a background thread and never waits for
+    // it.  The previous snapshot keeps being served until the new one is
+    // ready.  A file requested while a load is in flight is loaded after it;
+    // a later request replaces one that has not started yet.
+    void LoadAsync(const std::string& file);
+
+    // Atomically replaces the current snapshot, taking ownership of graph.
+    void Swap(const IGraph* graph, const std::string& source);
+    void Swap(std::shared_ptr<const GraphSnapshot> snapshot);
+
+    std::shared_ptr<const GraphSnapshot> Get() const;
+    std::shared_ptr<const IGraph> GetGraph() const { return GraphSnapshot::GraphOf(Get()); }
+
+    State GetState() const { return static_cast<State>(state.load()); }
+    bool IsReady() const { return GetState() == READY; }
+    // Version of the current snapshot, 0 while nothing has been published.
+    int GetVersion() const { return version.load(); }
+    // Next version number to stamp on a snapshot built outside the store.
+    int NextVersion() { return ++lastVersion; }
+
+    // When enabled, every map loaded from a file gets a CompactGraph and hub
+    // labels attached before it is published.  Labels are read from
+    // "<file>.hlab" when such a file exists (see graph_viewer --hub-labels)
+    // and built at load time otherwise.
+    void SetHubLabels(bool enabled) { hubLabels = enabled; }
+
+    // When set, every map loaded from a file gets a PoiTable over the POIs
+    // listed in poiFile (see PoiTable::ReadPois).  The table is read from
+    // "<map file>.ptab" when that file holds one for the same map and POIs;
+    // otherwise it is built at load time and saved there.  Empty turns it
+    // off again.
+    void SetPoiFile(const std::string& poiFile);
+
+    // Blocks until no load is in flight.
+    void Wait() const;
+
+    GraphStore(const GraphStore&) = delete;
+    GraphStore& operator=(const GraphStore&) = delete;
+
+private:
+    const IGraph* parse(const std::string& file) const;
+    std::shared_ptr<GraphSnapshot> prepare(const IGraph* graph, const std::string& file);
+    std::shared_ptr<const PoiTable> poiTableFor(const IGraph* graph, const std::string& file) const;
+    void finishLoad(bool ok);
+    // body of the loader thread: loads queued files until none is left
+    void loadQueued();
+
+    RoutingAPI api;
+    std::shared_ptr<const GraphSnapshot> current;
+    std::atomic<int> state;
+    std::atomic<int> version;
+    std::atomic<int> lastVersion;
+    std::atomic<bool> hubLabels;
+    std::string poiFile;
+    int pending;
+    // next file for the loader thread, valid while queuedLoad is set
+    std::string queued;
+    bool queuedLoad;
+    bool loaderBusy;
+    std::thread loader;
+    mutable std::mutex mutex;
+    mutable std::condition_variable loaded;
+};
+
+}
+
+#endif
@@ -12,7 +12,7 @@ class SimpleGraphNode : public IGraphNode {
 public:
     SimpleGraphNode(const std::string& name, const std::vector<float>& position) : name(name), position(position) {}
 	virtual ~SimpleGraphNode() {}
-	const std::string& GetName() const { return name; }
+	std::string GetName() const { return name; }
 	const std::vector<IGraphNode*>& GetNeighbors() const { return neighbors; }
 	const std::vector<float> GetPosition() const { return position; }
     void AddNeighbor(IGraphNode* neighbor) { neighbors.push_back(neighbor); }
@@ -30,7 +30,10 @@ public:
             delete nodes[i];
         }
     }
-	const IGraphNode* GetNode(const std::string& name) const { return nodeMap.find(name)->second; }
+	const IGraphNode* GetNode(const std::string& name) const {
+        auto it = nodeMap.find(name);
+        return it == nodeMap.end() ? NULL : it->second;
+    }
 	const std::vector<IGraphNode*>& GetNodes() const { return nodes; }
     void AddNode(SimpleGraphNode* node) { 
         nodes.push_back(node);
@@ -40,6 +43,15 @@ public:
         nodeMap[a]->AddNeighbor(nodeMap[b]);
     }
 
+protected:
+    void addMemory(MemoryReport& report) const {
+        for (int i = 0; i < nodes.size(); i++) {
+            report.Add("node objects", MemoryReport::Block(sizeof(SimpleGraphNode)));
+            report.Add("positions", MemoryReport::Block(nodes[i]->GetPosition().size()*sizeof(float)));
+        }
+        report.Add("node lookup", MemoryReport::Of(nodeMap));
+    }
+
 private:
     std::map<std::string, SimpleGraphNode*> nodeMap;
     std::vector<IGraphNode*> nodes;
@@ -0,0 +1,46 @@
+#ifndef VIRTUAL_GRAPH_H_
+#define VIRTUAL_GRAPH_H_
+
+#include "graph.h"
+#include "impl/simple_graph.h"
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace routing {
+
+// Per-query overlay that adds a few virtual nodes (e.g. a route's start and
+// end points snapped onto an edge) to a graph without touching it.  Real
+// nodes that gain an edge to a virtual node report the extra neighbor through
+// GetNeighbors(node); GetNodes() only lists the real nodes.
+class VirtualGraph : public GraphBase {
+public:
+	VirtualGraph(const IGraph* base) : base(base) {}
+	virtual ~VirtualGraph();
+
+	const IGraphNode* AddNode(const std::string& name, const std::vector<float>& position);
+	// Either end may be real or virtual.
+	void AddEdge(const IGraphNode* from, const IGraphNode* to);
+
+	const IGraphNode* GetNode(const std::string& name) const;
+	const std::vector<IGraphNode*>& GetNodes() const { return base->GetNodes(); }
+	const std::vector<IGraphNode*>& GetNeighbors(const IGraphNode* node) const;
+	const IGraphNode* NearestNode(std::vector<float> point, const DistanceFunction& distance) const {
+		return base->NearestNode(point, distance);
+	}
+	bool NearestEdgePoint(const std::vector<float>& point, EdgePoint& result) const {
+		return base->NearestEdgePoint(point, result);
+	}
+	// Only what the overlay adds to the base graph.
+	MemoryReport GetMemoryReport() const;
+
+private:
+	const IGraph* base;
+	std::map<std::string, SimpleGraphNode*> virtualNodes;
+	std::unordered_map<const IGraphNode*, std::vector<IGraphNode*> > extraNeighbors;
+};
+
+}
+
+#endif
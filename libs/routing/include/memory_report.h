@@ -0,0 +1,65 @@
+#ifndef MEMORY_REPORT_H_
+#define MEMORY_REPORT_H_
+
+#include <iostream>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace routing {
+
+// Heap bytes held by a graph or index, by category, plus named counts
+// (nodes, edges, ...).  Bytes are estimated from container capacities and
+// element sizes, with each heap block rounded up the way a 64-bit glibc
+// malloc does; they are not measured from the allocator.
+class MemoryReport {
+public:
+	// Adds bytes to a category, creating it if needed.
+	void Add(const std::string& category, size_t bytes) { categories[category] += bytes; }
+	void SetCount(const std::string& name, long count) { counts[name] = count; }
+	// Adds other's bytes and counts, with prefix in front of every name.
+	void Merge(const MemoryReport& other, const std::string& prefix);
+
+	size_t Total() const;
+	const std::map<std::string, size_t>& GetBytes() const { return categories; }
+	const std::map<std::string, long>& GetCounts() const { return counts; }
+
+	// Categories largest first, with their share of the total.
+	void Print(std::ostream& out) const;
+
+	// Size of the heap block malloc hands out for a request of bytes.
+	static size_t Block(size_t bytes);
+
+	// Heap owned by a container itself; heap owned by its elements (e.g.
+	// long string keys) is not followed.
+	static size_t Of(const std::string& value);
+
+	template <class T, class A>
+	static size_t Of(const std::vector<T, A>& values) {
+		return values.capacity() ? Block(values.capacity()*sizeof(T)) : 0;
+	}
+
+	template <class K, class V, class H, class E, class A>
+	static size_t Of(const std::unordered_map<K, V, H, E, A>& values) {
+		// a bucket array plus one node per element: next pointer, element
+		// and cached hash
+		size_t node = sizeof(void*) + sizeof(typename std::unordered_map<K, V, H, E, A>::value_type) + sizeof(size_t);
+		return Block(values.bucket_count()*sizeof(void*)) + values.size()*Block(node);
+	}
+
+	template <class K, class V, class C, class A>
+	static size_t Of(const std::map<K, V, C, A>& values) {
+		// red-black tree node: color, parent, left and right, then the element
+		size_t node = 4*sizeof(void*) + sizeof(typename std::map<K, V, C, A>::value_type);
+		return values.size()*Block(node);
+	}
+
+private:
+	std::map<std::string, size_t> categories;
+	std::map<std::string, long> counts;
+};
+
+}
+
+#endif
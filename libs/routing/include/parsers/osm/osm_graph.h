@@ -1,25 +1,27 @@
 #ifndef OSM_GRAPH_H_
 #define OSM_GRAPH_H_
 
+#include <cstdint>
 #include <string>
 #include <vector>
 #include <iostream>
-#include <unordered_map>
+#include <utility>
 #include "graph.h"
 #include "parsers/osm/point3.h"
 
 
 using std::string;
 using std::vector;
-using std::unordered_map;
 
 namespace routing {
 
+// OSM node ids are kept as numbers; GetName formats one only when asked.
 class OSMNode: public IGraphNode {
     public:
-        OSMNode(Point3 loc, string name);
+        OSMNode(Point3 loc, uint64_t id);
         Point3 GetLoc() const { return loc_; };
-        const string& GetName() const override { return name_; };
+        uint64_t GetId() const { return id_; };
+        string GetName() const override { return std::to_string(id_); };
         void AddNeighbour(OSMNode* other) { neighbours_.push_back(other); };
         const std::vector<IGraphNode*>& GetNeighbors() const override
             {   return neighbours_;
@@ -28,7 +30,7 @@ class OSMNode: public IGraphNode {
             return loc_.toVec();
         }
     private:
-        string name_;
+        uint64_t id_;
         Point3 loc_;
         vector<IGraphNode*> neighbours_; 
 };
@@ -36,20 +38,29 @@ class OSMNode: public IGraphNode {
 class OSMGraph : public GraphBase {
     public:
         ~OSMGraph();
+        // Throws invalid_argument if a node with the same id was added.
         void AddNode(OSMNode* node);
-        const OSMNode* NodeNamed(const string name) const;
-        void AddEdge(const string name1, const string name2);
-        bool Contains(const string name) const;
+        // NULL if there is no node with that id.
+        const OSMNode* NodeWithId(uint64_t id) const;
+        void AddEdge(uint64_t id1, uint64_t id2);
+        bool Contains(uint64_t id) const { return NodeWithId(id) != NULL; }
 
-        const IGraphNode* GetNode(const std::string& name) const override 
-            { return Contains(name) ? NodeNamed(name) : NULL; }
+        // Names are decimal ids; anything else is not in the graph.
+        const IGraphNode* GetNode(const std::string& name) const override;
         const std::vector<IGraphNode*>& GetNodes() const override
             { return nodes_; }
 
+        // Parses a decimal OSM id; false unless all of [begin, end) is one.
+        static bool ParseId(const char* begin, const char* end, uint64_t& id);
+
+    protected:
+        void addMemory(MemoryReport& report) const override;
+
     private:
         vector<IGraphNode*> nodes_;
-        unordered_map<string, OSMNode*> lookup_;
-        OSMNode* node_named(const string name) const;
+        // sorted by id; files list nodes in id order, so AddNode appends
+        vector< std::pair<uint64_t, OSMNode*> > ids_;
+        OSMNode* node_with_id(uint64_t id) const;
 
 };
 };
@@ -9,6 +9,11 @@ class OSMGraphFactory : public IGraphFactory {
 public:
 	virtual ~OSMGraphFactory() {}
 	virtual IGraph* Create(const std::string& file) const;
+
+	// The two steps of Create, for callers that time them separately: every
+	// road node in the file, and the largest connected component of that.
+	static IGraph* Parse(const std::string& file);
+	static IGraph* LargestComponent(const IGraph* graph);
 };
 
 }
@@ -0,0 +1,41 @@
+#ifndef OSM_IMPORTER_H_
+#define OSM_IMPORTER_H_
+
+#include <string>
+
+namespace routing {
+
+// Converts an .osm file straight into a graph snapshot (see snapshot_file.h)
+// without holding the map in memory, for maps too large for OsmParser.
+//
+// The file is read once as a stream.  Node coordinates and highway way
+// segments are spilled into sorted run files.  External merge joins then
+// resolve the segments to node coordinates and dense indices.  The result is
+// reduced to the largest connected component, like OsmParser does, and
+// written to the snapshot.  Apart from the sort buffers, which share
+// memoryBudget, only two ints per road node stay in memory.
+class OsmImporter {
+public:
+	struct Options {
+		Options() : memoryBudget(256L << 20) {}
+		// Bytes shared by the sort buffers.
+		long memoryBudget;
+		// Where run files go; next to the snapshot when empty.
+		std::string tempDirectory;
+	};
+
+	struct Stats {
+		long nodesRead;
+		long waySegments;
+		long nodes;
+		long edges;
+		int runFiles;
+	};
+
+	// Throws std::runtime_error if a file cannot be read or written.
+	static Stats Import(const std::string& osmFile, const std::string& snapshotFile, const Options& options = Options());
+};
+
+}
+
+#endif
@@ -1,10 +1,13 @@
 #ifndef ITERATION2_SOLN_SRC_XML_TOOLS_OSM_PARSER_H_
 #define ITERATION2_SOLN_SRC_XML_TOOLS_OSM_PARSER_H_
 
+#include <cstdint>
 #include <set>
 #include <string>
 #include <unordered_map>
 #include <unordered_set>
+#include <utility>
+#include <vector>
 
 #include "util/xml/pugixml.h"
 #include "parsers/osm/osm_graph.h"
@@ -19,10 +22,18 @@ namespace routing {
 class OsmParser {
 public:
   static OSMGraph* LoadGraphFromFile(string filename, bool debug);
+  // The two steps of LoadGraphFromFile: every road node in the file, and
+  // the largest connected component of that graph.
+  static OSMGraph* ParseGraphFromFile(string filename, bool debug);
+  static OSMGraph* LargestComponent(const IGraph* graph);
+  // Map position of a lat/lon coordinate, relative to the map center.
+  static Point3 Project(float latitude, float longitude, float centerLat, float centerLon);
 private:
   static OSMGraph* read_nodes(pugi::xml_document* doc, bool debug = false);
   static void read_adjacencies_to(OSMGraph* graph, pugi::xml_document* doc, bool debug=false);
-  static unordered_map<string, set<string>> get_adjacency_list_from_file(pugi::xml_document* doc, bool debug = false);
+  // Road edges in both directions, sorted by (from, to) without duplicates.
+  static vector< std::pair<uint64_t, uint64_t> > get_adjacency_list_from_file(pugi::xml_document* doc, bool debug = false);
+  static bool read_id(pugi::xml_attribute attribute, uint64_t& id);
   static OSMGraph* without_lonely_nodes(OSMGraph* graph);
 
   static float normalize(float val, float max, float min);
@@ -0,0 +1,72 @@
+#ifndef POI_TABLE_H_
+#define POI_TABLE_H_
+
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "graph.h"
+
+namespace routing {
+
+// Routes between every ordered pair of a fixed list of points of interest,
+// computed once so trips between two of them are a lookup instead of a
+// search.  Paths are stored as IGraph::GetPath returns them, flattened into
+// one array of positions.
+class PoiTable {
+public:
+	struct Poi {
+		std::string name;
+		std::vector<float> position;
+	};
+
+	// Routes all pairs with strategy as one IGraph::GetPaths batch on up to
+	// threads threads (threads <= 0 means DefaultThreadCount()).
+	PoiTable(const IGraph* graph, const std::vector<Poi>& pois, const RoutingStrategy& strategy, int threads = 0);
+	virtual ~PoiTable() {}
+
+	int NumPois() const { return pois.size(); }
+	const std::vector<Poi>& GetPois() const { return pois; }
+	// -1 if no POI has that name.
+	int IndexOf(const std::string& name) const;
+	// Closest POI within tolerance of position, -1 if there is none.
+	int Find(const std::vector<float>& position, float tolerance) const;
+
+	// Route between two POI indices; empty if there is none.
+	std::vector< std::vector<float> > GetPath(int from, int to) const;
+	// Length of that route, infinity if there is none.
+	float GetDistance(int from, int to) const { return distances[from*pois.size() + to]; }
+
+	// The stored route when src and dest are both within tolerance of a POI
+	// and a route between them exists; false otherwise.
+	bool Lookup(const std::vector<float>& src, const std::vector<float>& dest,
+		std::vector< std::vector<float> >& path, float tolerance = 1) const;
+
+	MemoryReport GetMemoryReport() const;
+
+	// Binary (de)serialization, next to the map like hub labels.  Load
+	// returns NULL when the data was built for another graph (see
+	// CompactGraph::GetFingerprint) or a different POI list.
+	void Save(std::ostream& out) const;
+	static PoiTable* Load(std::istream& in, const IGraph* graph, const std::vector<Poi>& pois);
+
+	// Reads a POI list, one "name x y z" per line; blank lines and lines
+	// starting with # are skipped.  Throws std::runtime_error if the file
+	// cannot be read or a line is malformed.
+	static std::vector<Poi> ReadPois(const std::string& file);
+
+private:
+	PoiTable(const IGraph* graph, const std::vector<Poi>& pois);
+
+	std::vector<Poi> pois;
+	// fingerprint of the graph the routes were computed on
+	uint64_t graphFingerprint;
+	// route i*n + j covers points [offsets[i*n + j], offsets[i*n + j + 1])
+	std::vector<int> offsets;
+	std::vector<float> points;
+	std::vector<float> distances;
+};
+
+}
+
+#endif
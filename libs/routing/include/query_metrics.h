@@ -0,0 +1,109 @@
+#ifndef QUERY_METRICS_H_
+#define QUERY_METRICS_H_
+
+#include <atomic>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "query_options.h"
+
+namespace routing {
+
+// Log-scale histogram of non-negative values with four buckets per power of
+// two, so percentiles are within about 20% of the true value.  Values below
+// 2^-10 share the first bucket and values above 2^40 the last one.
+class Histogram {
+public:
+	static const int BUCKETS = 4*50 + 2;
+
+	Histogram();
+
+	void Record(double value);
+	void Merge(const Histogram& other);
+
+	long Count() const { return count; }
+	double Mean() const { return count ? sum/count : 0; }
+	double Min() const { return count ? min : 0; }
+	double Max() const { return count ? max : 0; }
+	// Upper end of the bucket holding the p-th percentile (0-100), clamped
+	// to the recorded range.
+	double Percentile(double p) const;
+
+private:
+	static int bucketOf(double value);
+	static double upperBound(int bucket);
+
+	long counts[BUCKETS];
+	long count;
+	double sum;
+	double min;
+	double max;
+};
+
+// One query kept for inspection, with the positions it was asked for.
+struct QuerySample {
+	std::vector<float> src;
+	std::vector<float> dest;
+	QueryResult::Status status;
+	QueryStats stats;
+};
+
+struct StrategyMetrics {
+	StrategyMetrics() : queries(0), interrupted(0), unreachable(0) {}
+
+	long queries;
+	long interrupted;
+	long unreachable;
+	// times in microseconds
+	Histogram searchMicros;
+	Histogram snapMicros;
+	Histogram nodesSettled;
+	Histogram edgesRelaxed;
+	Histogram heapPushes;
+	Histogram peakQueue;
+	// found paths only
+	Histogram pathLength;
+	// the slowest searches so far, slowest first
+	std::vector<QuerySample> slowest;
+};
+
+// Process-wide statistics of the position-based path queries
+// (IGraph::GetPath), aggregated per strategy name.  Recording takes a short
+// lock per query; it can be switched off with SetEnabled(false).
+class QueryMetrics {
+public:
+	// Slowest queries kept per strategy.
+	static const int SLOWEST = 8;
+
+	static QueryMetrics& Global();
+
+	QueryMetrics() : enabled(true) {}
+	virtual ~QueryMetrics() {}
+
+	void SetEnabled(bool enabled) { this->enabled = enabled; }
+	bool IsEnabled() const { return enabled.load(); }
+
+	void Record(const std::string& strategy, const std::vector<float>& src, const std::vector<float>& dest, const QueryResult& result);
+
+	std::vector<std::string> GetStrategies() const;
+	// A copy of the metrics for strategy; empty if it has not been used.
+	StrategyMetrics Get(const std::string& strategy) const;
+	void Reset();
+
+	// Percentile table per strategy followed by its slowest queries.
+	void Print(std::ostream& out) const;
+
+	QueryMetrics(const QueryMetrics&) = delete;
+	QueryMetrics& operator=(const QueryMetrics&) = delete;
+
+private:
+	std::atomic<bool> enabled;
+	std::map<std::string, StrategyMetrics> strategies;
+	mutable std::mutex mutex;
+};
+
+}
+
+#endif
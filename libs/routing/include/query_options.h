@@ -0,0 +1,108 @@
+#ifndef QUERY_OPTIONS_H_
+#define QUERY_OPTIONS_H_
+
+#include <atomic>
+#include <chrono>
+#include <limits>
+#include <string>
+#include <vector>
+
+namespace routing {
+
+// Cancellation flag shared between whoever issued a query and the search
+// running it.  The search polls it, so cancelling is cheap but not instant.
+class CancelToken {
+public:
+	CancelToken() : cancelled(false) {}
+	void Cancel() { cancelled = true; }
+	bool IsCancelled() const { return cancelled.load(); }
+
+private:
+	std::atomic<bool> cancelled;
+};
+
+// Limits for a single path query.  The defaults ask for the optimal path with
+// no time limit, i.e. the plain GetPath behaviour.
+struct QueryOptions {
+	typedef std::chrono::steady_clock Clock;
+
+	QueryOptions() : epsilon(0), deadline(Clock::time_point::max()), cancel(NULL) {}
+
+	// Accept paths up to (1 + epsilon) times longer than optimal.
+	float epsilon;
+	// Stop searching at this point and return the best path found so far.
+	Clock::time_point deadline;
+	// Optional; stops the search like the deadline does.
+	const CancelToken* cancel;
+
+	static QueryOptions Bounded(float epsilon) {
+		QueryOptions options;
+		options.epsilon = epsilon;
+		return options;
+	}
+
+	static QueryOptions Within(float epsilon, std::chrono::milliseconds budget) {
+		QueryOptions options;
+		options.epsilon = epsilon;
+		options.deadline = Clock::now() + budget;
+		return options;
+	}
+
+	bool HasDeadline() const { return deadline != Clock::time_point::max() || cancel; }
+	bool Expired() const { return (cancel && cancel->IsCancelled()) || Clock::now() >= deadline; }
+};
+
+// Work done by one path query.  Searches fill the counters they can; the
+// times and the path length are filled by IGraph::GetPath.
+struct QueryStats {
+	QueryStats() : nodesSettled(0), edgesRelaxed(0), heapPushes(0), heapPops(0), peakQueue(0),
+		snapSeconds(0), searchSeconds(0), pathLength(0), pathNodes(0) {}
+
+	// nodes expanded (popped and not stale)
+	long nodesSettled;
+	// edges looked at while expanding them
+	long edgesRelaxed;
+	long heapPushes;
+	long heapPops;
+	// largest number of entries in the open queue at any time
+	long peakQueue;
+	// finding the nearest edges or nodes to the requested positions
+	double snapSeconds;
+	double searchSeconds;
+	float pathLength;
+	int pathNodes;
+
+	void Pushed(long queueSize) {
+		heapPushes++;
+		if (queueSize > peakQueue) {
+			peakQueue = queueSize;
+		}
+	}
+};
+
+struct QueryResult {
+	enum Status {
+		// the bound requested by epsilon was met
+		COMPLETE,
+		// the deadline or cancel token stopped the search first
+		INTERRUPTED,
+		// no path exists
+		UNREACHABLE
+	};
+
+	QueryResult() : status(UNREACHABLE), length(std::numeric_limits<float>::infinity()),
+		bound(std::numeric_limits<float>::infinity()) {}
+
+	Status status;
+	// Node names from source to target; empty if nothing was found in time.
+	std::vector<std::string> path;
+	float length;
+	// The path is at most bound times longer than the optimal one: 1 means
+	// proven optimal, infinity means no guarantee.
+	float bound;
+	QueryStats stats;
+};
+
+}
+
+#endif
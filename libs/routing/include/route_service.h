@@ -0,0 +1,48 @@
+#ifndef ROUTE_SERVICE_H_
+#define ROUTE_SERVICE_H_
+
+#include <atomic>
+#include <future>
+#include <memory>
+#include <vector>
+#include "graph.h"
+#include "util/thread_pool.h"
+
+namespace routing {
+
+// Runs path queries on a pool of worker threads so callers such as a
+// simulation tick never wait on a search.  Requests hold a reference to
+// their graph, so a map swapped out while a query is queued or running stays
+// alive until the query is done.
+class RouteService {
+public:
+	// threads <= 0 means DefaultThreadCount().
+	explicit RouteService(int threads = 0) : pool(threads), synchronous(false) {}
+	virtual ~RouteService() {}
+
+	// Queues a query.  epsilon and budgetMs become its QueryOptions; the
+	// budget starts when a worker picks the query up, not when it is queued.
+	// strategy must outlive the query.
+	std::future<Route> Request(std::shared_ptr<const IGraph> graph, const std::vector<float>& src, const std::vector<float>& dest,
+		const RoutingStrategy& strategy, float epsilon = 0, int budgetMs = 0);
+
+	// Queries queued or running.
+	int Pending() const { return pool.Pending(); }
+
+	// Synchronous mode runs each query inline in Request and ignores its
+	// budget, so routes do not depend on machine speed or load (e.g. for
+	// reproducible headless runs).  The returned future is already ready.
+	void SetSynchronous(bool synchronous) { this->synchronous = synchronous; }
+	bool IsSynchronous() const { return synchronous; }
+
+	// Process-wide service, started on first use.
+	static RouteService& Shared();
+
+private:
+	ThreadPool pool;
+	std::atomic<bool> synchronous;
+};
+
+}
+
+#endif
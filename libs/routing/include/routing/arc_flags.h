@@ -0,0 +1,82 @@
+#ifndef ARC_FLAGS_H_
+#define ARC_FLAGS_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "compact_graph.h"
+#include "routing_strategy.h"
+
+namespace routing {
+
+// Arc-flag preprocessing over a CompactGraph.  Nodes are split into up to 64
+// cells by a k-d partition of their ground (x/z) positions, and every edge
+// gets one bit per cell: the bit is set when the edge starts a shortest path
+// to some node of that cell.  A search towards a target in cell c only has to
+// relax edges with bit c set.
+//
+// Flags read the graph's current weights, so after changing the weight
+// overlay with CompactGraph::SetEdgeWeight, report the change with
+// WeightChanged() and call Refresh() to recompute only the affected cells.
+class ArcFlags {
+public:
+	static const int MAX_CELLS = 64;
+
+	// Partitions the graph and computes all flags, one cell per task on up to
+	// `threads` threads.
+	ArcFlags(const CompactGraph& graph, int cells = 32, int threads = 0);
+	virtual ~ArcFlags() {}
+
+	const CompactGraph& GetCompactGraph() const { return graph; }
+	int NumCells() const { return cells; }
+	int CellOf(int node) const { return cellOf[node]; }
+	uint64_t Flags(int edge) const { return flags[edge]; }
+	bool Flag(int edge, int cell) const { return (flags[edge] >> cell) & 1; }
+	MemoryReport GetMemoryReport() const;
+
+	// Marks the cells whose flags may be stale after edge's weight went from
+	// previous to its current value.  A heavier edge can only drop off the
+	// shortest paths it was on, so only its own cells are affected; a lighter
+	// one can become a shortcut to anywhere.
+	void WeightChanged(int edge, float previous);
+	// Recomputes the flags of every marked cell and returns how many there were.
+	int Refresh(int threads = 0);
+
+private:
+	void partition(std::vector<int>& nodes, int begin, int end, int firstCell, int count);
+	void compute(const std::vector<int>& dirty, int threads);
+	std::vector<int> flaggedEdges(int cell) const;
+
+	const CompactGraph& graph;
+	int cells;
+	std::vector<int> cellOf;
+	std::vector< std::vector<int> > boundary;
+	std::vector<uint64_t> flags;
+	uint64_t dirty;
+};
+
+// A* over a CompactGraph that skips edges not flagged for the target's cell.
+// Paths are the same as AStar's; queries on any other graph fall back to
+// AStar::Default().
+class ArcFlagAStar : public RoutingStrategy {
+public:
+	ArcFlagAStar(const ArcFlags& flags) : flags(flags) {}
+	virtual ~ArcFlagAStar() {}
+
+	using RoutingStrategy::GetPath;
+	std::vector<std::string> GetPath(const IGraph* graph, const std::string& from, const std::string& to) const;
+	QueryResult GetPath(const IGraph* graph, const std::string& from, const std::string& to, const QueryOptions& options) const;
+	bool SupportsVirtualNodes() const { return false; }
+	std::string GetName() const { return "arc-flags"; }
+	// Index-based query; empty if to cannot be reached.
+	std::vector<int> GetPath(int from, int to) const;
+
+private:
+	std::vector<int> search(int from, int to, QueryStats& stats) const;
+
+	const ArcFlags& flags;
+};
+
+}
+
+#endif
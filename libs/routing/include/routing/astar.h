@@ -14,6 +14,12 @@ public:
 	virtual ~AStar();
 
 	std::vector<std::string> GetPath(const IGraph* graph, const std::string& from, const std::string& to) const;
+	// Weighted A* with weight 1 + epsilon.  A query that is still without a
+	// path at half its deadline inflates the heuristic further to find one,
+	// then keeps improving it until it is within (1 + epsilon) of optimal or
+	// time runs out; the result carries the bound reached.
+	QueryResult GetPath(const IGraph* graph, const std::string& from, const std::string& to, const QueryOptions& options) const;
+	std::string GetName() const { return "astar"; }
 
 	static const RoutingStrategy& Default() {
 		static AStar astar;
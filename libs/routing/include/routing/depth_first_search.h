@@ -10,7 +10,10 @@ class DepthFirstSearch : public RoutingStrategy {
 public:
 	virtual ~DepthFirstSearch() {}
 
+	using RoutingStrategy::GetPath;
 	std::vector<std::string> GetPath(const IGraph* graph, const std::string& from, const std::string& to) const;
+	QueryResult GetPath(const IGraph* graph, const std::string& from, const std::string& to, const QueryOptions& options) const;
+	std::string GetName() const { return "dfs"; }
 
 	static const RoutingStrategy& Default() {
 		static DepthFirstSearch dfs;
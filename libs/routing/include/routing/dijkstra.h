@@ -11,6 +11,8 @@ public:
     Dijkstra() : AStar(new EuclideanDistance(), new ZeroDistance()) {}
 	virtual ~Dijkstra() {}
 
+	std::string GetName() const { return "dijkstra"; }
+
 	static const RoutingStrategy& Instance() {
 		static Dijkstra dikjstra;
 		return dikjstra;
@@ -0,0 +1,63 @@
+#ifndef HUB_LABELS_H_
+#define HUB_LABELS_H_
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include "compact_graph.h"
+#include "distance_oracle.h"
+
+namespace routing {
+
+// Exact shortest-path distance oracle using hub labels.  Every node keeps a
+// forward label (hubs it can reach, with distances) and a backward label
+// (hubs that reach it); d(s, t) is the minimum of out(s)[h] + in(t)[h] over
+// the hubs the two labels share, found with a linear merge of labels sorted
+// by hub rank.  Labels are built with pruned Dijkstra searches from every
+// node, most important first, where importance comes from a contraction
+// order.
+class HubLabels : public DistanceOracle {
+public:
+	// Builds the labels; takes a few seconds on city-sized maps.
+	HubLabels(const CompactGraph& graph);
+	virtual ~HubLabels() {}
+
+	float GetDistance(const IGraph* graph, const std::string& from, const std::string& to) const;
+	// Distance between CompactGraph node indices.
+	float Distance(int from, int to) const;
+
+	const CompactGraph& GetCompactGraph() const { return graph; }
+	// Node indices from most to least important.
+	const std::vector<int>& GetOrder() const { return order; }
+	long NumEntries() const { return outHubs.size() + inHubs.size(); }
+	float AverageLabelSize() const;
+	MemoryReport GetMemoryReport() const;
+
+	// Node order for contraction hierarchies, least important first, using
+	// edge difference plus deleted neighbors as the importance measure.
+	static std::vector<int> ContractionOrder(const CompactGraph& graph);
+
+	// Binary (de)serialization for labels built offline.  Load returns NULL
+	// when the data was built for another graph (see
+	// CompactGraph::GetFingerprint) or is malformed.
+	void Save(std::ostream& out) const;
+	static HubLabels* Load(std::istream& in, const CompactGraph& graph);
+
+private:
+	HubLabels(const CompactGraph& graph, bool build);
+	void build();
+
+	const CompactGraph& graph;
+	std::vector<int> order;
+	// flattened labels; hub entries are ranks into order, sorted ascending
+	std::vector<int> outOffsets;
+	std::vector<int> outHubs;
+	std::vector<float> outDistances;
+	std::vector<int> inOffsets;
+	std::vector<int> inHubs;
+	std::vector<float> inDistances;
+};
+
+}
+
+#endif
@@ -0,0 +1,47 @@
+#ifndef ISOCHRONE_H_
+#define ISOCHRONE_H_
+
+#include <vector>
+#include "compact_graph.h"
+
+namespace routing {
+
+struct ReachedNode {
+	const IGraphNode* node;
+	int index;
+	float distance;
+};
+
+// One-to-all reachability ("which nodes can I reach within D meters / T
+// seconds?") over a CompactGraph.  Bounded queries run a plain Dijkstra that
+// stops at the limit; full sweeps use parallel delta-stepping.
+class Isochrone {
+public:
+	Isochrone(const CompactGraph& graph) : graph(graph) {}
+
+	// Every node whose shortest-path distance from source is <= limit, in
+	// increasing distance order.
+	std::vector<ReachedNode> Reachable(int source, float limit) const;
+	// Same, starting from the node nearest to position.
+	std::vector<ReachedNode> Reachable(const std::vector<float>& position, float limit) const;
+	// Nodes reachable within the given time at a constant travel speed.
+	std::vector<ReachedNode> ReachableWithin(const std::vector<float>& position, float seconds, float speed) const;
+
+	// Shortest-path distance from source to every node (infinity when
+	// unreachable) using delta-stepping on up to `threads` threads.  A
+	// non-positive delta picks the mean edge weight as bucket width.
+	std::vector<float> AllDistances(int source, int threads = 0, float delta = 0) const;
+
+	// Outline of the reached area in the ground (x/z) plane.  Hull edges
+	// longer than maxEdge are dug in towards interior nodes, so a larger
+	// maxEdge gives a shape closer to the convex hull.
+	std::vector< std::vector<float> > Polygon(const std::vector<ReachedNode>& reached, float maxEdge) const;
+	static std::vector< std::vector<float> > ConcaveHull(const std::vector< std::vector<float> >& points, float maxEdge);
+
+private:
+	const CompactGraph& graph;
+};
+
+}
+
+#endif
@@ -3,7 +3,9 @@
 
 #include <string>
 #include <vector>
+#include "graph.h"
 #include "graph_factory.h"
+#include "routing_strategy.h"
 
 namespace routing {
 
@@ -14,8 +16,19 @@ public:
     virtual IGraph* LoadFromFile(const std::string& file) const;
     virtual void AddFactory(const IGraphFactory* factory);
 
+    // Strategies available by name (RoutingStrategy::GetName), owned by the
+    // API.  AStar, Dijkstra and DepthFirstSearch are always registered.
+    virtual void AddStrategy(const RoutingStrategy* strategy);
+    const std::vector<const RoutingStrategy*>& GetStrategies() const { return strategies; }
+    // NULL if no strategy has that name.
+    const RoutingStrategy* GetStrategy(const std::string& name) const;
+
+    // IGraph::GetPaths, with requests that name no strategy run by A*.
+    virtual std::vector<Route> GetPaths(const IGraph* graph, std::vector<PathRequest> requests, int threads = 0) const;
+
 private:
     std::vector<const IGraphFactory*> factories;
+    std::vector<const RoutingStrategy*> strategies;
 };
 
 }
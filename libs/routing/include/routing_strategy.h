@@ -4,6 +4,7 @@
 #include <vector>
 #include <string>
 #include "graph.h"
+#include "query_options.h"
 
 namespace routing {
 
@@ -13,6 +14,19 @@ class RoutingStrategy {
 public:
 	virtual ~RoutingStrategy() {}
 	virtual std::vector<std::string> GetPath(const IGraph* graph, const std::string& from, const std::string& to) const = 0;
+	// Path query with an optimality bound and a deadline.  Strategies that do
+	// not support either run GetPath to completion and report no bound.
+	virtual QueryResult GetPath(const IGraph* graph, const std::string& from, const std::string& to, const QueryOptions& options) const;
+	// Whether the strategy works on overlay graphs (impl/virtual_graph.h) by
+	// looking nodes up by name and expanding them with IGraph::GetNeighbors.
+	// Strategies running on a precomputed index of the base graph cannot.
+	virtual bool SupportsVirtualNodes() const { return true; }
+	// Name the strategy's queries are reported under (see query_metrics.h).
+	virtual std::string GetName() const { return "custom"; }
+
+protected:
+	// Euclidean length of a path of node names.
+	static float PathLength(const IGraph* graph, const std::vector<std::string>& path);
 };
 
 }
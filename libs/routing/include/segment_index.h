@@ -0,0 +1,60 @@
+#ifndef SEGMENT_INDEX_H_
+#define SEGMENT_INDEX_H_
+
+#include <vector>
+#include "graph.h"
+
+namespace routing {
+
+// Closest point on an edge of the graph.  position lies on the segment
+// from -> to, t of the way along it.
+struct EdgePoint {
+	const IGraphNode* from;
+	const IGraphNode* to;
+	float t;
+	std::vector<float> position;
+	float distance;
+};
+
+// Static R-tree over every edge segment of a graph, bulk loaded with
+// sort-tile-recursive packing: segments are sorted into vertical slices by
+// x, each slice by z, and runs of NODE_SIZE become the leaves.  Every level
+// above packs runs of NODE_SIZE boxes of the level below, so the tree is a
+// few flat arrays with no child pointers.
+class SegmentIndex {
+public:
+	static const int NODE_SIZE = 16;
+
+	SegmentIndex(const IGraph* graph);
+	virtual ~SegmentIndex() {}
+
+	int NumSegments() const { return segments.size(); }
+	MemoryReport GetMemoryReport() const;
+	// Best-first search for the segment closest to point.  Returns false
+	// only if the graph has no edges.
+	bool Nearest(const std::vector<float>& point, EdgePoint& result) const;
+
+private:
+	struct Box {
+		float min[3];
+		float max[3];
+	};
+	struct Segment {
+		const IGraphNode* from;
+		const IGraphNode* to;
+		float a[3];
+		float b[3];
+	};
+
+	static float boxDistance(const Box& box, const float* p);
+	static float segmentDistance(const Segment& segment, const float* p, float& t);
+
+	std::vector<Segment> segments;
+	// levels[0] bounds the segments one-to-one; levels[k][i] bounds
+	// levels[k-1][i*NODE_SIZE, (i+1)*NODE_SIZE)
+	std::vector< std::vector<Box> > levels;
+};
+
+}
+
+#endif
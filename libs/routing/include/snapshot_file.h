@@ -0,0 +1,63 @@
+#ifndef SNAPSHOT_FILE_H_
+#define SNAPSHOT_FILE_H_
+
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "graph.h"
+#include "graph_factory.h"
+
+namespace routing {
+
+// Compact binary map format (".snap"), loaded without any parsing or
+// component filtering:
+//
+//   "RSNAP001"  int32 nodes  int32 edges
+//   per node:   float x, y, z  uint32 name length  name bytes
+//   int32 target of every edge, grouped by source node
+//   int32 offsets[nodes + 1] into the targets
+//
+// Targets come before offsets so a writer can stream edges without knowing
+// the degrees up front.
+class SnapshotWriter {
+public:
+	// Throws std::runtime_error if the file cannot be created.
+	SnapshotWriter(const std::string& file);
+	virtual ~SnapshotWriter();
+
+	// Nodes are numbered in the order they are added.
+	void AddNode(const std::string& name, float x, float y, float z);
+	// Edges must be added after all nodes, sorted by source.
+	void AddEdge(int from, int to);
+	// Writes the offsets and the final counts; the file is complete after this.
+	void Finish();
+
+private:
+	void write(const void* data, size_t size);
+
+	std::string file;
+	FILE* out;
+	int numNodes;
+	int numEdges;
+	int lastSource;
+	std::vector<int> degree;
+};
+
+class SnapshotFile {
+public:
+	// Writes an in-memory graph.
+	static void Write(const std::string& file, const IGraph* graph);
+	// Reads a snapshot into a SimpleGraph; throws std::runtime_error if the
+	// file is not a complete snapshot.
+	static IGraph* Read(const std::string& file);
+};
+
+class SnapshotGraphFactory : public IGraphFactory {
+public:
+	virtual ~SnapshotGraphFactory() {}
+	IGraph* Create(const std::string& file) const;
+};
+
+}
+
+#endif
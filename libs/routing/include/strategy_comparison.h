@@ -0,0 +1,103 @@
+#ifndef STRATEGY_COMPARISON_H_
+#define STRATEGY_COMPARISON_H_
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include "graph.h"
+#include "routing_api.h"
+
+namespace routing {
+
+// Runs one set of OD pairs through several strategies and compares every
+// path with the optimal one, found by a reference strategy (Dijkstra by
+// default), by length ratio, nodes settled and wall time.  Pairs are node
+// positions, so every strategy routes between the same two nodes whether or
+// not it supports virtual nodes.
+class StrategyComparison {
+public:
+	struct Pair {
+		std::vector<float> src;
+		std::vector<float> dest;
+	};
+
+	// One query of one strategy.
+	struct Sample {
+		int pair;
+		QueryResult::Status status;
+		float length;
+		// length over the optimal length: infinity if nothing was found
+		// although a path exists, 1 if both found nothing
+		float ratio;
+		long nodesSettled;
+		double seconds;
+		std::vector< std::vector<float> > path;
+	};
+
+	struct Summary {
+		int queries;
+		// queries that found no path although one exists
+		int failures;
+		// over the queries that found a path
+		float meanRatio;
+		float maxRatio;
+		double meanSettled;
+		double meanMicros;
+		double p50Micros;
+		double p99Micros;
+	};
+
+	StrategyComparison(const IGraph* graph);
+	StrategyComparison(const IGraph* graph, const RoutingStrategy& reference);
+	virtual ~StrategyComparison() {}
+
+	// Queries run with QueryOptions of the given epsilon and, if budgetMs is
+	// positive, a deadline that many milliseconds after each query starts.
+	void AddStrategy(const std::string& name, const RoutingStrategy& strategy, float epsilon = 0, int budgetMs = 0);
+	// Every strategy registered with api, under its own name.
+	void AddStrategies(const RoutingAPI& api);
+
+	void AddPair(const std::vector<float>& src, const std::vector<float>& dest);
+	// count pairs of distinct random nodes
+	void AddRandomPairs(int count, unsigned seed);
+
+	// Finds the optimal paths, then runs every strategy on every pair.
+	void Run();
+
+	int NumStrategies() const { return strategies.size(); }
+	const std::string& GetName(int strategy) const { return strategies[strategy].name; }
+	const std::vector<Pair>& GetPairs() const { return pairs; }
+	const Sample& GetOptimal(int pair) const { return optimal[pair]; }
+	const std::vector<Sample>& GetSamples(int strategy) const { return strategies[strategy].samples; }
+
+	Summary Summarize(int strategy) const;
+	// Indices into GetSamples(strategy) of its worst queries: highest ratio
+	// first, the slower query first among equal ratios.
+	std::vector<int> Worst(int strategy, int count) const;
+
+	// One line per strategy.
+	void PrintSummary(std::ostream& out) const;
+	// One row per strategy and query.
+	void WriteCsv(std::ostream& out) const;
+
+private:
+	struct Entry {
+		std::string name;
+		const RoutingStrategy* strategy;
+		float epsilon;
+		int budgetMs;
+		std::vector<Sample> samples;
+	};
+
+	Sample run(const RoutingStrategy& strategy, float epsilon, int budgetMs, int pair) const;
+
+	const IGraph* graph;
+	const RoutingStrategy& reference;
+	std::vector<Pair> pairs;
+	std::vector<Sample> optimal;
+	std::vector<Entry> strategies;
+};
+
+}
+
+#endif
@@ -0,0 +1,94 @@
+#ifndef UTIL_ASSIGNMENT_H_
+#define UTIL_ASSIGNMENT_H_
+
+#include <limits>
+#include <vector>
+
+namespace routing {
+
+// Minimum-cost assignment between the rows and columns of a cost matrix,
+// using the Hungarian algorithm in its shortest augmenting path form: rows
+// are added one at a time and each is matched along the cheapest path of
+// reduced costs, with row and column potentials keeping the reduced costs
+// non-negative.  O(rows^2 cols) for rows <= cols.
+//
+// cost is rows x cols, row-major, and must be finite.  Returns the column
+// assigned to every row.  When there are more rows than columns every
+// column is used and the rows left over get -1.
+inline std::vector<int> SolveAssignment(const std::vector<double>& cost, int rows, int cols) {
+    std::vector<int> result(rows, -1);
+    if (rows == 0 || cols == 0) {
+        return result;
+    }
+    if (rows > cols) {
+        std::vector<double> transposed(cost.size());
+        for (int i = 0; i < rows; i++) {
+            for (int j = 0; j < cols; j++) {
+                transposed[j*rows + i] = cost[i*cols + j];
+            }
+        }
+        std::vector<int> columns = SolveAssignment(transposed, cols, rows);
+        for (int j = 0; j < cols; j++) {
+            result[columns[j]] = j;
+        }
+        return result;
+    }
+
+    const double infinity = std::numeric_limits<double>::infinity();
+    // 1-based; column 0 is a virtual column the new row starts from
+    std::vector<double> u(rows + 1, 0), v(cols + 1, 0);
+    std::vector<int> match(cols + 1, 0);  // row matched to each column
+    std::vector<int> way(cols + 1, 0);    // previous column on the path
+    for (int i = 1; i <= rows; i++) {
+        match[0] = i;
+        int j0 = 0;
+        std::vector<double> minv(cols + 1, infinity);
+        std::vector<bool> used(cols + 1, false);
+        do {
+            used[j0] = true;
+            int i0 = match[j0];
+            double delta = infinity;
+            int j1 = 0;
+            for (int j = 1; j <= cols; j++) {
+                if (used[j]) {
+                    continue;
+                }
+                double reduced = cost[(i0 - 1)*cols + j - 1] - u[i0] - v[j];
+                if (reduced < minv[j]) {
+                    minv[j] = reduced;
+                    way[j] = j0;
+                }
+                if (minv[j] < delta) {
+                    delta = minv[j];
+                    j1 = j;
+                }
+            }
+            for (int j = 0; j <= cols; j++) {
+                if (used[j]) {
+                    u[match[j]] += delta;
+                    v[j] -= delta;
+                }
+                else {
+                    minv[j] -= delta;
+                }
+            }
+            j0 = j1;
+        } while (match[j0] != 0);
+        // flip the matching along the path back to the virtual column
+        do {
+            int j1 = way[j0];
+            match[j0] = match[j1];
+            j0 = j1;
+        } while (j0 != 0);
+    }
+    for (int j = 1; j <= cols; j++) {
+        if (match[j] != 0) {
+            result[match[j] - 1] = j - 1;
+        }
+    }
+    return result;
+}
+
+}
+
+#endif
@@ -0,0 +1,60 @@
+#ifndef UTIL_BINARY_IO_H_
+#define UTIL_BINARY_IO_H_
+
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+namespace routing {
+
+// Length-prefixed raw vectors for the binary index files (hub labels, POI
+// tables).  Only for trivially copyable element types; files are read back
+// on the machine that wrote them.
+template <class T>
+void WriteVector(std::ostream& out, const std::vector<T>& values) {
+    long size = values.size();
+    out.write(reinterpret_cast<const char*>(&size), sizeof(size));
+    out.write(reinterpret_cast<const char*>(values.data()), size*sizeof(T));
+}
+
+template <class T>
+bool ReadVector(std::istream& in, std::vector<T>& values) {
+    long size = 0;
+    in.read(reinterpret_cast<char*>(&size), sizeof(size));
+    if (!in || size < 0) {
+        return false;
+    }
+    values.resize(size);
+    in.read(reinterpret_cast<char*>(values.data()), size*sizeof(T));
+    return bool(in);
+}
+
+// FNV-1a over raw bytes, written next to an index so a file built for
+// another version of the map is rejected even when its sizes still match.
+// Same restrictions as WriteVector.
+class Fingerprint {
+public:
+    template <class T>
+    void Add(const T* values, size_t count) {
+        const unsigned char* bytes = reinterpret_cast<const unsigned char*>(values);
+        for (size_t i = 0; i < count*sizeof(T); i++) {
+            hash = (hash ^ bytes[i])*1099511628211ull;
+        }
+    }
+
+    template <class T>
+    void Add(const std::vector<T>& values) {
+        long size = values.size();
+        Add(&size, 1);
+        Add(values.data(), values.size());
+    }
+
+    uint64_t Value() const { return hash; }
+
+private:
+    uint64_t hash = 14695981039346656037ull;
+};
+
+}
+
+#endif
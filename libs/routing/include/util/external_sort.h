@@ -0,0 +1,241 @@
+#ifndef UTIL_EXTERNAL_SORT_H_
+#define UTIL_EXTERNAL_SORT_H_
+
+#include <algorithm>
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <queue>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace routing {
+
+// Sorts more fixed-size records than fit in memory.  Records are buffered
+// until the buffer holds memoryBudget bytes, then sorted and spilled to a
+// run file next to prefix.  Sorted() merges the runs back with a k-way merge,
+// merging in several rounds when the budget cannot give every run a
+// reasonable read buffer.  Record must be trivially copyable.
+template <class Record, class Less = std::less<Record> >
+class ExternalSorter {
+public:
+    // Smallest read buffer per run during a merge.
+    static const size_t MIN_RUN_BUFFER = 64*1024;
+
+    class Reader;
+
+    ExternalSorter(const std::string& prefix, size_t memoryBudget, Less less = Less())
+        : prefix(prefix), budget(std::max(memoryBudget, 2*MIN_RUN_BUFFER)), less(less), size(0), nextRun(0) {
+        capacity = std::max<size_t>(1, budget/sizeof(Record));
+    }
+
+    ~ExternalSorter() {
+        for (const std::string& run : runs) {
+            std::remove(run.c_str());
+        }
+    }
+
+    void Add(const Record& record) {
+        if (buffer.size() >= capacity) {
+            spill();
+        }
+        else if (buffer.empty()) {
+            buffer.reserve(capacity);
+        }
+        buffer.push_back(record);
+        size++;
+    }
+
+    long Size() const { return size; }
+    // Run files written so far, including intermediate merge rounds.
+    int NumRuns() const { return nextRun; }
+
+    // Writes whatever is buffered to a run and releases the buffer, so the
+    // records no longer count against memory until Sorted() reads them back.
+    void Flush() {
+        if (!buffer.empty()) {
+            spill();
+        }
+        std::vector<Record>().swap(buffer);
+    }
+
+    // Streams every added record in sorted order, using up to readBudget
+    // bytes of read buffers (the sorter's own budget when 0).  Call once,
+    // after the last Add.
+    std::unique_ptr<Reader> Sorted(size_t readBudget = 0) {
+        if (runs.empty()) {
+            std::sort(buffer.begin(), buffer.end(), less);
+            return std::unique_ptr<Reader>(new Reader(buffer, less));
+        }
+        Flush();
+        size_t budget = std::max(readBudget > 0 ? readBudget : this->budget, 2*MIN_RUN_BUFFER);
+
+        size_t fanIn = std::max<size_t>(2, budget/MIN_RUN_BUFFER);
+        while (runs.size() > fanIn) {
+            std::vector<std::string> group(runs.begin(), runs.begin() + fanIn);
+            // the merged run is tracked before it exists and the group until
+            // the merge succeeded, so a failed round leaves no files behind
+            std::string merged = runName();
+            runs.push_back(merged);
+            {
+                Reader reader(group, budget, less);
+                FILE* out = openFile(merged, "wb");
+                Record record;
+                bool written = true;
+                try {
+                    while (written && reader.Next(record)) {
+                        written = fwrite(&record, sizeof(Record), 1, out) == 1;
+                    }
+                }
+                catch (...) {
+                    fclose(out);
+                    throw;
+                }
+                if (fclose(out) != 0 || !written) {
+                    throw std::runtime_error("unable to write temporary file " + merged);
+                }
+            }
+            for (const std::string& run : group) {
+                std::remove(run.c_str());
+            }
+            runs.erase(runs.begin(), runs.begin() + fanIn);
+        }
+        return std::unique_ptr<Reader>(new Reader(runs, budget, less));
+    }
+
+    // Pull-based k-way merge over the sorted runs (or the in-memory buffer
+    // when nothing was spilled).
+    class Reader {
+    public:
+        Reader(const std::vector<Record>& memory, Less less) : memory(&memory), position(0), heap(Later(this, less)) {}
+
+        Reader(const std::vector<std::string>& files, size_t budget, Less less) : memory(NULL), position(0), heap(Later(this, less)) {
+            size_t perRun = std::max<size_t>(1, budget/std::max<size_t>(1, files.size())/sizeof(Record));
+            try {
+                for (const std::string& file : files) {
+                    sources.push_back(Source());
+                    Source& source = sources.back();
+                    source.file = NULL;
+                    source.file = openFile(file, "rb");
+                    source.buffer.resize(perRun);
+                    source.count = 0;
+                    source.next = 0;
+                }
+                for (int i = 0; i < sources.size(); i++) {
+                    if (refill(sources[i])) {
+                        heap.push(i);
+                    }
+                }
+            }
+            catch (...) {
+                close();
+                throw;
+            }
+        }
+
+        ~Reader() { close(); }
+
+        bool Next(Record& record) {
+            if (memory) {
+                if (position >= memory->size()) {
+                    return false;
+                }
+                record = (*memory)[position++];
+                return true;
+            }
+            if (heap.empty()) {
+                return false;
+            }
+            int i = heap.top();
+            heap.pop();
+            Source& source = sources[i];
+            record = source.buffer[source.next++];
+            if (source.next < source.count || refill(source)) {
+                heap.push(i);
+            }
+            return true;
+        }
+
+    private:
+        void close() {
+            for (Source& source : sources) {
+                if (source.file) {
+                    fclose(source.file);
+                    source.file = NULL;
+                }
+            }
+        }
+
+        struct Source {
+            FILE* file;
+            std::vector<Record> buffer;
+            size_t count;
+            size_t next;
+        };
+
+        // orders run indices by their current record, smallest on top
+        struct Later {
+            Later(const Reader* reader, Less less) : reader(reader), less(less) {}
+            bool operator()(int a, int b) const {
+                const Source& sa = reader->sources[a];
+                const Source& sb = reader->sources[b];
+                return less(sb.buffer[sb.next], sa.buffer[sa.next]);
+            }
+            const Reader* reader;
+            Less less;
+        };
+
+        bool refill(Source& source) {
+            source.count = fread(source.buffer.data(), sizeof(Record), source.buffer.size(), source.file);
+            source.next = 0;
+            if (source.count == 0 && ferror(source.file)) {
+                throw std::runtime_error("unable to read temporary file");
+            }
+            return source.count > 0;
+        }
+
+        const std::vector<Record>* memory;
+        size_t position;
+        std::vector<Source> sources;
+        std::priority_queue<int, std::vector<int>, Later> heap;
+    };
+
+private:
+    static FILE* openFile(const std::string& file, const char* mode) {
+        FILE* handle = fopen(file.c_str(), mode);
+        if (!handle) {
+            throw std::runtime_error("unable to open temporary file " + file);
+        }
+        return handle;
+    }
+
+    std::string runName() {
+        return prefix + ".run" + std::to_string(nextRun++);
+    }
+
+    void spill() {
+        std::sort(buffer.begin(), buffer.end(), less);
+        std::string run = runName();
+        FILE* out = openFile(run, "wb");
+        runs.push_back(run);
+        bool written = fwrite(buffer.data(), sizeof(Record), buffer.size(), out) == buffer.size();
+        if (fclose(out) != 0 || !written) {
+            throw std::runtime_error("unable to write temporary file " + run);
+        }
+        buffer.clear();
+    }
+
+    std::string prefix;
+    size_t budget;
+    size_t capacity;
+    Less less;
+    std::vector<Record> buffer;
+    std::vector<std::string> runs;
+    long size;
+    int nextRun;
+};
+
+}
+
+#endif
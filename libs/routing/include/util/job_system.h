@@ -0,0 +1,199 @@
+#ifndef UTIL_JOB_SYSTEM_H_
+#define UTIL_JOB_SYSTEM_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "util/parallel.h"
+
+namespace routing {
+
+// Persistent worker threads for data-parallel loops that run many times a
+// second, where starting threads per loop (ParallelFor) would cost more than
+// the loop itself.  Every worker owns a deque of index ranges: it splits the
+// range it pops in halves, keeps working on the lower half and leaves the
+// upper half where an idle worker can steal it, so uneven per-item costs even
+// out without a central queue.  The calling thread works as worker 0.
+class JobSystem {
+public:
+    // threads <= 0 means DefaultThreadCount().
+    explicit JobSystem(int threads = 0) : remaining(0), generation(0), stopping(false) {
+        threads = DefaultThreadCount(threads);
+        for (int i = 0; i < threads; i++) {
+            queues.push_back(std::unique_ptr<Queue>(new Queue()));
+        }
+        for (int i = 1; i < threads; i++) {
+            workers.push_back(std::thread([this, i]() { work(i); }));
+        }
+    }
+
+    ~JobSystem() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (std::thread& worker : workers) {
+            worker.join();
+        }
+    }
+
+    int NumThreads() const { return queues.size(); }
+
+    // Calls body(begin, end, worker) on disjoint ranges of at most grain
+    // items that together cover [0, count), and returns once all of them
+    // have run.  worker is in [0, NumThreads()), so the body can write to
+    // per-worker buffers without locking.  The first exception thrown by the
+    // body is rethrown here.  Only one loop may run at a time.
+    template <class Body>
+    void ParallelFor(int count, int grain, const Body& body) {
+        if (count <= 0) {
+            return;
+        }
+        grain = std::max(grain, 1);
+        if (queues.size() == 1 || count <= grain) {
+            for (int begin = 0; begin < count; begin += grain) {
+                body(begin, std::min(count, begin + grain), 0);
+            }
+            return;
+        }
+
+        this->body = [&body](int begin, int end, int worker) { body(begin, end, worker); };
+        this->grain = grain;
+        error = std::exception_ptr();
+        remaining = count;
+        // an equal share for every worker to start from
+        int n = queues.size();
+        for (int i = 0; i < n; i++) {
+            Range range(count*(long)i/n, count*(long)(i + 1)/n);
+            if (range.begin < range.end) {
+                std::lock_guard<std::mutex> lock(queues[i]->mutex);
+                queues[i]->ranges.push_back(range);
+            }
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            generation++;
+        }
+        wake.notify_all();
+
+        run(0);
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            done.wait(lock, [this]() { return remaining == 0; });
+        }
+        this->body = nullptr;
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+private:
+    struct Range {
+        Range(int begin = 0, int end = 0) : begin(begin), end(end) {}
+        int begin;
+        int end;
+    };
+
+    struct Queue {
+        std::mutex mutex;
+        std::deque<Range> ranges;
+    };
+
+    // Newest range of the worker's own deque, or else the oldest (largest)
+    // range of another worker's.
+    bool pop(int worker, Range& range) {
+        {
+            Queue& own = *queues[worker];
+            std::lock_guard<std::mutex> lock(own.mutex);
+            if (!own.ranges.empty()) {
+                range = own.ranges.back();
+                own.ranges.pop_back();
+                return true;
+            }
+        }
+        int n = queues.size();
+        for (int i = 1; i < n; i++) {
+            Queue& victim = *queues[(worker + i) % n];
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            if (!victim.ranges.empty()) {
+                range = victim.ranges.front();
+                victim.ranges.pop_front();
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Works on the current loop until every range is finished.
+    void run(int worker) {
+        while (remaining > 0) {
+            Range range;
+            if (!pop(worker, range)) {
+                // the rest is being worked on, but may still be split
+                std::this_thread::yield();
+                continue;
+            }
+            while (range.end - range.begin > grain) {
+                int middle = range.begin + (range.end - range.begin)/2;
+                std::lock_guard<std::mutex> lock(queues[worker]->mutex);
+                queues[worker]->ranges.push_back(Range(middle, range.end));
+                range.end = middle;
+            }
+            try {
+                body(range.begin, range.end, worker);
+            }
+            catch (...) {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (!error) {
+                    error = std::current_exception();
+                }
+            }
+            if ((remaining -= range.end - range.begin) == 0) {
+                std::lock_guard<std::mutex> lock(mutex);
+                done.notify_all();
+            }
+        }
+    }
+
+    void work(int worker) {
+        long seen = 0;
+        while (true) {
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wake.wait(lock, [this, seen]() { return stopping || generation != seen; });
+                if (stopping) {
+                    return;
+                }
+                seen = generation;
+            }
+            run(worker);
+        }
+    }
+
+    std::vector< std::unique_ptr<Queue> > queues;
+    std::vector<std::thread> workers;
+    // the loop being run
+    std::function<void(int, int, int)> body;
+    int grain;
+    std::atomic<int> remaining;
+    std::exception_ptr error;
+    long generation;
+    bool stopping;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable done;
+};
+
+}
+
+#endif
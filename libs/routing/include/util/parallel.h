@@ -0,0 +1,51 @@
+#ifndef UTIL_PARALLEL_H_
+#define UTIL_PARALLEL_H_
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+namespace routing {
+
+// Number of worker threads to use when the caller asks for "as many as make
+// sense" (threads <= 0).
+inline int DefaultThreadCount(int threads = 0) {
+    if (threads > 0) {
+        return threads;
+    }
+    int hardware = std::thread::hardware_concurrency();
+    return hardware > 0 ? hardware : 1;
+}
+
+// Splits [0, count) into contiguous chunks and calls
+// body(begin, end, thread) once per chunk, one thread per chunk.  Runs on the
+// calling thread when a single chunk is enough.
+template <class Body>
+void ParallelFor(int count, int threads, const Body& body) {
+    threads = std::min(DefaultThreadCount(threads), count);
+    if (threads <= 1) {
+        if (count > 0) {
+            body(0, count, 0);
+        }
+        return;
+    }
+
+    std::vector<std::thread> workers;
+    int chunk = (count + threads - 1) / threads;
+    for (int t = 1; t < threads; t++) {
+        int begin = t*chunk;
+        int end = std::min(count, begin + chunk);
+        if (begin >= end) {
+            break;
+        }
+        workers.push_back(std::thread([&body, begin, end, t]() { body(begin, end, t); }));
+    }
+    body(0, std::min(count, chunk), 0);
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+}
+
+}
+
+#endif
@@ -0,0 +1,94 @@
+#ifndef UTIL_THREAD_POOL_H_
+#define UTIL_THREAD_POOL_H_
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+#include "util/parallel.h"
+
+namespace routing {
+
+// Fixed set of worker threads taking tasks from one FIFO queue.  Submit
+// returns a future for the task's result; an exception thrown by the task is
+// rethrown from future::get().  The destructor finishes every queued task
+// before joining the workers.
+class ThreadPool {
+public:
+    // threads <= 0 means DefaultThreadCount().
+    explicit ThreadPool(int threads = 0) : stopping(false), running(0) {
+        threads = DefaultThreadCount(threads);
+        for (int i = 0; i < threads; i++) {
+            workers.push_back(std::thread([this]() { work(); }));
+        }
+    }
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (std::thread& worker : workers) {
+            worker.join();
+        }
+    }
+
+    template <class Task>
+    std::future<typename std::result_of<Task()>::type> Submit(Task task) {
+        typedef typename std::result_of<Task()>::type Result;
+        std::shared_ptr< std::packaged_task<Result()> > packaged =
+            std::make_shared< std::packaged_task<Result()> >(std::move(task));
+        std::future<Result> result = packaged->get_future();
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            queue.push_back([packaged]() { (*packaged)(); });
+        }
+        wake.notify_one();
+        return result;
+    }
+
+    int NumThreads() const { return workers.size(); }
+    // Tasks queued or running.
+    int Pending() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return queue.size() + running;
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+private:
+    void work() {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+            wake.wait(lock, [this]() { return stopping || !queue.empty(); });
+            if (queue.empty()) {
+                return;
+            }
+            std::function<void()> task = std::move(queue.front());
+            queue.pop_front();
+            running++;
+            lock.unlock();
+            task();
+            lock.lock();
+            running--;
+        }
+    }
+
+    std::vector<std::thread> workers;
+    std::deque< std::function<void()> > queue;
+    bool stopping;
+    int running;
+    mutable std::mutex mutex;
+    std::condition_variable wake;
+};
+
+}
+
+#endif
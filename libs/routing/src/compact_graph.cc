@@ -0,0 +1,136 @@
+#include "compact_graph.h"
+#include "util/binary_io.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace routing {
+
+CompactGraph::CompactGraph(const IGraph* graph) : graph(graph) {
+    build(EuclideanDistance());
+}
+
+CompactGraph::CompactGraph(const IGraph* graph, const DistanceFunction& cost) : graph(graph) {
+    build(cost);
+}
+
+void CompactGraph::build(const DistanceFunction& cost) {
+    const std::vector<IGraphNode*>& all = graph->GetNodes();
+    int n = all.size();
+
+    nodes.reserve(n);
+    indices.reserve(n);
+    positions.resize(3*n, 0.0f);
+    for (int i = 0; i < n; i++) {
+        nodes.push_back(all[i]);
+        indices[all[i]] = i;
+        std::vector<float> pos = all[i]->GetPosition();
+        for (int j = 0; j < 3 && j < pos.size(); j++) {
+            positions[3*i + j] = pos[j];
+        }
+    }
+
+    offsets.resize(n + 1, 0);
+    std::vector<int> inDegree(n + 1, 0);
+    for (int i = 0; i < n; i++) {
+        std::vector<float> from = all[i]->GetPosition();
+        for (IGraphNode* neighbor : all[i]->GetNeighbors()) {
+            auto it = indices.find(neighbor);
+            if (it == indices.end()) {
+                continue;
+            }
+            targets.push_back(it->second);
+            weights.push_back(cost.Calculate(from, neighbor->GetPosition()));
+            inDegree[it->second + 1]++;
+        }
+        offsets[i + 1] = targets.size();
+    }
+
+    reverseOffsets.resize(n + 1, 0);
+    for (int i = 0; i < n; i++) {
+        reverseOffsets[i + 1] = reverseOffsets[i] + inDegree[i + 1];
+    }
+    reverseSources.resize(targets.size());
+    reverseEdges.resize(targets.size());
+    std::vector<int> fill(reverseOffsets.begin(), reverseOffsets.end() - 1);
+    for (int u = 0; u < n; u++) {
+        for (int e = offsets[u]; e < offsets[u + 1]; e++) {
+            int r = fill[targets[e]]++;
+            reverseSources[r] = u;
+            reverseEdges[r] = e;
+        }
+    }
+}
+
+int CompactGraph::IndexOf(const IGraphNode* node) const {
+    auto it = indices.find(node);
+    return it == indices.end() ? -1 : it->second;
+}
+
+int CompactGraph::IndexOf(const std::string& name) const {
+    const IGraphNode* node = graph->GetNode(name);
+    return node ? IndexOf(node) : -1;
+}
+
+int CompactGraph::EdgeSource(int edge) const {
+    return std::upper_bound(offsets.begin(), offsets.end(), edge) - offsets.begin() - 1;
+}
+
+int CompactGraph::FindEdge(int node, int target) const {
+    for (int e = offsets[node]; e < offsets[node + 1]; e++) {
+        if (targets[e] == target) {
+            return e;
+        }
+    }
+    return -1;
+}
+
+float CompactGraph::Distance(int a, int b) const {
+    const float* pa = GetPosition(a);
+    const float* pb = GetPosition(b);
+    float dx = pa[0] - pb[0];
+    float dy = pa[1] - pb[1];
+    float dz = pa[2] - pb[2];
+    return std::sqrt(dx*dx + dy*dy + dz*dz);
+}
+
+float CompactGraph::MaxEdgeWeight() const {
+    float max = 0;
+    for (float w : weights) {
+        max = std::max(max, w);
+    }
+    return max;
+}
+
+float CompactGraph::MeanEdgeWeight() const {
+    if (weights.empty()) {
+        return 0;
+    }
+    double sum = 0;
+    for (float w : weights) {
+        sum += w;
+    }
+    return sum / weights.size();
+}
+
+uint64_t CompactGraph::GetFingerprint() const {
+    Fingerprint fingerprint;
+    fingerprint.Add(positions);
+    fingerprint.Add(offsets);
+    fingerprint.Add(targets);
+    fingerprint.Add(weights);
+    return fingerprint.Value();
+}
+
+
+MemoryReport CompactGraph::GetMemoryReport() const {
+    MemoryReport report;
+    report.Add("nodes", MemoryReport::Of(nodes));
+    report.Add("node lookup", MemoryReport::Of(indices));
+    report.Add("positions", MemoryReport::Of(positions));
+    report.Add("edges", MemoryReport::Of(offsets) + MemoryReport::Of(targets) + MemoryReport::Of(weights));
+    report.Add("reverse edges", MemoryReport::Of(reverseOffsets) + MemoryReport::Of(reverseSources) + MemoryReport::Of(reverseEdges));
+    return report;
+}
+
+}
@@ -1,8 +1,22 @@
 #include "graph.h"
+#include "impl/virtual_graph.h"
+#include "segment_index.h"
+#include "query_metrics.h"
+#include "util/parallel.h"
+#include "util/thread_pool.h"
+#include <atomic>
+#include <chrono>
+#include <exception>
 #include <limits>
+#include <stdexcept>
+#include <unordered_map>
 
 namespace routing {
 
+GraphBase::~GraphBase() {
+    delete segments.load();
+}
+
 BoundingBox GraphBase::GetBoundingBox() const {
     BoundingBox bb;
 
@@ -45,22 +59,234 @@ const IGraphNode* GraphBase::NearestNode(std::vector<float> point, const Distanc
     return closestNode;
 }
 
-const std::vector< std::vector<float> > GraphBase::GetPath(std::vector<float> src, std::vector<float> dest, const RoutingStrategy& pathing) const {
+bool GraphBase::NearestEdgePoint(const std::vector<float>& point, EdgePoint& result) const {
+    std::call_once(segmentsBuilt, [this]() { segments = new SegmentIndex(this); });
+    return segments.load()->Nearest(point, result);
+}
+
+static int findRoot(std::vector<int>& parent, int v) {
+    while (parent[v] != v) {
+        parent[v] = parent[parent[v]];
+        v = parent[v];
+    }
+    return v;
+}
+
+MemoryReport GraphBase::GetMemoryReport() const {
+    MemoryReport report;
+    const std::vector<IGraphNode*>& nodes = GetNodes();
+    std::unordered_map<const IGraphNode*, int> indices;
+    for (int i = 0; i < nodes.size(); i++) {
+        indices[nodes[i]] = i;
+    }
+
+    std::vector<int> parent(nodes.size());
+    for (int i = 0; i < nodes.size(); i++) {
+        parent[i] = i;
+    }
+    long edges = 0;
+    for (int i = 0; i < nodes.size(); i++) {
+        const std::vector<IGraphNode*>& neighbors = nodes[i]->GetNeighbors();
+        report.Add("names", MemoryReport::Of(nodes[i]->GetName()));
+        report.Add("neighbor lists", MemoryReport::Of(neighbors));
+        edges += neighbors.size();
+        for (const IGraphNode* neighbor : neighbors) {
+            auto it = indices.find(neighbor);
+            if (it != indices.end()) {
+                parent[findRoot(parent, i)] = findRoot(parent, it->second);
+            }
+        }
+    }
+    long components = 0;
+    for (int i = 0; i < nodes.size(); i++) {
+        if (findRoot(parent, i) == i) {
+            components++;
+        }
+    }
+
+    report.Add("node list", MemoryReport::Of(nodes));
+    SegmentIndex* index = segments.load();
+    if (index) {
+        report.Merge(index->GetMemoryReport(), "segment index/");
+    }
+    addMemory(report);
+    report.SetCount("nodes", nodes.size());
+    report.SetCount("edges", edges);
+    report.SetCount("components", components);
+    return report;
+}
+
+static bool hasEdge(const IGraph* graph, const IGraphNode* from, const IGraphNode* to) {
+    for (const IGraphNode* neighbor : graph->GetNeighbors(from)) {
+        if (neighbor == to) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Puts a virtual node at point, wired into its edge (and the reverse edge,
+// if the road is two-way) as a start when source is set, as an end otherwise.
+static const IGraphNode* addVirtualNode(VirtualGraph& overlay, const IGraph* graph, const EdgePoint& point, const std::string& name, bool source) {
+    const IGraphNode* node = overlay.AddNode(name, point.position);
+    bool twoWay = hasEdge(graph, point.to, point.from);
+    if (source) {
+        overlay.AddEdge(node, point.to);
+        if (twoWay) {
+            overlay.AddEdge(node, point.from);
+        }
+    }
+    else {
+        overlay.AddEdge(point.from, node);
+        if (twoWay) {
+            overlay.AddEdge(point.to, node);
+        }
+    }
+    return node;
+}
+
+// Runs query(graph, from, to) between src and dest and turns the node names
+// it returns into positions, framed by the start and end points.
+template <class Query>
+static std::vector< std::vector<float> > routeBetween(const GraphBase* graph, const std::vector<float>& src, const std::vector<float>& dest, bool virtualNodes, const Query& query) {
     using namespace std;
-    const IGraphNode* start_node = NearestNode(src, EuclideanDistance());
-    const IGraphNode* end_node = NearestNode(dest, EuclideanDistance());
+    EdgePoint from, to;
+    if (!virtualNodes || !graph->NearestEdgePoint(src, from) || !graph->NearestEdgePoint(dest, to)) {
+        const IGraphNode* start_node = graph->NearestNode(src, EuclideanDistance());
+        const IGraphNode* end_node = graph->NearestNode(dest, EuclideanDistance());
+
+        vector<string> string_path = query(graph, start_node->GetName(), end_node->GetName());
 
-    vector<string> string_path = pathing.GetPath(this, start_node->GetName(), end_node->GetName());
+        vector< vector<float> > position_path;
+        position_path.push_back(start_node->GetPosition());
+        for (int i = 0; i < string_path.size(); i++) {
+            position_path.push_back(graph->GetNode(string_path[i])->GetPosition());
+        }
+        position_path.push_back(end_node->GetPosition());
+        return position_path;
+    }
+
+    VirtualGraph overlay(graph);
+    const IGraphNode* start_node = addVirtualNode(overlay, graph, from, "virtual:source", true);
+    const IGraphNode* end_node = addVirtualNode(overlay, graph, to, "virtual:target", false);
+
+    // both on the same road: drive along it directly when the direction allows
+    float toT = -1;
+    if (to.from == from.from && to.to == from.to) {
+        toT = to.t;
+    }
+    else if (to.from == from.to && to.to == from.from) {
+        toT = 1 - to.t;
+    }
+    if (toT >= 0 && (toT >= from.t || hasEdge(graph, from.to, from.from))) {
+        overlay.AddEdge(start_node, end_node);
+    }
+
+    vector<string> string_path = query(&overlay, start_node->GetName(), end_node->GetName());
 
     vector< vector<float> > position_path;
     position_path.push_back(start_node->GetPosition());
     for (int i = 0; i < string_path.size(); i++) {
-        position_path.push_back(this->GetNode(string_path[i])->GetPosition());
+        position_path.push_back(overlay.GetNode(string_path[i])->GetPosition());
     }
     position_path.push_back(end_node->GetPosition());
+    return position_path;
+}
+
+const std::vector< std::vector<float> > GraphBase::GetPath(std::vector<float> src, std::vector<float> dest, const RoutingStrategy& pathing) const {
+    // the default options run the plain query, but this way it is measured too
+    return GetPath(src, dest, pathing, QueryOptions());
+}
 
-    return position_path; 
+const std::vector< std::vector<float> > GraphBase::GetPath(std::vector<float> src, std::vector<float> dest, const RoutingStrategy& pathing, const QueryOptions& options, QueryResult* result) const {
+    typedef std::chrono::steady_clock Clock;
+    QueryResult query;
+    Clock::time_point start = Clock::now();
+    Clock::time_point searchStart, searchEnd;
+    std::vector< std::vector<float> > position_path = routeBetween(this, src, dest, pathing.SupportsVirtualNodes(),
+        [&](const IGraph* graph, const std::string& from, const std::string& to) {
+            searchStart = Clock::now();
+            query = pathing.GetPath(graph, from, to, options);
+            searchEnd = Clock::now();
+            return query.path;
+        });
+    query.stats.snapSeconds = std::chrono::duration<double>(searchStart - start).count();
+    query.stats.searchSeconds = std::chrono::duration<double>(searchEnd - searchStart).count();
+    query.stats.pathNodes = query.path.size();
+    QueryMetrics::Global().Record(pathing.GetName(), src, dest, query);
+    if (result) {
+        *result = query;
+    }
+    return position_path;
 }
 
+// Batches run on workers kept for the life of the process, so the search
+// workspaces the strategies keep per thread carry over from batch to batch.
+static ThreadPool& batchPool() {
+    static ThreadPool pool;
+    return pool;
 }
 
+std::vector<Route> GraphBase::GetPaths(const std::vector<PathRequest>& requests, int threads) const {
+    std::vector<Route> routes(requests.size());
+    std::vector<std::exception_ptr> errors(requests.size());
+    // queries vary a lot in cost, so workers take the next request as they
+    // finish rather than a fixed share
+    std::atomic<int> next(0);
+    auto work = [&]() {
+        for (int i = next++; i < requests.size(); i = next++) {
+            const PathRequest& request = requests[i];
+            try {
+                if (!request.strategy) {
+                    throw std::invalid_argument("path request without a strategy");
+                }
+                QueryOptions options = request.budgetMs > 0
+                    ? QueryOptions::Within(request.epsilon, std::chrono::milliseconds(request.budgetMs))
+                    : QueryOptions::Bounded(request.epsilon);
+                routes[i].path = GetPath(request.src, request.dest, *request.strategy, options, &routes[i].result);
+            }
+            catch (...) {
+                errors[i] = std::current_exception();
+            }
+        }
+    };
+    // the calling thread takes a share too
+    int workers = std::min<int>(DefaultThreadCount(threads), requests.size());
+    std::vector< std::future<void> > helpers;
+    for (int i = 1; i < workers; i++) {
+        helpers.push_back(batchPool().Submit(work));
+    }
+    work();
+    for (std::future<void>& helper : helpers) {
+        helper.wait();
+    }
+    for (int i = 0; i < errors.size(); i++) {
+        if (errors[i]) {
+            std::rethrow_exception(errors[i]);
+        }
+    }
+    return routes;
+}
+
+QueryResult RoutingStrategy::GetPath(const IGraph* graph, const std::string& from, const std::string& to, const QueryOptions& options) const {
+    QueryResult result;
+    result.path = GetPath(graph, from, to);
+    if (result.path.empty()) {
+        return result;
+    }
+    result.status = QueryResult::COMPLETE;
+    result.length = PathLength(graph, result.path);
+    result.stats.pathLength = result.length;
+    return result;
+}
+
+float RoutingStrategy::PathLength(const IGraph* graph, const std::vector<std::string>& path) {
+    float length = 0;
+    for (int i = 1; i < path.size(); i++) {
+        length += EuclideanDistance().Calculate(graph->GetNode(path[i-1])->GetPosition(),
+            graph->GetNode(path[i])->GetPosition());
+    }
+    return length;
+}
+
+}
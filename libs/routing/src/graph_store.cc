@@ -0,0 +1,195 @@
+#include "graph_store.h"
+#include "segment_index.h"
+#include "routing/astar.h"
+
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+
+namespace routing {
+
+GraphStore::GraphStore() : state(EMPTY), version(0), lastVersion(0), hubLabels(false), pending(0),
+    queuedLoad(false), loaderBusy(false) {}
+
+GraphStore::~GraphStore() {
+    {
+        // a load that has not started yet is dropped
+        std::lock_guard<std::mutex> lock(mutex);
+        if (queuedLoad) {
+            queuedLoad = false;
+            pending--;
+        }
+    }
+    if (loader.joinable()) {
+        loader.join();
+    }
+}
+
+const IGraph* GraphStore::parse(const std::string& file) const {
+    try {
+        return api.LoadFromFile(file);
+    }
+    catch (const std::exception& e) {
+        std::cerr << "Unable to load graph " << file << ": " << e.what() << std::endl;
+        return NULL;
+    }
+}
+
+std::shared_ptr<GraphSnapshot> GraphStore::prepare(const IGraph* graph, const std::string& file) {
+    std::shared_ptr<GraphSnapshot> snapshot = std::make_shared<GraphSnapshot>(graph, file, NextVersion());
+    // build the edge index now rather than on the first route
+    EdgePoint point;
+    graph->NearestEdgePoint(std::vector<float>(3, 0.0f), point);
+    snapshot->SetPoiTable(poiTableFor(graph, file));
+    if (!hubLabels) {
+        return snapshot;
+    }
+
+    std::shared_ptr<const CompactGraph> compact = std::make_shared<const CompactGraph>(graph);
+    snapshot->SetCompactGraph(compact);
+
+    std::ifstream in(file + ".hlab", std::ios::binary);
+    HubLabels* labels = in ? HubLabels::Load(in, *compact) : NULL;
+    if (!labels) {
+        labels = new HubLabels(*compact);
+    }
+    snapshot->SetHubLabels(std::shared_ptr<const HubLabels>(labels));
+    return snapshot;
+}
+
+void GraphStore::SetPoiFile(const std::string& poiFile) {
+    std::lock_guard<std::mutex> lock(mutex);
+    this->poiFile = poiFile;
+}
+
+std::shared_ptr<const PoiTable> GraphStore::poiTableFor(const IGraph* graph, const std::string& file) const {
+    std::string poiFile;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        poiFile = this->poiFile;
+    }
+    if (poiFile.empty()) {
+        return std::shared_ptr<const PoiTable>();
+    }
+
+    // a bad POI list costs the table, not the map
+    try {
+        std::vector<PoiTable::Poi> pois = PoiTable::ReadPois(poiFile);
+        std::ifstream in(file + ".ptab", std::ios::binary);
+        PoiTable* table = in ? PoiTable::Load(in, graph, pois) : NULL;
+        in.close();
+        if (!table) {
+            table = new PoiTable(graph, pois, AStar::Default());
+            std::ofstream out(file + ".ptab", std::ios::binary);
+            table->Save(out);
+            if (!out) {
+                std::cerr << "Unable to save POI table " << file << ".ptab" << std::endl;
+            }
+        }
+        return std::shared_ptr<const PoiTable>(table);
+    }
+    catch (const std::exception& e) {
+        std::cerr << "Unable to build POI table from " << poiFile << ": " << e.what() << std::endl;
+        return std::shared_ptr<const PoiTable>();
+    }
+}
+
+bool GraphStore::Load(const std::string& file) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        pending++;
+        if (!Get()) {
+            state = LOADING;
+        }
+    }
+
+    const IGraph* graph = parse(file);
+    if (graph) {
+        Swap(prepare(graph, file));
+    }
+    finishLoad(graph != NULL);
+    return graph != NULL;
+}
+
+void GraphStore::LoadAsync(const std::string& file) {
+    std::thread finished;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!Get()) {
+            state = LOADING;
+        }
+        queued = file;
+        if (queuedLoad) {
+            // replaces a request the loader has not started yet
+            return;
+        }
+        queuedLoad = true;
+        pending++;
+        if (loaderBusy) {
+            // picked up once the load in flight is done
+            return;
+        }
+        loaderBusy = true;
+        // the previous loader has left loadQueued, so joining it is quick
+        finished = std::move(loader);
+        loader = std::thread([this]() { loadQueued(); });
+    }
+    if (finished.joinable()) {
+        finished.join();
+    }
+}
+
+void GraphStore::loadQueued() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (queuedLoad) {
+        std::string file = queued;
+        queuedLoad = false;
+        lock.unlock();
+        const IGraph* graph = parse(file);
+        if (graph) {
+            Swap(prepare(graph, file));
+        }
+        finishLoad(graph != NULL);
+        lock.lock();
+    }
+    loaderBusy = false;
+}
+
+void GraphStore::finishLoad(bool ok) {
+    std::lock_guard<std::mutex> lock(mutex);
+    pending--;
+    if (!ok) {
+        if (!Get()) {
+            state = FAILED;
+        }
+        else {
+            std::cerr << "Keeping graph version " << version.load() << std::endl;
+        }
+    }
+    loaded.notify_all();
+}
+
+void GraphStore::Swap(const IGraph* graph, const std::string& source) {
+    Swap(std::make_shared<const GraphSnapshot>(graph, source, NextVersion()));
+}
+
+void GraphStore::Swap(std::shared_ptr<const GraphSnapshot> snapshot) {
+    if (!snapshot) {
+        throw std::invalid_argument("cannot publish an empty graph snapshot");
+    }
+    int published = snapshot->GetVersion();
+    std::atomic_store(&current, std::move(snapshot));
+    version = published;
+    state = READY;
+}
+
+std::shared_ptr<const GraphSnapshot> GraphStore::Get() const {
+    return std::atomic_load(&current);
+}
+
+void GraphStore::Wait() const {
+    std::unique_lock<std::mutex> lock(mutex);
+    loaded.wait(lock, [this]() { return pending == 0; });
+}
+
+}
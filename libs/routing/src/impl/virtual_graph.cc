@@ -0,0 +1,66 @@
+#include "impl/virtual_graph.h"
+
+#include <stdexcept>
+
+namespace routing {
+
+VirtualGraph::~VirtualGraph() {
+    for (auto& entry : virtualNodes) {
+        delete entry.second;
+    }
+}
+
+const IGraphNode* VirtualGraph::AddNode(const std::string& name, const std::vector<float>& position) {
+    if (virtualNodes.count(name) || base->GetNode(name)) {
+        throw std::invalid_argument("node already in graph: " + name);
+    }
+    SimpleGraphNode* node = new SimpleGraphNode(name, position);
+    virtualNodes[name] = node;
+    return node;
+}
+
+void VirtualGraph::AddEdge(const IGraphNode* from, const IGraphNode* to) {
+    IGraphNode* target = const_cast<IGraphNode*>(to);
+    auto it = virtualNodes.find(from->GetName());
+    if (it != virtualNodes.end() && it->second == from) {
+        it->second->AddNeighbor(target);
+        return;
+    }
+
+    auto extra = extraNeighbors.find(from);
+    if (extra == extraNeighbors.end()) {
+        extra = extraNeighbors.emplace(from, from->GetNeighbors()).first;
+    }
+    extra->second.push_back(target);
+}
+
+const IGraphNode* VirtualGraph::GetNode(const std::string& name) const {
+    auto it = virtualNodes.find(name);
+    if (it != virtualNodes.end()) {
+        return it->second;
+    }
+    return base->GetNode(name);
+}
+
+const std::vector<IGraphNode*>& VirtualGraph::GetNeighbors(const IGraphNode* node) const {
+    auto extra = extraNeighbors.find(node);
+    if (extra != extraNeighbors.end()) {
+        return extra->second;
+    }
+    return base->GetNeighbors(node);
+}
+
+
+MemoryReport VirtualGraph::GetMemoryReport() const {
+    MemoryReport report;
+    report.Add("virtual nodes", MemoryReport::Of(virtualNodes) + virtualNodes.size()*MemoryReport::Block(sizeof(SimpleGraphNode)));
+    size_t extra = MemoryReport::Of(extraNeighbors);
+    for (const auto& entry : extraNeighbors) {
+        extra += MemoryReport::Of(entry.second);
+    }
+    report.Add("extra edges", extra);
+    report.SetCount("virtual nodes", virtualNodes.size());
+    return report;
+}
+
+}
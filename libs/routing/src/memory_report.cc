@@ -0,0 +1,62 @@
+#include "memory_report.h"
+
+#include <algorithm>
+#include <iomanip>
+
+namespace routing {
+
+void MemoryReport::Merge(const MemoryReport& other, const std::string& prefix) {
+    for (const auto& entry : other.categories) {
+        categories[prefix + entry.first] += entry.second;
+    }
+    for (const auto& entry : other.counts) {
+        counts[prefix + entry.first] = entry.second;
+    }
+}
+
+size_t MemoryReport::Total() const {
+    size_t total = 0;
+    for (const auto& entry : categories) {
+        total += entry.second;
+    }
+    return total;
+}
+
+size_t MemoryReport::Block(size_t bytes) {
+    // 8 bytes of chunk header, 16-byte alignment, 32-byte minimum chunk
+    return std::max<size_t>(32, (bytes + 8 + 15) & ~(size_t)15);
+}
+
+size_t MemoryReport::Of(const std::string& value) {
+    // short strings live inside the object
+    static const size_t local = std::string().capacity();
+    return value.capacity() > local ? Block(value.capacity() + 1) : 0;
+}
+
+void MemoryReport::Print(std::ostream& out) const {
+    std::vector< std::pair<size_t, std::string> > sorted;
+    for (const auto& entry : categories) {
+        sorted.push_back(std::make_pair(entry.second, entry.first));
+    }
+    std::sort(sorted.rbegin(), sorted.rend());
+
+    size_t total = Total();
+    std::ios::fmtflags flags = out.flags();
+    std::streamsize precision = out.precision(1);
+    out << std::fixed;
+    for (const auto& entry : sorted) {
+        out << "  " << std::left << std::setw(32) << entry.second << std::right
+            << std::setw(14) << entry.first << " bytes"
+            << std::setw(8) << (total ? 100.0*entry.first/total : 0) << "%" << std::endl;
+    }
+    out << "  " << std::left << std::setw(32) << "total" << std::right
+        << std::setw(14) << total << " bytes" << std::endl;
+    for (const auto& entry : counts) {
+        out << "  " << std::left << std::setw(32) << entry.first << std::right
+            << std::setw(14) << entry.second << std::endl;
+    }
+    out.precision(precision);
+    out.flags(flags);
+}
+
+}
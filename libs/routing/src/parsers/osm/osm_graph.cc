@@ -1,10 +1,11 @@
+#include <algorithm>
+#include <charconv>
 #include <stdexcept>
 #include <limits>
 #include "parsers/osm/osm_graph.h"
 
 using std::string;
 using std::vector;
-using std::unordered_map;
 using std::invalid_argument;
 using std::out_of_range;
 using std::numeric_limits;
@@ -12,7 +13,7 @@ using std::numeric_limits;
 
 namespace routing {
 
-OSMNode::OSMNode(Point3 loc, string name) : loc_(loc), name_(name) { };
+OSMNode::OSMNode(Point3 loc, uint64_t id) : id_(id), loc_(loc) { };
 
 /*const vector< vector<float> > OSMGraph::GetPath(vector<float> src, vector<float> dest) const {
   const IGraphNode* start_node = entity_project::NearestNode(this, src);
@@ -27,42 +28,64 @@ OSMNode::OSMNode(Point3 loc, string name) : loc_(loc), name_(name) { };
   return position_path; 
 }*/
 
+static bool lessId(const std::pair<uint64_t, OSMNode*>& entry, uint64_t id) {
+    return entry.first < id;
+}
+
 OSMGraph::~OSMGraph() {
-    for (auto kv: lookup_) {
-        delete kv.second; // delete the associated node
+    for (auto* node: nodes_) {
+        delete node; // delete the associated node
     }
 };
 
 void OSMGraph::AddNode(OSMNode* node) {
-    const string name = node->GetName();
-    if(lookup_.find(name) != lookup_.end()) {
-        // attempting to add duplicate Node
-        throw invalid_argument(name);
+    const uint64_t id = node->GetId();
+    auto it = ids_.end();
+    if (!ids_.empty() && ids_.back().first >= id) {
+        it = std::lower_bound(ids_.begin(), ids_.end(), id, lessId);
+        if (it->first == id) {
+            // attempting to add duplicate Node
+            throw invalid_argument(node->GetName());
+        }
     }
-    lookup_.insert({name, node});
+    ids_.insert(it, {id, node});
     nodes_.push_back(node);
 };
 
-void OSMGraph::AddEdge(const string name1, const string name2) {
-    OSMNode* node1 = node_named(name1);
-    OSMNode* node2 = node_named(name2);
+void OSMGraph::AddEdge(uint64_t id1, uint64_t id2) {
+    OSMNode* node1 = node_with_id(id1);
+    OSMNode* node2 = node_with_id(id2);
+    if (!node1 || !node2) {
+        throw invalid_argument(std::to_string(node1 ? id2 : id1));
+    }
     node1->AddNeighbour(node2);
 };
 
-OSMNode* OSMGraph::node_named(const string name) const {
-    auto result = lookup_.find(name);
-    if (result == lookup_.end()) {
-        throw invalid_argument(name);
-    }
-    return result->second;
+OSMNode* OSMGraph::node_with_id(uint64_t id) const {
+    auto it = std::lower_bound(ids_.begin(), ids_.end(), id, lessId);
+    return it != ids_.end() && it->first == id ? it->second : NULL;
+};
+
+const OSMNode* OSMGraph::NodeWithId(uint64_t id) const {
+    return node_with_id(id);
 };
 
-const OSMNode* OSMGraph::NodeNamed(const string name) const {
-    return node_named(name);
+const IGraphNode* OSMGraph::GetNode(const std::string& name) const {
+    uint64_t id;
+    if (!ParseId(name.data(), name.data() + name.size(), id)) {
+        return NULL;
+    }
+    return node_with_id(id);
 };
 
-bool OSMGraph::Contains(const string name) const {
-    return !(lookup_.find(name) == lookup_.end());
+bool OSMGraph::ParseId(const char* begin, const char* end, uint64_t& id) {
+    std::from_chars_result parsed = std::from_chars(begin, end, id);
+    return begin != end && parsed.ec == std::errc() && parsed.ptr == end;
 };
 
-};
\ No newline at end of file
+void OSMGraph::addMemory(MemoryReport& report) const {
+    report.Add("node objects", nodes_.size()*MemoryReport::Block(sizeof(OSMNode)));
+    report.Add("node lookup", MemoryReport::Of(ids_));
+}
+
+};
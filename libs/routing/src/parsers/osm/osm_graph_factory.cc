@@ -13,4 +13,12 @@ IGraph* OSMGraphFactory::Create(const std::string& file) const {
 	return OsmParser::LoadGraphFromFile(file, false);
 }
 
-}
\ No newline at end of file
+IGraph* OSMGraphFactory::Parse(const std::string& file) {
+	return OsmParser::ParseGraphFromFile(file, false);
+}
+
+IGraph* OSMGraphFactory::LargestComponent(const IGraph* graph) {
+	return OsmParser::LargestComponent(graph);
+}
+
+}
@@ -0,0 +1,379 @@
+#include "parsers/osm/osm_importer.h"
+#include "parsers/osm/osm_parser.h"
+#include "snapshot_file.h"
+#include "util/external_sort.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace routing {
+
+// ---- streaming tag reader ----
+
+// One markup tag: "node", "/way", ... with its attributes.
+struct OsmTag {
+    std::string name;
+    bool selfClosing;
+    std::vector< std::pair<std::string, std::string> > attributes;
+
+    const char* Get(const char* key) const {
+        for (const auto& attribute : attributes) {
+            if (attribute.first == key) {
+                return attribute.second.c_str();
+            }
+        }
+        return NULL;
+    }
+};
+
+static bool isSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+// Reads the next tag from the stream, skipping text, comments and
+// declarations.  OSM files escape '>' inside attribute values, so reading up
+// to the next '>' always yields a whole tag.
+static bool nextTag(std::istream& in, std::string& text, OsmTag& tag) {
+    while (std::getline(in, text, '>')) {
+        size_t i = text.rfind('<');
+        if (i == std::string::npos || i + 1 >= text.size() || text[i+1] == '!' || text[i+1] == '?') {
+            continue;
+        }
+        size_t end = text.size();
+        tag.selfClosing = text[end-1] == '/';
+        if (tag.selfClosing) {
+            end--;
+        }
+
+        size_t start = ++i;
+        while (i < end && !isSpace(text[i])) {
+            i++;
+        }
+        tag.name.assign(text, start, i - start);
+        tag.attributes.clear();
+
+        while (i < end) {
+            while (i < end && isSpace(text[i])) {
+                i++;
+            }
+            size_t key = i;
+            while (i < end && text[i] != '=' && !isSpace(text[i])) {
+                i++;
+            }
+            size_t keyEnd = i;
+            while (i < end && (text[i] == '=' || isSpace(text[i]))) {
+                i++;
+            }
+            if (i >= end || (text[i] != '"' && text[i] != '\'')) {
+                break;
+            }
+            char quote = text[i++];
+            size_t value = i;
+            while (i < end && text[i] != quote) {
+                i++;
+            }
+            tag.attributes.push_back(std::make_pair(text.substr(key, keyEnd - key), text.substr(value, i - value)));
+            i++;
+        }
+        return true;
+    }
+    return false;
+}
+
+// ---- records ----
+
+struct NodeRecord {
+    int64_t id;
+    float lat;
+    float lon;
+};
+
+struct SegmentRecord {
+    int64_t from;
+    int64_t to;
+};
+
+struct TargetRecord {
+    int64_t to;
+    int32_t from;
+};
+
+struct EdgeRecord {
+    int32_t from;
+    int32_t to;
+};
+
+struct ById {
+    bool operator()(const NodeRecord& a, const NodeRecord& b) const { return a.id < b.id; }
+};
+
+struct BySource {
+    bool operator()(const SegmentRecord& a, const SegmentRecord& b) const { return a.from < b.from; }
+};
+
+struct ByTarget {
+    bool operator()(const TargetRecord& a, const TargetRecord& b) const { return a.to < b.to; }
+};
+
+struct ByEdge {
+    bool operator()(const EdgeRecord& a, const EdgeRecord& b) const {
+        return a.from < b.from || (a.from == b.from && a.to < b.to);
+    }
+};
+
+static FILE* openFile(const std::string& file, const char* mode) {
+    FILE* handle = fopen(file.c_str(), mode);
+    if (!handle) {
+        throw std::runtime_error("unable to open " + file);
+    }
+    return handle;
+}
+
+static int findRoot(std::vector<int32_t>& parent, int32_t v) {
+    while (parent[v] != v) {
+        parent[v] = parent[parent[v]];
+        v = parent[v];
+    }
+    return v;
+}
+
+// ---- import ----
+
+OsmImporter::Stats OsmImporter::Import(const std::string& osmFile, const std::string& snapshotFile, const Options& options) {
+    std::ifstream in(osmFile.c_str(), std::ios::binary);
+    if (!in) {
+        throw std::runtime_error("unable to open " + osmFile);
+    }
+
+    std::string prefix = snapshotFile;
+    if (!options.tempDirectory.empty()) {
+        size_t slash = snapshotFile.find_last_of('/');
+        prefix = options.tempDirectory + "/" + (slash == std::string::npos ? snapshotFile : snapshotFile.substr(slash + 1));
+    }
+    prefix += ".tmp";
+    size_t budget = std::max(options.memoryBudget, 1L << 20);
+
+    Stats stats = {0, 0, 0, 0, 0};
+
+    // pass 1: stream the file, spilling nodes by id and way segments by
+    // source id; ways list their nds before their tags, so a way's refs are
+    // held until its closing tag says whether it is a highway
+    ExternalSorter<NodeRecord, ById> nodes(prefix + ".nodes", budget/2);
+    ExternalSorter<SegmentRecord, BySource> segments(prefix + ".segments", budget/2);
+
+    bool haveBounds = false;
+    float minlat = std::numeric_limits<float>::infinity(), maxlat = -minlat;
+    float minlon = minlat, maxlon = -minlat;
+    std::vector<int64_t> refs;
+    bool inWay = false;
+    bool highway = false;
+
+    std::string text;
+    OsmTag tag;
+    while (nextTag(in, text, tag)) {
+        if (tag.name == "bounds") {
+            const char* values[4] = {tag.Get("minlat"), tag.Get("minlon"), tag.Get("maxlat"), tag.Get("maxlon")};
+            if (values[0] && values[1] && values[2] && values[3]) {
+                minlat = strtod(values[0], NULL);
+                minlon = strtod(values[1], NULL);
+                maxlat = strtod(values[2], NULL);
+                maxlon = strtod(values[3], NULL);
+                haveBounds = true;
+            }
+        }
+        else if (tag.name == "node") {
+            const char* id = tag.Get("id");
+            const char* lat = tag.Get("lat");
+            const char* lon = tag.Get("lon");
+            if (!id || !lat || !lon) {
+                std::cerr << "Improperly formed node. Continuing." << std::endl;
+                continue;
+            }
+            NodeRecord node = {strtoll(id, NULL, 10), (float)strtod(lat, NULL), (float)strtod(lon, NULL)};
+            nodes.Add(node);
+            stats.nodesRead++;
+            if (!haveBounds) {
+                minlat = std::min(minlat, node.lat);
+                maxlat = std::max(maxlat, node.lat);
+                minlon = std::min(minlon, node.lon);
+                maxlon = std::max(maxlon, node.lon);
+            }
+        }
+        else if (tag.name == "way") {
+            inWay = !tag.selfClosing;
+            highway = false;
+            refs.clear();
+        }
+        else if (inWay && tag.name == "nd") {
+            const char* ref = tag.Get("ref");
+            if (ref) {
+                refs.push_back(strtoll(ref, NULL, 10));
+            }
+        }
+        else if (inWay && tag.name == "tag") {
+            const char* key = tag.Get("k");
+            highway = highway || (key && std::string(key) == "highway");
+        }
+        else if (tag.name == "/way") {
+            for (int i = 1; highway && i < refs.size(); i++) {
+                if (refs[i-1] != refs[i]) {
+                    segments.Add({refs[i-1], refs[i]});
+                    segments.Add({refs[i], refs[i-1]});
+                    stats.waySegments++;
+                }
+            }
+            inWay = false;
+        }
+    }
+    in.close();
+    nodes.Flush();
+    segments.Flush();
+
+    // join 1: give every node that starts a segment a dense index (in id
+    // order) and re-key its segments by target id
+    std::string usedFile = prefix + ".used";
+    ExternalSorter<TargetRecord, ByTarget> targets(prefix + ".targets", budget/3);
+    int32_t numUsed = 0;
+    {
+        std::unique_ptr<ExternalSorter<NodeRecord, ById>::Reader> nodeReader = nodes.Sorted(budget/3);
+        std::unique_ptr<ExternalSorter<SegmentRecord, BySource>::Reader> segmentReader = segments.Sorted(budget/3);
+        FILE* used = openFile(usedFile, "wb");
+
+        NodeRecord node;
+        SegmentRecord segment;
+        bool haveNode = nodeReader->Next(node);
+        bool haveSegment = segmentReader->Next(segment);
+        while (haveSegment) {
+            int64_t id = segment.from;
+            while (haveNode && node.id < id) {
+                haveNode = nodeReader->Next(node);
+            }
+            bool found = haveNode && node.id == id;
+            if (found) {
+                fwrite(&node, sizeof(node), 1, used);
+            }
+            while (haveSegment && segment.from == id) {
+                if (found) {
+                    targets.Add({segment.to, numUsed});
+                }
+                haveSegment = segmentReader->Next(segment);
+            }
+            if (found) {
+                numUsed++;
+            }
+        }
+        fclose(used);
+    }
+    targets.Flush();
+
+    // join 2: resolve target ids against the indexed nodes
+    ExternalSorter<EdgeRecord, ByEdge> edges(prefix + ".edges", budget/2);
+    {
+        std::unique_ptr<ExternalSorter<TargetRecord, ByTarget>::Reader> targetReader = targets.Sorted(budget/2);
+        FILE* used = openFile(usedFile, "rb");
+        NodeRecord node;
+        int32_t index = -1;
+        bool haveNode = fread(&node, sizeof(node), 1, used) == 1;
+        if (haveNode) {
+            index = 0;
+        }
+        TargetRecord target;
+        while (targetReader->Next(target)) {
+            while (haveNode && node.id < target.to) {
+                haveNode = fread(&node, sizeof(node), 1, used) == 1;
+                index++;
+            }
+            if (haveNode && node.id == target.to) {
+                edges.Add({target.from, index});
+            }
+        }
+        fclose(used);
+    }
+    edges.Flush();
+
+    // keep the largest connected component, writing the deduplicated edges
+    // to a plain file for the final pass
+    std::string edgeFile = prefix + ".final";
+    std::vector<int32_t> parent(numUsed);
+    for (int32_t i = 0; i < numUsed; i++) {
+        parent[i] = i;
+    }
+    {
+        std::unique_ptr<ExternalSorter<EdgeRecord, ByEdge>::Reader> edgeReader = edges.Sorted(budget/2);
+        FILE* out = openFile(edgeFile, "wb");
+        EdgeRecord edge;
+        EdgeRecord last = {-1, -1};
+        while (edgeReader->Next(edge)) {
+            if (edge.from == last.from && edge.to == last.to) {
+                continue;
+            }
+            last = edge;
+            fwrite(&edge, sizeof(edge), 1, out);
+            int a = findRoot(parent, edge.from);
+            int b = findRoot(parent, edge.to);
+            if (a != b) {
+                parent[a] = b;
+            }
+        }
+        fclose(out);
+    }
+    stats.runFiles = nodes.NumRuns() + segments.NumRuns() + targets.NumRuns() + edges.NumRuns();
+
+    std::vector<int32_t> newIndex(numUsed, 0);
+    for (int32_t i = 0; i < numUsed; i++) {
+        newIndex[findRoot(parent, i)]++;
+    }
+    int32_t largest = -1;
+    for (int32_t i = 0; i < numUsed; i++) {
+        if (largest < 0 || newIndex[i] > newIndex[largest]) {
+            largest = i;
+        }
+    }
+    int32_t next = 0;
+    for (int32_t i = 0; i < numUsed; i++) {
+        newIndex[i] = findRoot(parent, i) == largest ? next++ : -1;
+    }
+    std::vector<int32_t>().swap(parent);
+
+    // write the snapshot: nodes in id order, then edges sorted by source
+    float centerLat = minlat + (maxlat-minlat)/2.0;
+    float centerLon = minlon + (maxlon-minlon)/2.0;
+    SnapshotWriter writer(snapshotFile);
+    {
+        FILE* used = openFile(usedFile, "rb");
+        NodeRecord node;
+        for (int32_t i = 0; fread(&node, sizeof(node), 1, used) == 1; i++) {
+            if (newIndex[i] >= 0) {
+                Point3 position = OsmParser::Project(node.lat, node.lon, centerLat, centerLon);
+                writer.AddNode(std::to_string(node.id), position[0], position[1], position[2]);
+                stats.nodes++;
+            }
+        }
+        fclose(used);
+    }
+    {
+        FILE* in = openFile(edgeFile, "rb");
+        EdgeRecord edge;
+        while (fread(&edge, sizeof(edge), 1, in) == 1) {
+            if (newIndex[edge.from] >= 0 && newIndex[edge.to] >= 0) {
+                writer.AddEdge(newIndex[edge.from], newIndex[edge.to]);
+                stats.edges++;
+            }
+        }
+        fclose(in);
+    }
+    writer.Finish();
+
+    std::remove(usedFile.c_str());
+    std::remove(edgeFile.c_str());
+    return stats;
+}
+
+}
@@ -1,3 +1,5 @@
+#include <algorithm>
+#include <cstring>
 #include <iostream>
 #include <set>
 #include <string>
@@ -16,149 +18,108 @@ using std::string;
 
 namespace routing {
 
-template <class T, class V>
-unordered_map<V, int>* count_value_occurrences(const unordered_map<T, V>* to_count) {
-    unordered_map<V, int>* result = new unordered_map<V, int>();
-
-    for (auto kv : *to_count) {
-        auto existing_info = result->find(kv.second);
-        if (existing_info == result->end()) {
-            result->insert({kv.second, 1});
-        } else {
-            existing_info->second += 1;
-        }
-    }
-
-    return result;
-};
-
-template <class T>
-T argmax(const unordered_map<T, int>* mapping) {
-    // this iterates through the list twice
-    // because T max_found; isn't always valid
-    // if T doesn't define a default constructor
-    int max = INT_MIN;
-
-    for (auto kv: *mapping) {
-        if(kv.second > max) {
-            max = kv.second;
-        }
-    }
-
-    for (auto kv: *mapping) {
-        if(kv.second == max) {
-            return kv.first;
-        }
-    }
-};
-
-template <class T, class V>
-unordered_map<T, bool>* where_equal(const unordered_map<T, int>* mapping, V equal_to){
-    unordered_map<T, bool>* result = new unordered_map<T, bool>();
-
-    for (auto kv: *mapping) {
-        result->insert({
-            kv.first,
-            kv.second == equal_to});
-    }
-
-    return result;
-}
-
 class GraphUtils {
     public :  
-        static unordered_map<string, int>* ConnectedComponents(const IGraph* graph);
-        static OSMGraph* Filter(const IGraph* original, const unordered_map<string, bool>* filter);
+        // Component of every node, by its index in graph->GetNodes().
+        static vector<int> ConnectedComponents(const IGraph* graph, int* count);
         static OSMGraph* FilterToLargestConnectedComponent(const IGraph* graph);
     private:
-        static void dfs_visit(const IGraphNode* n, unordered_map<string, int>* record, int index);
+        static uint64_t id_of(const IGraphNode* node);
 };
 
-unordered_map<string, int>* GraphUtils::ConnectedComponents(const IGraph* graph) {
-    unordered_map<string, int>* visited = new unordered_map<string, int>();
-    int index = 0;
+vector<int> GraphUtils::ConnectedComponents(const IGraph* graph, int* count) {
+    const vector<IGraphNode*>& nodes = graph->GetNodes();
+    unordered_map<const IGraphNode*, int> index;
+    for (int i = 0; i < nodes.size(); i++) {
+        index[nodes[i]] = i;
+    }
 
-    for (auto* node : graph->GetNodes()) {
-        if(visited->find(node->GetName()) == visited->end()) {
-            // we haven't seen this node before
-            GraphUtils::dfs_visit(node, visited, index);
-            index += 1;
+    // iterative, city maps have paths long enough to overflow the stack
+    vector<int> component(nodes.size(), -1);
+    vector<int> stack;
+    *count = 0;
+    for (int i = 0; i < nodes.size(); i++) {
+        if (component[i] >= 0) {
+            continue;
+        }
+        component[i] = *count;
+        stack.push_back(i);
+        while (!stack.empty()) {
+            const IGraphNode* node = nodes[stack.back()];
+            stack.pop_back();
+            for (const IGraphNode* neighbour : node->GetNeighbors()) {
+                auto it = index.find(neighbour);
+                if (it != index.end() && component[it->second] < 0) {
+                    component[it->second] = *count;
+                    stack.push_back(it->second);
+                }
+            }
         }
+        *count += 1;
     }
-
-    return visited;
+    return component;
 }
 
-OSMGraph* GraphUtils::Filter(const IGraph* original, const unordered_map<string, bool>* filter) {
+OSMGraph* GraphUtils::FilterToLargestConnectedComponent(const IGraph* original) {
     // NOTE: does not preserve the type of the graph that was input, always gives back an OSMGraph
-    OSMGraph* filtered_graph = new OSMGraph();
+    int count = 0;
+    vector<int> component = GraphUtils::ConnectedComponents(original, &count);
+    vector<int> sizes(count, 0);
+    for (int c : component) {
+        sizes[c]++;
+    }
+    int largest = std::max_element(sizes.begin(), sizes.end()) - sizes.begin();
 
-    // copy over all of the nodes for which filter(node->GetName()) is true
-    for (auto kv : *filter) {
-        const bool include = kv.second;
-        if (include) {
-            const string name = kv.first;
-            const IGraphNode* existing_node = original->GetNode(name);
-            if(existing_node) {
-                vector<float> loc = existing_node->GetPosition();
-                filtered_graph->AddNode(
-                    new OSMNode(
-                        Point3(loc.at(0), loc.at(1), loc.at(2)),
-                        existing_node->GetName()));
-            } else {
-                throw logic_error(name);
-            }
+    const vector<IGraphNode*>& nodes = original->GetNodes();
+    OSMGraph* filtered_graph = new OSMGraph();
+    unordered_map<const IGraphNode*, OSMNode*> copies;
+    for (int i = 0; i < nodes.size(); i++) {
+        if (component[i] == largest) {
+            vector<float> loc = nodes[i]->GetPosition();
+            OSMNode* copy = new OSMNode(Point3(loc.at(0), loc.at(1), loc.at(2)), id_of(nodes[i]));
+            filtered_graph->AddNode(copy);
+            copies[nodes[i]] = copy;
         }
     }
 
-    for (IGraphNode* node : original->GetNodes()) {
-        auto from_filter = filter->find(node->GetName());
-        if (from_filter == filter->end()) {
-            throw invalid_argument(node->GetName());
-        } // implicit else
-        if (from_filter->second) {
-            // from node is in the filter            
-            for (IGraphNode* other : node->GetNeighbors()) {
-                auto to_filter = filter->find(other->GetName());
-                if (to_filter == filter->end()) {
-                    throw invalid_argument(node->GetName());
-                } // implicit else
-                if (to_filter->second) {
-                    // both nodes in the filter
-                    filtered_graph->AddEdge(node->GetName(), other->GetName());
-                }
+    for (int i = 0; i < nodes.size(); i++) {
+        if (component[i] == largest) {
+            OSMNode* from = copies[nodes[i]];
+            for (const IGraphNode* other : nodes[i]->GetNeighbors()) {
+                // neighbours of a node are in its component
+                from->AddNeighbour(copies.at(other));
             }
         }
     }
 
     return filtered_graph;
-};
-
-OSMGraph* GraphUtils::FilterToLargestConnectedComponent(const IGraph* original) {
-    unordered_map<string, int>* cc_mapping = GraphUtils::ConnectedComponents(original);
-    unordered_map<int, int>* cc_sizes = count_value_occurrences(cc_mapping);
-    int largest_subgraph_idx = argmax(cc_sizes);
-    unordered_map<string, bool>* in_largest_cc = where_equal(cc_mapping, largest_subgraph_idx);
-    OSMGraph* result = GraphUtils::Filter(original, in_largest_cc);
-
-    delete cc_mapping;
-    delete cc_sizes;
-    delete in_largest_cc;
-    
-    return result;
 }
 
-void GraphUtils::dfs_visit(const IGraphNode* n, unordered_map<string, int>* record, int index) {
-    if (record->find(n->GetName()) == record->end()) {
-        record->insert({n->GetName(), index});
-
-        for (auto* neighbour : (n->GetNeighbors())) {
-            GraphUtils::dfs_visit(neighbour, record, index);
-        }
+uint64_t GraphUtils::id_of(const IGraphNode* node) {
+    const OSMNode* osm = dynamic_cast<const OSMNode*>(node);
+    if (osm) {
+        return osm->GetId();
+    }
+    const string name = node->GetName();
+    uint64_t id;
+    if (!OSMGraph::ParseId(name.data(), name.data() + name.size(), id)) {
+        throw invalid_argument("node name is not an OSM id: " + name);
     }
+    return id;
 }
 
 OSMGraph* OsmParser::LoadGraphFromFile(string filename, bool debug) {
+  OSMGraph* geazy = ParseGraphFromFile(filename, debug);
+  OSMGraph* connected = LargestComponent(geazy);
+  delete geazy;
+  return connected;
+}
+
+OSMGraph* OsmParser::LargestComponent(const IGraph* graph) {
+  return GraphUtils::FilterToLargestConnectedComponent(graph);
+}
+
+OSMGraph* OsmParser::ParseGraphFromFile(string filename, bool debug) {
   pugi::xml_document doc;
   pugi::xml_parse_result result = doc.load_file(filename.c_str());
   // sanity check, make sure the document loaded, and print something (anything) from the document
@@ -169,9 +130,7 @@ OSMGraph* OsmParser::LoadGraphFromFile(string filename, bool debug) {
   OSMGraph* geazy = read_nodes(&doc, debug);
 
   read_adjacencies_to(geazy, &doc, debug);
-  OSMGraph* connected = GraphUtils::FilterToLargestConnectedComponent(geazy);
-  delete geazy;
-  return connected;
+  return geazy;
 };
 
 OSMGraph* OsmParser::without_lonely_nodes(OSMGraph* geazy) {
@@ -183,16 +142,15 @@ OSMGraph* OsmParser::without_lonely_nodes(OSMGraph* geazy) {
 
   for (IGraphNode* node : geazy->GetNodes()) {
     if(node->GetNeighbors().size() > 0) {
-      OSMNode* newNode = new OSMNode(node->GetPosition(), node->GetName());
+      OSMNode* newNode = new OSMNode(node->GetPosition(), static_cast<OSMNode*>(node)->GetId());
       newGraph->AddNode(newNode);
     }
   }
 
   for (IGraphNode* node : geazy->GetNodes()) {
-    const string name = node->GetName();
+    const uint64_t id = static_cast<OSMNode*>(node)->GetId();
     for(IGraphNode* other : node->GetNeighbors()) {
-      const string other_name = other->GetName();
-      newGraph->AddEdge(name, other_name);
+      newGraph->AddEdge(id, static_cast<OSMNode*>(other)->GetId());
     }
   }
 
@@ -214,9 +172,7 @@ OSMGraph* OsmParser::read_nodes(pugi::xml_document* doc, bool debug) {
     float centerLon = minlon + (maxlon-minlon)/2.0;
     //std::cout << minlat << " " << minlon << " " << maxlat << " " << maxlon << std::endl;)
 
-    std::string id;
-    std::string lat;
-    std::string lon;
+    uint64_t id;
 
     for(way_node = parent_of_nodes.child("node"); way_node != nullptr; way_node = way_node.next_sibling("node")) {
 
@@ -234,27 +190,26 @@ OSMGraph* OsmParser::read_nodes(pugi::xml_document* doc, bool debug) {
         std::cerr << ". Continuing" << std::endl;
         continue;
       }
-      id = way_node.attribute("id").value();
-      lat = way_node.attribute("lat").value();
-      lon = way_node.attribute("lon").value();
+      if(!read_id(way_node.attribute("id"), id)) {
+        std::cerr << "Improperly formed node id: " << way_node.attribute("id").value();
+        std::cerr << ". Continuing" << std::endl;
+        continue;
+      }
 
       if (graph->Contains(id)) {
-        std::cerr << "Attempted to add duplicate node. ID: " << way_node.attribute("ref");
+        std::cerr << "Attempted to add duplicate node. ID: " << id;
         std::cerr << ". Continuing" << std::endl;
+        continue;
       }
 
-      float latitude = std::stod(lat);
-      float longitude = std::stod(lon);
+      float latitude = way_node.attribute("lat").as_double();
+      float longitude = way_node.attribute("lon").as_double();
       float latN = OsmParser::normalize(latitude, minlat, maxlat);
       float lonN = OsmParser::normalize(longitude, minlon, maxlon);
 
-      longitude = OsmParser::getLon(latitude,longitude, centerLat, centerLon);
-      latitude = -(latitude-centerLat)* 40008000.0 / 360.0;
-      float height = 264.0f;
-
       graph->AddNode(
         new OSMNode(
-          Point3(longitude, height, latitude),
+          OsmParser::Project(latitude, longitude, centerLat, centerLon),
           id));
           
     }
@@ -262,6 +217,13 @@ OSMGraph* OsmParser::read_nodes(pugi::xml_document* doc, bool debug) {
     return graph;
 };
 
+Point3 OsmParser::Project(float latitude, float longitude, float centerLat, float centerLon) {
+  float x = OsmParser::getLon(latitude, longitude, centerLat, centerLon);
+  float z = -(latitude-centerLat)* 40008000.0 / 360.0;
+  float height = 264.0f;
+  return Point3(x, height, z);
+}
+
 float OsmParser::normalize(float val, float max, float min) {
   return (val - min) / (max - min);
 };
@@ -278,91 +240,75 @@ float OsmParser::asRadians(float degrees) {
   return degrees * 3.14159f / 180.0f;
 }
 
-void OsmParser::read_adjacencies_to(OSMGraph* graph, pugi::xml_document* doc, bool debug) {
-  unordered_map<string, set<string>> adjacencies = get_adjacency_list_from_file(doc, debug);
+bool OsmParser::read_id(pugi::xml_attribute attribute, uint64_t& id) {
+  const char* value = attribute.value();
+  return OSMGraph::ParseId(value, value + strlen(value), id);
+}
 
-  for(auto it : adjacencies) {
-    string from = it.first;
-    set<string> others = it.second;
-    if(!graph->Contains(from)) {
-      std::cerr << "Node ID: " << from << " not found. Continuing." << std::endl;
+void OsmParser::read_adjacencies_to(OSMGraph* graph, pugi::xml_document* doc, bool debug) {
+  vector< std::pair<uint64_t, uint64_t> > adjacencies = get_adjacency_list_from_file(doc, debug);
+
+  uint64_t missing = 0;
+  for(const auto& edge : adjacencies) {
+    if(!graph->Contains(edge.first)) {
+      if (edge.first != missing) {
+        std::cerr << "Node ID: " << edge.first << " not found. Continuing." << std::endl;
+        missing = edge.first;
+      }
       continue;
     } // implicit else
 
-    for(string to : others) {
-      if(!graph->Contains(to)) {
-        std::cerr << "Node ID: " << to << " not found. Continuing." << std::endl;
-        continue;
-      } // implicit else
+    if(!graph->Contains(edge.second)) {
+      std::cerr << "Node ID: " << edge.second << " not found. Continuing." << std::endl;
+      continue;
+    } // implicit else
 
-      graph->AddEdge(from, to);
-    }
+    graph->AddEdge(edge.first, edge.second);
   }
 };
 
-std::unordered_map<std::string, std::set<std::string>>
+vector< std::pair<uint64_t, uint64_t> >
     OsmParser::get_adjacency_list_from_file(pugi::xml_document* doc, bool debug) {
 
-  // create a parent of all (interesting) nodes, then get the first node the the "way" name
+  // every consecutive pair of "nd" children of a highway way is an edge, in
+  // both directions; sorting by (from, to) groups each node's neighbours
+  // and lets duplicates from overlapping ways be dropped
+  vector< std::pair<uint64_t, uint64_t> > adjacency_list;
   pugi::xml_node parent_of_nodes = doc->first_child();
-  pugi::xml_node way_node = parent_of_nodes.child("way");
-  // create a hashmap the takes a string id and returns the xml_node
-  //  corresponding to the "way" node with the same id
-  std::unordered_map<std::string, pugi::xml_node> highway_way_nodes =
-    std::unordered_map<std::string, pugi::xml_node>();
-  // while the current way node is not equal to null, if it has a highway tag, add it to the hashmap
-  //  of ids to way nodes
-  while (way_node != NULL) {  
+  for (pugi::xml_node way_node = parent_of_nodes.child("way"); way_node != NULL; way_node = way_node.next_sibling("way")) {
+    bool highway = false;
     for(pugi::xml_node tag_node = way_node.child("tag"); tag_node != nullptr; tag_node = tag_node.next_sibling("tag")) {
-      if (tag_node != NULL &&
-          strcmp(tag_node.attribute("k").value(), "highway") == 0) {
-        highway_way_nodes.insert({way_node.attribute("id").value(), way_node});
+      if (strcmp(tag_node.attribute("k").value(), "highway") == 0) {
+        highway = true;
         break;
       }
     }
-    way_node = way_node.next_sibling();
-  }
-  // get all the string ids of nodes that are a part of highway ways, we don't care about the order
-  //  and don't want repeats, so we use a unordered set
-  std::unordered_set<std::string> highway_node_ids = std::unordered_set<std::string>();
-  // for every highway way node, any child named "nd" is a node that is part of the way,
-  //  so add it to the highway node ids set
-  for (auto & pair : highway_way_nodes) {
-    pugi::xml_node way_node_child = pair.second.child("nd");
-    while (way_node_child != NULL) {
-      // if the node's name is not nd, we don't care about it, so skip. otherwise add to set
-      if (strcmp(way_node_child.name(), "nd") == 0) {
-        highway_node_ids.insert(way_node_child.attribute("ref").value());
-      }
-      way_node_child = way_node_child.next_sibling();
+    if (!highway) {
+      continue;
     }
-  }
-  // we want an adjacency list that maps from a node's id to a list of nodes it is connected to
-  std::unordered_map<std::string, std::set<std::string>> adjacency_list =
-  std::unordered_map<std::string, std::set<std::string>>();
-  // initialize it
-  for (auto highway_node_id : highway_node_ids) {
-    adjacency_list.insert({highway_node_id, std::set<std::string>()});
-  }
-  int num_edges = 0;
-  // for every way node, adjacent "nd" nodes are connected, iterate through and connect
-  //  adjacent nodes in the adjacency list
-  for (auto way_node_key_value : highway_way_nodes) {
-    pugi::xml_node first = way_node_key_value.second.child("nd");
-    pugi::xml_node second = way_node_key_value.second.child("nd").next_sibling();
-    while (second != NULL) {
-      // if either first or second nodes aren't "nd" nodes, skip
-      //  otherwise assign each to the other's adjacency list
-      if (strcmp(first.name(), "nd") == 0 && strcmp(second.name(), "nd") == 0) {
-        adjacency_list[first.attribute("ref").value()].insert(second.attribute("ref").value());
-        adjacency_list[second.attribute("ref").value()].insert(first.attribute("ref").value());
-        num_edges++;
+
+    uint64_t previous = 0;
+    bool has_previous = false;
+    for (pugi::xml_node nd = way_node.child("nd"); nd != NULL; nd = nd.next_sibling("nd")) {
+      uint64_t id;
+      if (!read_id(nd.attribute("ref"), id)) {
+        std::cerr << "Improperly formed node reference: " << nd.attribute("ref").value();
+        std::cerr << ". Continuing" << std::endl;
+        has_previous = false;
+        continue;
+      }
+      if (has_previous) {
+        adjacency_list.push_back({previous, id});
+        adjacency_list.push_back({id, previous});
       }
-      first = second;
-      second = second.next_sibling();
+      previous = id;
+      has_previous = true;
     }
   }
+
+  std::sort(adjacency_list.begin(), adjacency_list.end());
+  adjacency_list.erase(std::unique(adjacency_list.begin(), adjacency_list.end()), adjacency_list.end());
   return adjacency_list;
 };
 
-}
\ No newline at end of file
+}
@@ -0,0 +1,170 @@
+#include "poi_table.h"
+#include "compact_graph.h"
+#include "util/binary_io.h"
+
+#include <fstream>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+
+namespace routing {
+
+static const int DIMENSIONS = 3;
+
+// the same fingerprint as hub labels, so a saved table is only used for the
+// map it was built on
+PoiTable::PoiTable(const IGraph* graph, const std::vector<Poi>& pois) : pois(pois) {
+    graphFingerprint = CompactGraph(graph).GetFingerprint();
+}
+
+PoiTable::PoiTable(const IGraph* graph, const std::vector<Poi>& pois, const RoutingStrategy& strategy, int threads) : PoiTable(graph, pois) {
+    int n = pois.size();
+    std::vector<PathRequest> requests;
+    for (int i = 0; i < n; i++) {
+        if (pois[i].position.size() != DIMENSIONS) {
+            throw std::invalid_argument("POI position must have 3 coordinates: " + pois[i].name);
+        }
+        for (int j = 0; j < n; j++) {
+            requests.push_back(PathRequest(pois[i].position, pois[j].position, &strategy));
+        }
+    }
+    std::vector<Route> routes = graph->GetPaths(requests, threads);
+
+    offsets.push_back(0);
+    for (const Route& route : routes) {
+        // GetPath falls back to the two nearest nodes when there is no path
+        if (!route.result.path.empty()) {
+            for (const std::vector<float>& point : route.path) {
+                points.insert(points.end(), point.begin(), point.end());
+            }
+        }
+        offsets.push_back(points.size()/DIMENSIONS);
+        distances.push_back(route.result.path.empty() ? std::numeric_limits<float>::infinity() : route.result.length);
+    }
+    points.shrink_to_fit();
+}
+
+int PoiTable::IndexOf(const std::string& name) const {
+    for (int i = 0; i < pois.size(); i++) {
+        if (pois[i].name == name) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+int PoiTable::Find(const std::vector<float>& position, float tolerance) const {
+    int best = -1;
+    float bestDistance = tolerance;
+    for (int i = 0; i < pois.size(); i++) {
+        float distance = EuclideanDistance().Calculate(position, pois[i].position);
+        if (distance <= bestDistance) {
+            best = i;
+            bestDistance = distance;
+        }
+    }
+    return best;
+}
+
+std::vector< std::vector<float> > PoiTable::GetPath(int from, int to) const {
+    int route = from*pois.size() + to;
+    std::vector< std::vector<float> > path;
+    for (int i = offsets[route]; i < offsets[route + 1]; i++) {
+        path.push_back(std::vector<float>(points.begin() + i*DIMENSIONS, points.begin() + (i + 1)*DIMENSIONS));
+    }
+    return path;
+}
+
+bool PoiTable::Lookup(const std::vector<float>& src, const std::vector<float>& dest,
+        std::vector< std::vector<float> >& path, float tolerance) const {
+    int from = Find(src, tolerance);
+    int to = Find(dest, tolerance);
+    if (from < 0 || to < 0 || GetDistance(from, to) == std::numeric_limits<float>::infinity()) {
+        return false;
+    }
+    path = GetPath(from, to);
+    return true;
+}
+
+MemoryReport PoiTable::GetMemoryReport() const {
+    MemoryReport report;
+    size_t poiBytes = MemoryReport::Of(pois);
+    for (const Poi& poi : pois) {
+        poiBytes += MemoryReport::Of(poi.name) + MemoryReport::Of(poi.position);
+    }
+    report.Add("pois", poiBytes);
+    report.Add("paths", MemoryReport::Of(offsets) + MemoryReport::Of(points));
+    report.Add("distances", MemoryReport::Of(distances));
+    report.SetCount("pois", pois.size());
+    report.SetCount("path points", points.size()/DIMENSIONS);
+    return report;
+}
+
+void PoiTable::Save(std::ostream& out) const {
+    int n = pois.size();
+    out.write(reinterpret_cast<const char*>(&graphFingerprint), sizeof(graphFingerprint));
+    out.write(reinterpret_cast<const char*>(&n), sizeof(n));
+    for (const Poi& poi : pois) {
+        WriteVector(out, std::vector<char>(poi.name.begin(), poi.name.end()));
+        WriteVector(out, poi.position);
+    }
+    WriteVector(out, offsets);
+    WriteVector(out, points);
+    WriteVector(out, distances);
+}
+
+PoiTable* PoiTable::Load(std::istream& in, const IGraph* graph, const std::vector<Poi>& pois) {
+    PoiTable* table = new PoiTable(graph, pois);
+    uint64_t fingerprint = 0;
+    in.read(reinterpret_cast<char*>(&fingerprint), sizeof(fingerprint));
+    int n = 0;
+    in.read(reinterpret_cast<char*>(&n), sizeof(n));
+    if (!in || fingerprint != table->graphFingerprint || n != pois.size()) {
+        delete table;
+        return NULL;
+    }
+    for (int i = 0; i < n; i++) {
+        std::vector<char> name;
+        std::vector<float> position;
+        if (!ReadVector(in, name) || !ReadVector(in, position)
+                || std::string(name.begin(), name.end()) != pois[i].name || position != pois[i].position) {
+            delete table;
+            return NULL;
+        }
+    }
+
+    bool ok = ReadVector(in, table->offsets)
+        && ReadVector(in, table->points)
+        && ReadVector(in, table->distances);
+    if (!ok || table->offsets.size() != n*n + 1 || table->distances.size() != n*n
+            || table->offsets.back()*DIMENSIONS != table->points.size()) {
+        delete table;
+        return NULL;
+    }
+    return table;
+}
+
+std::vector<PoiTable::Poi> PoiTable::ReadPois(const std::string& file) {
+    std::ifstream in(file);
+    if (!in) {
+        throw std::runtime_error("unable to read POI file " + file);
+    }
+    std::vector<Poi> pois;
+    std::string line;
+    for (int number = 1; std::getline(in, line); number++) {
+        std::istringstream fields(line);
+        Poi poi;
+        if (!(fields >> poi.name) || poi.name[0] == '#') {
+            continue;
+        }
+        poi.position.resize(DIMENSIONS);
+        std::string rest;
+        if (!(fields >> poi.position[0] >> poi.position[1] >> poi.position[2]) || (fields >> rest)) {
+            throw std::runtime_error(file + ":" + std::to_string(number) + ": expected \"name x y z\"");
+        }
+        pois.push_back(poi);
+    }
+    return pois;
+}
+
+}
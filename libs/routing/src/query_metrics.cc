@@ -0,0 +1,180 @@
+#include "query_metrics.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <limits>
+
+namespace routing {
+
+static const double SMALLEST = std::ldexp(1.0, -10);
+
+Histogram::Histogram() : count(0), sum(0), min(0), max(0) {
+    std::fill(counts, counts + BUCKETS, 0L);
+}
+
+int Histogram::bucketOf(double value) {
+    if (!(value >= SMALLEST)) {
+        return 0;
+    }
+    double bucket = std::floor((std::log2(value) + 10)*4) + 1;
+    return bucket >= BUCKETS - 1 ? BUCKETS - 1 : (int)bucket;
+}
+
+double Histogram::upperBound(int bucket) {
+    if (bucket >= BUCKETS - 1) {
+        return std::numeric_limits<double>::infinity();
+    }
+    return std::exp2(-10 + bucket/4.0);
+}
+
+void Histogram::Record(double value) {
+    if (count == 0 || value < min) {
+        min = value;
+    }
+    if (count == 0 || value > max) {
+        max = value;
+    }
+    counts[bucketOf(value)]++;
+    count++;
+    sum += value;
+}
+
+void Histogram::Merge(const Histogram& other) {
+    if (other.count == 0) {
+        return;
+    }
+    min = count ? std::min(min, other.min) : other.min;
+    max = count ? std::max(max, other.max) : other.max;
+    for (int i = 0; i < BUCKETS; i++) {
+        counts[i] += other.counts[i];
+    }
+    count += other.count;
+    sum += other.sum;
+}
+
+double Histogram::Percentile(double p) const {
+    if (count == 0) {
+        return 0;
+    }
+    double rank = std::max(1.0, std::ceil(p/100.0*count));
+    long seen = 0;
+    for (int i = 0; i < BUCKETS; i++) {
+        seen += counts[i];
+        if (seen >= rank) {
+            return std::max(min, std::min(max, upperBound(i)));
+        }
+    }
+    return max;
+}
+
+QueryMetrics& QueryMetrics::Global() {
+    static QueryMetrics metrics;
+    return metrics;
+}
+
+void QueryMetrics::Record(const std::string& strategy, const std::vector<float>& src, const std::vector<float>& dest, const QueryResult& result) {
+    if (!IsEnabled()) {
+        return;
+    }
+    const QueryStats& stats = result.stats;
+    std::lock_guard<std::mutex> lock(mutex);
+    StrategyMetrics& metrics = strategies[strategy];
+    metrics.queries++;
+    if (result.status == QueryResult::INTERRUPTED) {
+        metrics.interrupted++;
+    }
+    else if (result.status == QueryResult::UNREACHABLE) {
+        metrics.unreachable++;
+    }
+    metrics.searchMicros.Record(stats.searchSeconds*1e6);
+    metrics.snapMicros.Record(stats.snapSeconds*1e6);
+    metrics.nodesSettled.Record(stats.nodesSettled);
+    metrics.edgesRelaxed.Record(stats.edgesRelaxed);
+    metrics.heapPushes.Record(stats.heapPushes);
+    metrics.peakQueue.Record(stats.peakQueue);
+    if (!result.path.empty()) {
+        metrics.pathLength.Record(stats.pathLength);
+    }
+
+    // keep the list sorted, slowest first
+    std::vector<QuerySample>& slowest = metrics.slowest;
+    if (slowest.size() < SLOWEST || stats.searchSeconds > slowest.back().stats.searchSeconds) {
+        QuerySample sample = {src, dest, result.status, stats};
+        auto at = std::upper_bound(slowest.begin(), slowest.end(), sample,
+            [](const QuerySample& a, const QuerySample& b) { return a.stats.searchSeconds > b.stats.searchSeconds; });
+        slowest.insert(at, sample);
+        if (slowest.size() > SLOWEST) {
+            slowest.pop_back();
+        }
+    }
+}
+
+std::vector<std::string> QueryMetrics::GetStrategies() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::vector<std::string> names;
+    for (const auto& entry : strategies) {
+        names.push_back(entry.first);
+    }
+    return names;
+}
+
+StrategyMetrics QueryMetrics::Get(const std::string& strategy) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = strategies.find(strategy);
+    return it == strategies.end() ? StrategyMetrics() : it->second;
+}
+
+void QueryMetrics::Reset() {
+    std::lock_guard<std::mutex> lock(mutex);
+    strategies.clear();
+}
+
+static void printRow(std::ostream& out, const char* name, const Histogram& histogram) {
+    out << "  " << std::left << std::setw(14) << name << std::right
+        << std::setw(12) << histogram.Percentile(50)
+        << std::setw(12) << histogram.Percentile(90)
+        << std::setw(12) << histogram.Percentile(99)
+        << std::setw(12) << histogram.Max() << std::endl;
+}
+
+static void printPoint(std::ostream& out, const std::vector<float>& point) {
+    out << "(";
+    for (int i = 0; i < point.size(); i++) {
+        out << (i ? ", " : "") << point[i];
+    }
+    out << ")";
+}
+
+void QueryMetrics::Print(std::ostream& out) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::ios::fmtflags flags = out.flags();
+    std::streamsize precision = out.precision(4);
+    for (const auto& entry : strategies) {
+        const StrategyMetrics& metrics = entry.second;
+        out << entry.first << ": " << metrics.queries << " queries, "
+            << metrics.interrupted << " interrupted, " << metrics.unreachable << " unreachable" << std::endl;
+        out << "  " << std::left << std::setw(14) << "" << std::right
+            << std::setw(12) << "p50" << std::setw(12) << "p90"
+            << std::setw(12) << "p99" << std::setw(12) << "max" << std::endl;
+        printRow(out, "search us", metrics.searchMicros);
+        printRow(out, "snap us", metrics.snapMicros);
+        printRow(out, "settled", metrics.nodesSettled);
+        printRow(out, "relaxed", metrics.edgesRelaxed);
+        printRow(out, "pushes", metrics.heapPushes);
+        printRow(out, "peak queue", metrics.peakQueue);
+        printRow(out, "path length", metrics.pathLength);
+        for (const QuerySample& sample : metrics.slowest) {
+            out << "  slow: ";
+            printPoint(out, sample.src);
+            out << " -> ";
+            printPoint(out, sample.dest);
+            out << " " << sample.stats.searchSeconds*1e6 << " us, "
+                << sample.stats.nodesSettled << " settled" << std::endl;
+        }
+    }
+    out.precision(precision);
+    out.flags(flags);
+}
+
+}
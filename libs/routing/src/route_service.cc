@@ -0,0 +1,47 @@
+#include "route_service.h"
+
+#include <chrono>
+#include "query_metrics.h"
+#include "routing/astar.h"
+#include "routing/depth_first_search.h"
+#include "routing/dijkstra.h"
+
+namespace routing {
+
+std::future<Route> RouteService::Request(std::shared_ptr<const IGraph> graph, const std::vector<float>& src, const std::vector<float>& dest,
+        const RoutingStrategy& strategy, float epsilon, int budgetMs) {
+    const RoutingStrategy* pathing = &strategy;
+    if (synchronous) {
+        // a deadline would make the route depend on how fast this machine is
+        std::packaged_task<Route()> query([graph, src, dest, pathing, epsilon]() {
+            Route route;
+            route.path = graph->GetPath(src, dest, *pathing, QueryOptions::Bounded(epsilon), &route.result);
+            return route;
+        });
+        std::future<Route> result = query.get_future();
+        query();
+        return result;
+    }
+    return pool.Submit([graph, src, dest, pathing, epsilon, budgetMs]() {
+        QueryOptions options = budgetMs > 0
+            ? QueryOptions::Within(epsilon, std::chrono::milliseconds(budgetMs))
+            : QueryOptions::Bounded(epsilon);
+        Route route;
+        route.path = graph->GetPath(src, dest, *pathing, options, &route.result);
+        return route;
+    });
+}
+
+RouteService& RouteService::Shared() {
+    // routes still planned at exit record into the metrics and run on the
+    // shared algorithms, so those have to outlive the pool; statics are
+    // destroyed in reverse order of creation
+    QueryMetrics::Global();
+    AStar::Default();
+    Dijkstra::Instance();
+    DepthFirstSearch::Default();
+    static RouteService service;
+    return service;
+}
+
+}
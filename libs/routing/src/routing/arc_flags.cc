@@ -0,0 +1,332 @@
+#include "routing/arc_flags.h"
+#include "routing/astar.h"
+#include "util/parallel.h"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <stdexcept>
+
+using namespace std;
+
+namespace routing {
+
+static const float INF = numeric_limits<float>::infinity();
+typedef pair<float, int> Entry;
+typedef priority_queue<Entry, vector<Entry>, greater<Entry> > MinQueue;
+
+// Relative slack when testing whether an edge lies on a shortest path.
+// Flagging an extra edge only costs pruning, missing one would cost
+// correctness, so float round-off must err on the side of flagging.
+static const float TIGHT = 1e-5f;
+
+const int ArcFlags::MAX_CELLS;
+
+ArcFlags::ArcFlags(const CompactGraph& graph, int cells, int threads) : graph(graph), dirty(0) {
+    int n = graph.NumNodes();
+    this->cells = max(1, min(min(cells, MAX_CELLS), max(n, 1)));
+    cellOf.assign(n, 0);
+    flags.assign(graph.NumEdges(), 0);
+
+    vector<int> nodes(n);
+    for (int i = 0; i < n; i++) {
+        nodes[i] = i;
+    }
+    partition(nodes, 0, n, 0, this->cells);
+
+    // boundary nodes of a cell are the ones entered from another cell
+    boundary.resize(this->cells);
+    for (int v = 0; v < n; v++) {
+        for (int r = graph.ReverseBegin(v); r < graph.ReverseEnd(v); r++) {
+            if (cellOf[graph.ReverseSource(r)] != cellOf[v]) {
+                boundary[cellOf[v]].push_back(v);
+                break;
+            }
+        }
+    }
+
+    vector<int> all(this->cells);
+    for (int c = 0; c < this->cells; c++) {
+        all[c] = c;
+    }
+    compute(all, threads);
+}
+
+void ArcFlags::partition(vector<int>& nodes, int begin, int end, int firstCell, int count) {
+    if (count <= 1 || end - begin <= 1) {
+        for (int i = begin; i < end; i++) {
+            cellOf[nodes[i]] = firstCell;
+        }
+        return;
+    }
+
+    // split along the wider of x and z, in proportion to the cells per side
+    float minX = INF, maxX = -INF, minZ = INF, maxZ = -INF;
+    for (int i = begin; i < end; i++) {
+        const float* p = graph.GetPosition(nodes[i]);
+        minX = min(minX, p[0]);
+        maxX = max(maxX, p[0]);
+        minZ = min(minZ, p[2]);
+        maxZ = max(maxZ, p[2]);
+    }
+    int axis = (maxX - minX) >= (maxZ - minZ) ? 0 : 2;
+    int left = count/2;
+    int middle = begin + (long)(end - begin)*left/count;
+    nth_element(nodes.begin() + begin, nodes.begin() + middle, nodes.begin() + end, [&](int a, int b) {
+        return graph.GetPosition(a)[axis] < graph.GetPosition(b)[axis];
+    });
+    partition(nodes, begin, middle, firstCell, left);
+    partition(nodes, middle, end, firstCell + left, count - left);
+}
+
+vector<int> ArcFlags::flaggedEdges(int cell) const {
+    int n = graph.NumNodes();
+    vector<char> flagged(graph.NumEdges(), 0);
+
+    // edges inside the cell lead to it trivially
+    for (int u = 0; u < n; u++) {
+        if (cellOf[u] != cell) {
+            continue;
+        }
+        for (int e = graph.EdgeBegin(u); e < graph.EdgeEnd(u); e++) {
+            if (cellOf[graph.EdgeTarget(e)] == cell) {
+                flagged[e] = 1;
+            }
+        }
+    }
+
+    // every path from outside enters through a boundary node, so a backward
+    // shortest-path tree from each boundary node finds the remaining edges
+    vector<float> dist(n, INF);
+    vector<int> touched;
+    for (int b : boundary[cell]) {
+        MinQueue queue;
+        dist[b] = 0;
+        touched.push_back(b);
+        queue.push(Entry(0, b));
+        while (!queue.empty()) {
+            Entry top = queue.top();
+            queue.pop();
+            int v = top.second;
+            if (top.first > dist[v]) {
+                continue;
+            }
+            for (int r = graph.ReverseBegin(v); r < graph.ReverseEnd(v); r++) {
+                int u = graph.ReverseSource(r);
+                float d = top.first + graph.EdgeWeight(graph.ReverseEdge(r));
+                if (d < dist[u]) {
+                    if (dist[u] == INF) {
+                        touched.push_back(u);
+                    }
+                    dist[u] = d;
+                    queue.push(Entry(d, u));
+                }
+            }
+        }
+
+        for (int v : touched) {
+            for (int r = graph.ReverseBegin(v); r < graph.ReverseEnd(v); r++) {
+                int u = graph.ReverseSource(r);
+                int e = graph.ReverseEdge(r);
+                float through = dist[v] + graph.EdgeWeight(e);
+                if (through <= dist[u] + TIGHT*max(1.0f, dist[u])) {
+                    flagged[e] = 1;
+                }
+            }
+        }
+        for (int v : touched) {
+            dist[v] = INF;
+        }
+        touched.clear();
+    }
+
+    vector<int> edges;
+    for (int e = 0; e < flagged.size(); e++) {
+        if (flagged[e]) {
+            edges.push_back(e);
+        }
+    }
+    return edges;
+}
+
+void ArcFlags::compute(const vector<int>& cellsToCompute, int threads) {
+    // cells are independent; each task collects its edges and the bits are
+    // merged afterwards so no two threads write the same word
+    int count = cellsToCompute.size();
+    vector< vector<int> > results(count);
+    ParallelFor(count, min(DefaultThreadCount(threads), count), [&](int begin, int end, int thread) {
+        for (int i = begin; i < end; i++) {
+            results[i] = flaggedEdges(cellsToCompute[i]);
+        }
+    });
+
+    uint64_t mask = 0;
+    for (int c : cellsToCompute) {
+        mask |= uint64_t(1) << c;
+    }
+    for (uint64_t& word : flags) {
+        word &= ~mask;
+    }
+    for (int i = 0; i < count; i++) {
+        uint64_t bit = uint64_t(1) << cellsToCompute[i];
+        for (int e : results[i]) {
+            flags[e] |= bit;
+        }
+    }
+}
+
+void ArcFlags::WeightChanged(int edge, float previous) {
+    if (edge < 0 || edge >= flags.size()) {
+        throw invalid_argument("edge not found in graph");
+    }
+    float weight = graph.EdgeWeight(edge);
+    if (weight > previous) {
+        dirty |= flags[edge];
+    }
+    else if (weight < previous) {
+        dirty |= cells == MAX_CELLS ? ~uint64_t(0) : (uint64_t(1) << cells) - 1;
+    }
+}
+
+int ArcFlags::Refresh(int threads) {
+    vector<int> stale;
+    for (int c = 0; c < cells; c++) {
+        if ((dirty >> c) & 1) {
+            stale.push_back(c);
+        }
+    }
+    dirty = 0;
+    if (!stale.empty()) {
+        compute(stale, threads);
+    }
+    return stale.size();
+}
+
+MemoryReport ArcFlags::GetMemoryReport() const {
+    MemoryReport report;
+    size_t cellBytes = MemoryReport::Of(cellOf) + MemoryReport::Of(boundary);
+    for (const vector<int>& nodes : boundary) {
+        cellBytes += MemoryReport::Of(nodes);
+    }
+    report.Add("cells", cellBytes);
+    report.Add("flags", MemoryReport::Of(flags));
+    report.SetCount("cells", cells);
+    return report;
+}
+
+// ---- queries ----
+
+vector<int> ArcFlagAStar::GetPath(int from, int to) const {
+    QueryStats stats;
+    return search(from, to, stats);
+}
+
+vector<int> ArcFlagAStar::search(int from, int to, QueryStats& stats) const {
+    const CompactGraph& graph = flags.GetCompactGraph();
+    int n = graph.NumNodes();
+    vector<int> path;
+    if (from < 0 || to < 0 || from >= n || to >= n) {
+        return path;
+    }
+
+    int cell = flags.CellOf(to);
+    vector<float> dist(n, INF);
+    vector<int> parent(n, -1);
+    vector<bool> closed(n, false);
+    MinQueue queue;
+    dist[from] = 0;
+    queue.push(Entry(graph.Distance(from, to), from));
+    stats.Pushed(queue.size());
+
+    while (!queue.empty()) {
+        int u = queue.top().second;
+        queue.pop();
+        stats.heapPops++;
+        if (closed[u]) {
+            continue;
+        }
+        closed[u] = true;
+        stats.nodesSettled++;
+        if (u == to) {
+            break;
+        }
+        for (int e = graph.EdgeBegin(u); e < graph.EdgeEnd(u); e++) {
+            if (!flags.Flag(e, cell)) {
+                continue;
+            }
+            stats.edgesRelaxed++;
+            int v = graph.EdgeTarget(e);
+            float d = dist[u] + graph.EdgeWeight(e);
+            if (d < dist[v]) {
+                dist[v] = d;
+                parent[v] = u;
+                queue.push(Entry(d + graph.Distance(v, to), v));
+                stats.Pushed(queue.size());
+            }
+        }
+    }
+
+    if (!closed[to]) {
+        return path;
+    }
+    stats.pathLength = dist[to];
+    for (int v = to; v != -1; v = parent[v]) {
+        path.push_back(v);
+    }
+    reverse(path.begin(), path.end());
+    return path;
+}
+
+vector<string> ArcFlagAStar::GetPath(const IGraph* graph, const std::string& from, const std::string& to) const {
+    const CompactGraph& compact = flags.GetCompactGraph();
+    if (graph != compact.GetGraph()) {
+        return AStar::Default().GetPath(graph, from, to);
+    }
+
+    int source = compact.IndexOf(from);
+    if (source < 0) {
+        throw invalid_argument("'from' node not found in graph: " + from);
+    }
+    int target = compact.IndexOf(to);
+    if (target < 0) {
+        throw invalid_argument("'to' node not found in graph: " + to);
+    }
+
+    vector<string> names;
+    for (int v : GetPath(source, target)) {
+        names.push_back(compact.GetNode(v)->GetName());
+    }
+    return names;
+}
+
+QueryResult ArcFlagAStar::GetPath(const IGraph* graph, const std::string& from, const std::string& to, const QueryOptions& options) const {
+    const CompactGraph& compact = flags.GetCompactGraph();
+    if (graph != compact.GetGraph()) {
+        return AStar::Default().GetPath(graph, from, to, options);
+    }
+
+    int source = compact.IndexOf(from);
+    if (source < 0) {
+        throw invalid_argument("'from' node not found in graph: " + from);
+    }
+    int target = compact.IndexOf(to);
+    if (target < 0) {
+        throw invalid_argument("'to' node not found in graph: " + to);
+    }
+
+    // exact, so options cannot make it any faster
+    QueryResult result;
+    for (int v : search(source, target, result.stats)) {
+        result.path.push_back(compact.GetNode(v)->GetName());
+    }
+    if (!result.path.empty()) {
+        result.status = QueryResult::COMPLETE;
+        result.length = result.stats.pathLength;
+        result.bound = 1;
+    }
+    return result;
+}
+
+}
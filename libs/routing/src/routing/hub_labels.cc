@@ -0,0 +1,403 @@
+#include "routing/hub_labels.h"
+#include "util/binary_io.h"
+
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <stdexcept>
+#include <unordered_map>
+
+using namespace std;
+
+namespace routing {
+
+static const float INF = numeric_limits<float>::infinity();
+typedef pair<float, int> Entry;
+typedef priority_queue<Entry, vector<Entry>, greater<Entry> > MinQueue;
+
+// ---- contraction order ----
+
+// Settled-node limit of a witness search; a missed witness only costs an
+// extra shortcut, never correctness of the order.
+static const int WITNESS_LIMIT = 60;
+
+struct Contraction {
+    vector< unordered_map<int, float> > out;
+    vector< unordered_map<int, float> > in;
+    vector<bool> contracted;
+    vector<int> deletedNeighbors;
+
+    // distances from u (not passing through via) up to limit
+    void witness(int u, int via, float limit, unordered_map<int, float>& dist) const {
+        dist.clear();
+        MinQueue queue;
+        dist[u] = 0;
+        queue.push(Entry(0, u));
+        int settled = 0;
+        while (!queue.empty() && settled < WITNESS_LIMIT) {
+            Entry top = queue.top();
+            queue.pop();
+            if (top.first > limit) {
+                break;
+            }
+            if (top.first > dist[top.second]) {
+                continue;
+            }
+            settled++;
+            for (const auto& edge : out[top.second]) {
+                if (edge.first == via || contracted[edge.first]) {
+                    continue;
+                }
+                float d = top.first + edge.second;
+                auto it = dist.find(edge.first);
+                if (it == dist.end() || d < it->second) {
+                    dist[edge.first] = d;
+                    queue.push(Entry(d, edge.first));
+                }
+            }
+        }
+    }
+
+    // shortcuts needed to contract v; added to the graph when apply is set
+    int shortcuts(int v, bool apply) {
+        int count = 0;
+        unordered_map<int, float> dist;
+        vector< pair<int, pair<int, float> > > added;
+        for (const auto& incoming : in[v]) {
+            int u = incoming.first;
+            float limit = 0;
+            for (const auto& outgoing : out[v]) {
+                limit = max(limit, incoming.second + outgoing.second);
+            }
+            witness(u, v, limit, dist);
+            for (const auto& outgoing : out[v]) {
+                int w = outgoing.first;
+                if (w == u) {
+                    continue;
+                }
+                float through = incoming.second + outgoing.second;
+                auto it = dist.find(w);
+                if (it != dist.end() && it->second <= through) {
+                    continue;
+                }
+                count++;
+                if (apply) {
+                    added.push_back(make_pair(u, make_pair(w, through)));
+                }
+            }
+        }
+        for (const auto& shortcut : added) {
+            int u = shortcut.first;
+            int w = shortcut.second.first;
+            float weight = shortcut.second.second;
+            auto it = out[u].find(w);
+            if (it == out[u].end() || weight < it->second) {
+                out[u][w] = weight;
+                in[w][u] = weight;
+            }
+        }
+        return count;
+    }
+
+    int priority(int v) {
+        int removed = in[v].size() + out[v].size();
+        return shortcuts(v, false) - removed + deletedNeighbors[v];
+    }
+
+    void contract(int v) {
+        shortcuts(v, true);
+        for (const auto& incoming : in[v]) {
+            out[incoming.first].erase(v);
+            deletedNeighbors[incoming.first]++;
+        }
+        for (const auto& outgoing : out[v]) {
+            in[outgoing.first].erase(v);
+            deletedNeighbors[outgoing.first]++;
+        }
+        contracted[v] = true;
+    }
+};
+
+vector<int> HubLabels::ContractionOrder(const CompactGraph& graph) {
+    int n = graph.NumNodes();
+    Contraction state;
+    state.out.resize(n);
+    state.in.resize(n);
+    state.contracted.assign(n, false);
+    state.deletedNeighbors.assign(n, 0);
+    for (int u = 0; u < n; u++) {
+        for (int e = graph.EdgeBegin(u); e < graph.EdgeEnd(u); e++) {
+            int v = graph.EdgeTarget(e);
+            float w = graph.EdgeWeight(e);
+            if (u == v) {
+                continue;
+            }
+            auto it = state.out[u].find(v);
+            if (it == state.out[u].end() || w < it->second) {
+                state.out[u][v] = w;
+                state.in[v][u] = w;
+            }
+        }
+    }
+
+    typedef pair<int, int> Candidate;
+    priority_queue<Candidate, vector<Candidate>, greater<Candidate> > queue;
+    for (int v = 0; v < n; v++) {
+        queue.push(Candidate(state.priority(v), v));
+    }
+
+    vector<int> order;
+    order.reserve(n);
+    while (!queue.empty()) {
+        Candidate top = queue.top();
+        queue.pop();
+        int v = top.second;
+        if (state.contracted[v]) {
+            continue;
+        }
+        // lazy update: re-evaluate and put back if it is no longer the minimum
+        int current = state.priority(v);
+        if (!queue.empty() && current > queue.top().first) {
+            queue.push(Candidate(current, v));
+            continue;
+        }
+        state.contract(v);
+        order.push_back(v);
+    }
+    return order;
+}
+
+// ---- label construction ----
+
+HubLabels::HubLabels(const CompactGraph& graph) : graph(graph) {
+    build();
+}
+
+HubLabels::HubLabels(const CompactGraph& graph, bool build) : graph(graph) {
+    if (build) {
+        this->build();
+    }
+}
+
+void HubLabels::build() {
+    int n = graph.NumNodes();
+    order = ContractionOrder(graph);
+    reverse(order.begin(), order.end());
+
+    vector< vector< pair<int, float> > > outLabels(n);
+    vector< vector< pair<int, float> > > inLabels(n);
+
+    // hubDist[rank] holds the root's own label while searching from it
+    vector<float> hubDist(n, INF);
+    vector<float> dist(n, INF);
+    vector<int> touched;
+
+    for (int rank = 0; rank < n; rank++) {
+        int root = order[rank];
+
+        for (int direction = 0; direction < 2; direction++) {
+            bool forward = direction == 0;
+            // forward search fills in-labels and prunes with the root's
+            // out-label, backward search the other way round
+            vector< vector< pair<int, float> > >& rootLabels = forward ? outLabels : inLabels;
+            vector< vector< pair<int, float> > >& targetLabels = forward ? inLabels : outLabels;
+
+            for (const auto& entry : rootLabels[root]) {
+                hubDist[entry.first] = entry.second;
+            }
+
+            MinQueue queue;
+            dist[root] = 0;
+            touched.push_back(root);
+            queue.push(Entry(0, root));
+            while (!queue.empty()) {
+                Entry top = queue.top();
+                queue.pop();
+                int u = top.second;
+                if (top.first > dist[u]) {
+                    continue;
+                }
+
+                float known = INF;
+                for (const auto& entry : targetLabels[u]) {
+                    known = min(known, hubDist[entry.first] + entry.second);
+                }
+                if (known <= top.first) {
+                    continue;
+                }
+                targetLabels[u].push_back(make_pair(rank, top.first));
+
+                int begin = forward ? graph.EdgeBegin(u) : graph.ReverseBegin(u);
+                int end = forward ? graph.EdgeEnd(u) : graph.ReverseEnd(u);
+                for (int i = begin; i < end; i++) {
+                    int v = forward ? graph.EdgeTarget(i) : graph.ReverseSource(i);
+                    float w = graph.EdgeWeight(forward ? i : graph.ReverseEdge(i));
+                    float d = top.first + w;
+                    if (d < dist[v]) {
+                        if (dist[v] == INF) {
+                            touched.push_back(v);
+                        }
+                        dist[v] = d;
+                        queue.push(Entry(d, v));
+                    }
+                }
+            }
+
+            for (int v : touched) {
+                dist[v] = INF;
+            }
+            touched.clear();
+            for (const auto& entry : rootLabels[root]) {
+                hubDist[entry.first] = INF;
+            }
+        }
+    }
+
+    // flatten; entries were appended in increasing rank so they are sorted
+    auto flatten = [n](const vector< vector< pair<int, float> > >& labels,
+            vector<int>& offsets, vector<int>& hubs, vector<float>& distances) {
+        offsets.assign(n + 1, 0);
+        for (int v = 0; v < n; v++) {
+            offsets[v + 1] = offsets[v] + labels[v].size();
+        }
+        hubs.resize(offsets[n]);
+        distances.resize(offsets[n]);
+        for (int v = 0; v < n; v++) {
+            for (int i = 0; i < labels[v].size(); i++) {
+                hubs[offsets[v] + i] = labels[v][i].first;
+                distances[offsets[v] + i] = labels[v][i].second;
+            }
+        }
+    };
+    flatten(outLabels, outOffsets, outHubs, outDistances);
+    flatten(inLabels, inOffsets, inHubs, inDistances);
+}
+
+// ---- queries ----
+
+float HubLabels::Distance(int from, int to) const {
+    if (from < 0 || to < 0 || from >= graph.NumNodes() || to >= graph.NumNodes()) {
+        return INF;
+    }
+    int i = outOffsets[from];
+    int iEnd = outOffsets[from + 1];
+    int j = inOffsets[to];
+    int jEnd = inOffsets[to + 1];
+    float best = INF;
+    while (i < iEnd && j < jEnd) {
+        if (outHubs[i] < inHubs[j]) {
+            i++;
+        }
+        else if (outHubs[i] > inHubs[j]) {
+            j++;
+        }
+        else {
+            best = min(best, outDistances[i] + inDistances[j]);
+            i++;
+            j++;
+        }
+    }
+    return best;
+}
+
+float HubLabels::GetDistance(const IGraph* g, const std::string& from, const std::string& to) const {
+    if (g != graph.GetGraph()) {
+        throw invalid_argument("hub labels were built for a different graph");
+    }
+    int source = graph.IndexOf(from);
+    if (source < 0) {
+        throw invalid_argument("'from' node not found in graph: " + from);
+    }
+    int target = graph.IndexOf(to);
+    if (target < 0) {
+        throw invalid_argument("'to' node not found in graph: " + to);
+    }
+    return Distance(source, target);
+}
+
+float HubLabels::AverageLabelSize() const {
+    int n = graph.NumNodes();
+    return n > 0 ? float(NumEntries())/(2*n) : 0;
+}
+
+// ---- serialization ----
+
+// offsets into hubs that start at 0, never decrease and end at the last
+// hub, with every hub a rank below n
+static bool validLabels(const vector<int>& offsets, const vector<int>& hubs, const vector<float>& distances, int n) {
+    if (offsets.size() != n + 1 || offsets.front() != 0 || offsets.back() != hubs.size()
+            || distances.size() != hubs.size()) {
+        return false;
+    }
+    for (int u = 0; u < n; u++) {
+        if (offsets[u] > offsets[u+1]) {
+            return false;
+        }
+    }
+    for (int hub : hubs) {
+        if (hub < 0 || hub >= n) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void HubLabels::Save(std::ostream& out) const {
+    int n = graph.NumNodes();
+    int m = graph.NumEdges();
+    uint64_t fingerprint = graph.GetFingerprint();
+    out.write(reinterpret_cast<const char*>(&n), sizeof(n));
+    out.write(reinterpret_cast<const char*>(&m), sizeof(m));
+    out.write(reinterpret_cast<const char*>(&fingerprint), sizeof(fingerprint));
+    WriteVector(out, order);
+    WriteVector(out, outOffsets);
+    WriteVector(out, outHubs);
+    WriteVector(out, outDistances);
+    WriteVector(out, inOffsets);
+    WriteVector(out, inHubs);
+    WriteVector(out, inDistances);
+}
+
+HubLabels* HubLabels::Load(std::istream& in, const CompactGraph& graph) {
+    int n = 0;
+    int m = 0;
+    uint64_t fingerprint = 0;
+    in.read(reinterpret_cast<char*>(&n), sizeof(n));
+    in.read(reinterpret_cast<char*>(&m), sizeof(m));
+    in.read(reinterpret_cast<char*>(&fingerprint), sizeof(fingerprint));
+    if (!in || n != graph.NumNodes() || m != graph.NumEdges() || fingerprint != graph.GetFingerprint()) {
+        return NULL;
+    }
+    HubLabels* labels = new HubLabels(graph, false);
+    bool ok = ReadVector(in, labels->order)
+        && ReadVector(in, labels->outOffsets)
+        && ReadVector(in, labels->outHubs)
+        && ReadVector(in, labels->outDistances)
+        && ReadVector(in, labels->inOffsets)
+        && ReadVector(in, labels->inHubs)
+        && ReadVector(in, labels->inDistances);
+    for (int i = 0; ok && i < labels->order.size(); i++) {
+        ok = labels->order[i] >= 0 && labels->order[i] < n;
+    }
+    if (!ok || labels->order.size() != n
+            || !validLabels(labels->outOffsets, labels->outHubs, labels->outDistances, n)
+            || !validLabels(labels->inOffsets, labels->inHubs, labels->inDistances, n)) {
+        delete labels;
+        return NULL;
+    }
+    return labels;
+}
+
+
+MemoryReport HubLabels::GetMemoryReport() const {
+    MemoryReport report;
+    report.Add("order", MemoryReport::Of(order));
+    report.Add("out labels", MemoryReport::Of(outOffsets) + MemoryReport::Of(outHubs) + MemoryReport::Of(outDistances));
+    report.Add("in labels", MemoryReport::Of(inOffsets) + MemoryReport::Of(inHubs) + MemoryReport::Of(inDistances));
+    report.SetCount("entries", NumEntries());
+    return report;
+}
+
+}
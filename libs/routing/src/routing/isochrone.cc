@@ -0,0 +1,321 @@
+#include "routing/isochrone.h"
+#include "util/parallel.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <queue>
+
+using namespace std;
+
+namespace routing {
+
+// Frontiers smaller than this are relaxed on the calling thread; spinning up
+// workers costs more than the relaxations themselves.
+static const int PARALLEL_FRONTIER = 256;
+
+vector<ReachedNode> Isochrone::Reachable(int source, float limit) const {
+    vector<ReachedNode> reached;
+    int n = graph.NumNodes();
+    if (source < 0 || source >= n) {
+        return reached;
+    }
+
+    typedef pair<float, int> Entry;
+    vector<float> dist(n, numeric_limits<float>::infinity());
+    vector<bool> settled(n, false);
+    priority_queue<Entry, vector<Entry>, greater<Entry> > queue;
+    dist[source] = 0;
+    queue.push(Entry(0, source));
+
+    while (!queue.empty()) {
+        Entry top = queue.top();
+        queue.pop();
+        int u = top.second;
+        if (settled[u]) {
+            continue;
+        }
+        if (top.first > limit) {
+            break;
+        }
+        settled[u] = true;
+        reached.push_back({graph.GetNode(u), u, top.first});
+
+        for (int e = graph.EdgeBegin(u); e < graph.EdgeEnd(u); e++) {
+            int v = graph.EdgeTarget(e);
+            float d = top.first + graph.EdgeWeight(e);
+            if (d < dist[v] && d <= limit) {
+                dist[v] = d;
+                queue.push(Entry(d, v));
+            }
+        }
+    }
+
+    return reached;
+}
+
+vector<ReachedNode> Isochrone::Reachable(const vector<float>& position, float limit) const {
+    const IGraphNode* start = graph.GetGraph()->NearestNode(position, EuclideanDistance());
+    if (!start) {
+        return vector<ReachedNode>();
+    }
+    return Reachable(graph.IndexOf(start), limit);
+}
+
+vector<ReachedNode> Isochrone::ReachableWithin(const vector<float>& position, float seconds, float speed) const {
+    return Reachable(position, seconds*speed);
+}
+
+static bool lowerDistance(atomic<float>& dist, float value) {
+    float current = dist.load(memory_order_relaxed);
+    while (value < current) {
+        if (dist.compare_exchange_weak(current, value, memory_order_relaxed)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+vector<float> Isochrone::AllDistances(int source, int threads, float delta) const {
+    int n = graph.NumNodes();
+    const float infinity = numeric_limits<float>::infinity();
+    vector<float> result(n, infinity);
+    if (source < 0 || source >= n) {
+        return result;
+    }
+    if (delta <= 0) {
+        delta = graph.MeanEdgeWeight();
+    }
+    if (delta <= 0) {
+        delta = 1;
+    }
+    threads = DefaultThreadCount(threads);
+
+    vector< atomic<float> > dist(n);
+    for (int i = 0; i < n; i++) {
+        dist[i].store(infinity, memory_order_relaxed);
+    }
+    dist[source].store(0, memory_order_relaxed);
+
+    // pending[v] is the bucket v is currently queued in, or -1; entries left
+    // behind in other buckets after v improved are stale and skipped.
+    vector<int> pending(n, -1);
+    vector< vector<int> > buckets(1, vector<int>(1, source));
+    pending[source] = 0;
+    vector< vector<int> > improved(threads);
+
+    auto relax = [&](const vector<int>& frontier, bool light) {
+        for (vector<int>& list : improved) {
+            list.clear();
+        }
+        auto body = [&](int begin, int end, int thread) {
+            for (int i = begin; i < end; i++) {
+                int u = frontier[i];
+                float du = dist[u].load(memory_order_relaxed);
+                for (int e = graph.EdgeBegin(u); e < graph.EdgeEnd(u); e++) {
+                    float w = graph.EdgeWeight(e);
+                    if ((w <= delta) != light) {
+                        continue;
+                    }
+                    int v = graph.EdgeTarget(e);
+                    if (lowerDistance(dist[v], du + w)) {
+                        improved[thread].push_back(v);
+                    }
+                }
+            }
+        };
+        int size = frontier.size();
+        ParallelFor(size, size >= PARALLEL_FRONTIER ? threads : 1, body);
+
+        for (const vector<int>& list : improved) {
+            for (int v : list) {
+                int b = dist[v].load(memory_order_relaxed)/delta;
+                if (pending[v] == b) {
+                    continue;
+                }
+                if (b >= buckets.size()) {
+                    buckets.resize(b + 1);
+                }
+                buckets[b].push_back(v);
+                pending[v] = b;
+            }
+        }
+    };
+
+    for (int i = 0; i < buckets.size(); i++) {
+        vector<int> settled;
+        while (!buckets[i].empty()) {
+            vector<int> frontier;
+            frontier.swap(buckets[i]);
+            int kept = 0;
+            for (int v : frontier) {
+                if (pending[v] == i) {
+                    pending[v] = -1;
+                    frontier[kept++] = v;
+                }
+            }
+            frontier.resize(kept);
+            settled.insert(settled.end(), frontier.begin(), frontier.end());
+            // light edges can land back in this bucket, so repeat until it drains
+            relax(frontier, true);
+        }
+        sort(settled.begin(), settled.end());
+        settled.erase(unique(settled.begin(), settled.end()), settled.end());
+        relax(settled, false);
+    }
+
+    for (int i = 0; i < n; i++) {
+        result[i] = dist[i].load(memory_order_relaxed);
+    }
+    return result;
+}
+
+vector< vector<float> > Isochrone::Polygon(const vector<ReachedNode>& reached, float maxEdge) const {
+    vector< vector<float> > points;
+    points.reserve(reached.size());
+    for (const ReachedNode& r : reached) {
+        const float* p = graph.GetPosition(r.index);
+        points.push_back(vector<float>(p, p + 3));
+    }
+    return ConcaveHull(points, maxEdge);
+}
+
+// ---- concave hull (in the x/z ground plane) ----
+
+struct HullPoint {
+    float x, z;
+    int source;
+};
+
+static float cross(const HullPoint& o, const HullPoint& a, const HullPoint& b) {
+    return (a.x - o.x)*(b.z - o.z) - (a.z - o.z)*(b.x - o.x);
+}
+
+static float length(const HullPoint& a, const HullPoint& b) {
+    return hypot(a.x - b.x, a.z - b.z);
+}
+
+static float segmentDistance(const HullPoint& p, const HullPoint& a, const HullPoint& b) {
+    float dx = b.x - a.x;
+    float dz = b.z - a.z;
+    float len2 = dx*dx + dz*dz;
+    float t = len2 > 0 ? ((p.x - a.x)*dx + (p.z - a.z)*dz)/len2 : 0;
+    t = max(0.0f, min(1.0f, t));
+    return hypot(p.x - (a.x + t*dx), p.z - (a.z + t*dz));
+}
+
+static bool properlyIntersect(const HullPoint& a, const HullPoint& b, const HullPoint& c, const HullPoint& d) {
+    float d1 = cross(a, b, c);
+    float d2 = cross(a, b, d);
+    float d3 = cross(c, d, a);
+    float d4 = cross(c, d, b);
+    return ((d1 > 0 && d2 < 0) || (d1 < 0 && d2 > 0)) && ((d3 > 0 && d4 < 0) || (d3 < 0 && d4 > 0));
+}
+
+static bool inTriangle(const HullPoint& p, const HullPoint& a, const HullPoint& b, const HullPoint& c) {
+    float d1 = cross(a, b, p);
+    float d2 = cross(b, c, p);
+    float d3 = cross(c, a, p);
+    bool negative = d1 < 0 || d2 < 0 || d3 < 0;
+    bool positive = d1 > 0 || d2 > 0 || d3 > 0;
+    return !(negative && positive);
+}
+
+vector< vector<float> > Isochrone::ConcaveHull(const vector< vector<float> >& input, float maxEdge) {
+    vector<HullPoint> points;
+    for (int i = 0; i < input.size(); i++) {
+        points.push_back({input[i][0], input[i][2], i});
+    }
+    sort(points.begin(), points.end(), [](const HullPoint& a, const HullPoint& b) {
+        return a.x < b.x || (a.x == b.x && a.z < b.z);
+    });
+    points.erase(unique(points.begin(), points.end(), [](const HullPoint& a, const HullPoint& b) {
+        return a.x == b.x && a.z == b.z;
+    }), points.end());
+
+    vector<int> hull;
+    int n = points.size();
+    if (n < 3) {
+        for (int i = 0; i < n; i++) {
+            hull.push_back(i);
+        }
+    }
+    else {
+        // Andrew's monotone chain, counter-clockwise
+        vector<int> chain(2*n);
+        int k = 0;
+        for (int i = 0; i < n; i++) {
+            while (k >= 2 && cross(points[chain[k-2]], points[chain[k-1]], points[i]) <= 0) k--;
+            chain[k++] = i;
+        }
+        for (int i = n - 2, lower = k + 1; i >= 0; i--) {
+            while (k >= lower && cross(points[chain[k-2]], points[chain[k-1]], points[i]) <= 0) k--;
+            chain[k++] = i;
+        }
+        hull.assign(chain.begin(), chain.begin() + k - 1);
+    }
+
+    // dig long edges in towards the closest interior point, keeping the
+    // polygon simple and every point inside it
+    vector<bool> onHull(n, false);
+    for (int h : hull) {
+        onHull[h] = true;
+    }
+    bool changed = hull.size() >= 3;
+    while (changed) {
+        changed = false;
+        for (int i = 0; i < hull.size(); i++) {
+            const HullPoint& a = points[hull[i]];
+            const HullPoint& b = points[hull[(i + 1) % hull.size()]];
+            float edge = length(a, b);
+            if (edge <= maxEdge) {
+                continue;
+            }
+
+            int best = -1;
+            float bestDistance = numeric_limits<float>::infinity();
+            for (int p = 0; p < n; p++) {
+                if (onHull[p] || length(a, points[p]) >= edge || length(points[p], b) >= edge) {
+                    continue;
+                }
+                float d = segmentDistance(points[p], a, b);
+                if (d < bestDistance) {
+                    bestDistance = d;
+                    best = p;
+                }
+            }
+            if (best < 0) {
+                continue;
+            }
+
+            const HullPoint& p = points[best];
+            bool valid = true;
+            for (int j = 0; j < hull.size() && valid; j++) {
+                const HullPoint& c = points[hull[j]];
+                const HullPoint& d = points[hull[(j + 1) % hull.size()]];
+                valid = !properlyIntersect(a, p, c, d) && !properlyIntersect(p, b, c, d);
+            }
+            for (int q = 0; q < n && valid; q++) {
+                valid = onHull[q] || q == best || !inTriangle(points[q], a, p, b);
+            }
+            if (!valid) {
+                continue;
+            }
+
+            hull.insert(hull.begin() + i + 1, best);
+            onHull[best] = true;
+            changed = true;
+            i--; // re-check the new edge a-p
+        }
+    }
+
+    vector< vector<float> > polygon;
+    for (int h : hull) {
+        polygon.push_back(input[points[h].source]);
+    }
+    return polygon;
+}
+
+}
@@ -8,6 +8,9 @@
 #include <iostream>
 #include <functional>
 #include <vector>
+#include <algorithm>
+#include <limits>
+#include <unordered_map>
 
 using namespace std;
 
@@ -136,7 +139,7 @@ vector<string> AStar::GetPath(const IGraph* graph, const std::string& from, cons
                 continue;
             }
 
-            const vector<IGraphNode*>& next_steps = path_end_node->GetNeighbors();
+            const vector<IGraphNode*>& next_steps = graph->GetNeighbors(path_end_node);
 
             for(IGraphNode* next : next_steps) {
                 const string next_name = next->GetName();
@@ -150,9 +153,228 @@ vector<string> AStar::GetPath(const IGraph* graph, const std::string& from, cons
             }
         }
     }
+
+    // no path, e.g. a one-way street leads away from the destination
+    return vector<string>();
 }
 
-std::vector<std::string> DepthFirstSearch::GetPath(const IGraph* graph, const std::string& from, const std::string& to) const {
+// Heuristic inflation for queries that used half their deadline without
+// finding a path; the rest of the time goes into tightening that path.
+static const float ANYTIME_WEIGHT = 2.0f;
+// Expansions between clock reads.
+static const int DEADLINE_CHECK = 64;
+
+struct OpenEntry {
+    float priority;
+    float distance;
+    float estimate;
+    const IGraphNode* node;
+};
+
+static bool laterEntry(const OpenEntry& a, const OpenEntry& b) {
+    return a.priority > b.priority;
+}
+
+struct SearchLabel {
+    float distance;
+    const IGraphNode* parent;
+    // expanded at this distance, so no longer on the open list
+    bool closed;
+};
+
+// Label map and heaps kept per thread, so batches and the route service do
+// not grow them from scratch on every query.  A search started while the
+// thread's workspace is taken (e.g. a strategy calling A* from inside its
+// own search) gets a fresh one.
+struct SearchWorkspace {
+    SearchWorkspace() : busy(false) {}
+    unordered_map<const IGraphNode*, SearchLabel> labels;
+    vector<OpenEntry> open;
+    vector<OpenEntry> bounds;
+    bool busy;
+};
+
+class WorkspaceLease {
+public:
+    WorkspaceLease() : workspace(shared.busy ? local : shared) {
+        workspace.busy = true;
+        workspace.labels.clear();
+        workspace.open.clear();
+        workspace.bounds.clear();
+    }
+    ~WorkspaceLease() { workspace.busy = false; }
+    SearchWorkspace& Get() { return workspace; }
+
+private:
+    static thread_local SearchWorkspace shared;
+    SearchWorkspace local;
+    SearchWorkspace& workspace;
+};
+
+thread_local SearchWorkspace WorkspaceLease::shared;
+
+// Reorders open for a new heuristic weight.
+static void reweight(vector<OpenEntry>& open, float weight) {
+    for (OpenEntry& entry : open) {
+        entry.priority = entry.distance + weight*entry.estimate;
+    }
+    make_heap(open.begin(), open.end(), laterEntry);
+}
+
+QueryResult AStar::GetPath(const IGraph* graph, const std::string& from, const std::string& to, const QueryOptions& options) const {
+    const IGraphNode* start_node = graph->GetNode(from);
+    if(!start_node) {
+        throw invalid_argument("'from' node not found in graph: " + from);
+    }
+
+    const IGraphNode* terminal_node = graph->GetNode(to);
+    if(!terminal_node) {
+        throw invalid_argument("'to' node not found in graph: " + to);
+    }
+
+    const float infinity = numeric_limits<float>::infinity();
+    float target = 1 + max(0.0f, options.epsilon);
+    float weight = target;
+    vector<float> terminal = terminal_node->GetPosition();
+
+    // Past this point a search that has not found a path yet is inflated to
+    // ANYTIME_WEIGHT; cancel tokens alone never trigger it.
+    QueryOptions::Clock::time_point escalation = QueryOptions::Clock::time_point::max();
+    if (options.deadline != QueryOptions::Clock::time_point::max() && target < ANYTIME_WEIGHT) {
+        QueryOptions::Clock::time_point now = QueryOptions::Clock::now();
+        escalation = now + (options.deadline - now)/2;
+    }
+
+    WorkspaceLease lease;
+    unordered_map<const IGraphNode*, SearchLabel>& labels = lease.Get().labels;
+    vector<OpenEntry>& open = lease.Get().open;
+    float estimate = heuristic->Calculate(start_node->GetPosition(), terminal);
+    labels[start_node] = {0, NULL, false};
+    open.push_back({weight*estimate, 0, estimate, start_node});
+
+    QueryResult result;
+    QueryStats& stats = result.stats;
+    stats.Pushed(open.size());
+    float incumbent = infinity;
+    bool interrupted = false;
+    bool boundMet = false;
+
+    // Second heap over the same entries keyed on the unweighted f, kept only
+    // once the weight leaves target; stale and closed entries are dropped
+    // lazily from the top.
+    vector<OpenEntry>& bounds = lease.Get().bounds;
+    bool tracking = false;
+    auto track = [&]() {
+        bounds = open;
+        reweight(bounds, 1);
+        tracking = true;
+    };
+    // smallest unweighted f among live open entries: no path can be shorter
+    auto lowerBound = [&]() {
+        while (!bounds.empty()) {
+            const SearchLabel& label = labels[bounds.front().node];
+            if (bounds.front().distance <= label.distance && !label.closed) {
+                return min(incumbent, bounds.front().priority);
+            }
+            pop_heap(bounds.begin(), bounds.end(), laterEntry);
+            bounds.pop_back();
+        }
+        return incumbent;
+    };
+
+    for (int expanded = 0; !open.empty(); expanded++) {
+        if (expanded % DEADLINE_CHECK == 0 && options.HasDeadline()) {
+            if (options.Expired()) {
+                interrupted = true;
+                break;
+            }
+            if (incumbent == infinity && weight < ANYTIME_WEIGHT && QueryOptions::Clock::now() >= escalation) {
+                weight = ANYTIME_WEIGHT;
+                reweight(open, weight);
+                track();
+            }
+        }
+        if (tracking && incumbent < infinity && incumbent <= target*lowerBound()) {
+            boundMet = true;
+            break;
+        }
+
+        pop_heap(open.begin(), open.end(), laterEntry);
+        OpenEntry entry = open.back();
+        open.pop_back();
+        stats.heapPops++;
+        SearchLabel& current = labels[entry.node];
+        if (entry.distance > current.distance || entry.distance + entry.estimate >= incumbent) {
+            continue;
+        }
+        current.closed = true;
+        stats.nodesSettled++;
+
+        if (entry.node == terminal_node) {
+            incumbent = entry.distance;
+            result.path.clear();
+            for (const IGraphNode* node = terminal_node; node; node = labels[node].parent) {
+                result.path.push_back(node->GetName());
+            }
+            reverse(result.path.begin(), result.path.end());
+            if (weight <= target) {
+                // weighted A* finds a path within `weight` of optimal first time
+                boundMet = true;
+                break;
+            }
+            // ARA*-style: keep the open list and search on at the target weight
+            weight = target;
+            reweight(open, weight);
+            continue;
+        }
+
+        vector<float> position = entry.node->GetPosition();
+        for (IGraphNode* next : graph->GetNeighbors(entry.node)) {
+            stats.edgesRelaxed++;
+            vector<float> next_position = next->GetPosition();
+            float distance = entry.distance + cost->Calculate(position, next_position);
+            auto label = labels.find(next);
+            if (label != labels.end() && label->second.distance <= distance) {
+                continue;
+            }
+            labels[next] = {distance, entry.node, false};
+            float next_estimate = heuristic->Calculate(next_position, terminal);
+            open.push_back({distance + weight*next_estimate, distance, next_estimate, next});
+            push_heap(open.begin(), open.end(), laterEntry);
+            stats.Pushed(open.size());
+            if (tracking) {
+                bounds.push_back({distance + next_estimate, distance, next_estimate, next});
+                push_heap(bounds.begin(), bounds.end(), laterEntry);
+            }
+        }
+    }
+
+    if (incumbent == infinity) {
+        result.status = interrupted ? QueryResult::INTERRUPTED : QueryResult::UNREACHABLE;
+        return result;
+    }
+
+    if (!tracking) {
+        track();
+    }
+    float bound = lowerBound();
+    result.length = incumbent;
+    stats.pathLength = incumbent;
+    if (incumbent <= 0) {
+        result.bound = 1;
+    }
+    else {
+        result.bound = bound > 0 ? incumbent/bound : infinity;
+    }
+    if (boundMet) {
+        result.bound = min(result.bound, weight);
+    }
+    result.status = interrupted && result.bound > target ? QueryResult::INTERRUPTED : QueryResult::COMPLETE;
+    return result;
+}
+
+// Breadth-first search for the path with the fewest edges.
+static vector<string> breadthFirst(const IGraph* graph, const std::string& from, const std::string& to, QueryStats& stats) {
     unordered_set<string> visited; // don't check nodes we've already visited
     queue<CandidatePath*> possible_paths; // queue of all paths we're considering in BFS
 
@@ -173,10 +395,12 @@ std::vector<std::string> DepthFirstSearch::GetPath(const IGraph* graph, const st
             new FStack<string>(from),
             0
         ));
+    stats.Pushed(possible_paths.size());
 
     while(!possible_paths.empty()) {
         auto* path = possible_paths.front();
         possible_paths.pop();
+        stats.heapPops++;
 
         const string path_end = path->path->Top();
         // was checked to be in the graph when we added it
@@ -190,8 +414,10 @@ std::vector<std::string> DepthFirstSearch::GetPath(const IGraph* graph, const st
             continue;
         }
 
-        const vector<IGraphNode*> next_steps = path_end_node->GetNeighbors();
+        stats.nodesSettled++;
+        const vector<IGraphNode*> next_steps = graph->GetNeighbors(path_end_node);
         for(IGraphNode* next : next_steps) {
+            stats.edgesRelaxed++;
             const string next_name = next->GetName();
             if(next_name == to) {
                 // we found our goal
@@ -210,9 +436,29 @@ std::vector<std::string> DepthFirstSearch::GetPath(const IGraph* graph, const st
                 possible_paths.push(
                     new CandidatePath(
                         path->path->Push(next_name)));
+                stats.Pushed(possible_paths.size());
             }
         }
     }
+
+    return vector<string>();
+}
+
+std::vector<std::string> DepthFirstSearch::GetPath(const IGraph* graph, const std::string& from, const std::string& to) const {
+    QueryStats stats;
+    return breadthFirst(graph, from, to, stats);
+}
+
+QueryResult DepthFirstSearch::GetPath(const IGraph* graph, const std::string& from, const std::string& to, const QueryOptions& options) const {
+    QueryResult result;
+    result.path = breadthFirst(graph, from, to, result.stats);
+    if (result.path.empty()) {
+        return result;
+    }
+    result.status = QueryResult::COMPLETE;
+    result.length = PathLength(graph, result.path);
+    result.stats.pathLength = result.length;
+    return result;
 }
 
 }
\ No newline at end of file
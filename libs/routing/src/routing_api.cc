@@ -1,18 +1,30 @@
 #include "routing_api.h"
 #include "parsers/osm/osm_graph_factory.h"
 #include "parsers/obj/obj_graph_factory.h"
+#include "snapshot_file.h"
+#include "routing/astar.h"
+#include "routing/depth_first_search.h"
+#include "routing/dijkstra.h"
 
 namespace routing {
 
 RoutingAPI::RoutingAPI() {
     factories.push_back(new OSMGraphFactory());
     factories.push_back(new ObjGraphFactory());
+    factories.push_back(new SnapshotGraphFactory());
+
+    strategies.push_back(new AStar());
+    strategies.push_back(new Dijkstra());
+    strategies.push_back(new DepthFirstSearch());
 }
 
 RoutingAPI::~RoutingAPI() {
     for (int i = 0; i < factories.size(); i++) {
         delete factories[i];
     }
+    for (int i = 0; i < strategies.size(); i++) {
+        delete strategies[i];
+    }
 }
 
 IGraph* RoutingAPI::LoadFromFile(const std::string& file) const {
@@ -30,4 +42,26 @@ void RoutingAPI::AddFactory(const IGraphFactory* factory) {
     factories.push_back(factory);
 }
 
-}
\ No newline at end of file
+void RoutingAPI::AddStrategy(const RoutingStrategy* strategy) {
+    strategies.push_back(strategy);
+}
+
+const RoutingStrategy* RoutingAPI::GetStrategy(const std::string& name) const {
+    for (int i = 0; i < strategies.size(); i++) {
+        if (strategies[i]->GetName() == name) {
+            return strategies[i];
+        }
+    }
+    return NULL;
+}
+
+std::vector<Route> RoutingAPI::GetPaths(const IGraph* graph, std::vector<PathRequest> requests, int threads) const {
+    for (int i = 0; i < requests.size(); i++) {
+        if (!requests[i].strategy) {
+            requests[i].strategy = strategies[0];
+        }
+    }
+    return graph->GetPaths(requests, threads);
+}
+
+}
@@ -0,0 +1,161 @@
+#include "segment_index.h"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <queue>
+
+namespace routing {
+
+SegmentIndex::SegmentIndex(const IGraph* graph) {
+    for (IGraphNode* node : graph->GetNodes()) {
+        std::vector<float> a = node->GetPosition();
+        for (IGraphNode* neighbor : node->GetNeighbors()) {
+            std::vector<float> b = neighbor->GetPosition();
+            Segment segment;
+            segment.from = node;
+            segment.to = neighbor;
+            for (int i = 0; i < 3; i++) {
+                segment.a[i] = i < a.size() ? a[i] : 0;
+                segment.b[i] = i < b.size() ? b[i] : 0;
+            }
+            segments.push_back(segment);
+        }
+    }
+
+    // sort-tile-recursive order: slices by x, then z inside each slice
+    int count = segments.size();
+    int leaves = (count + NODE_SIZE - 1)/NODE_SIZE;
+    int slices = std::ceil(std::sqrt((double)leaves));
+    int sliceSize = slices > 0 ? ((leaves + slices - 1)/slices)*NODE_SIZE : count;
+    auto center = [](const Segment& s, int axis) { return s.a[axis] + s.b[axis]; };
+    std::sort(segments.begin(), segments.end(), [&](const Segment& s1, const Segment& s2) {
+        return center(s1, 0) < center(s2, 0);
+    });
+    for (int begin = 0; begin < count; begin += sliceSize) {
+        int end = std::min(count, begin + sliceSize);
+        std::sort(segments.begin() + begin, segments.begin() + end, [&](const Segment& s1, const Segment& s2) {
+            return center(s1, 2) < center(s2, 2);
+        });
+    }
+
+    levels.push_back(std::vector<Box>(count));
+    for (int i = 0; i < count; i++) {
+        Box& box = levels[0][i];
+        for (int j = 0; j < 3; j++) {
+            box.min[j] = std::min(segments[i].a[j], segments[i].b[j]);
+            box.max[j] = std::max(segments[i].a[j], segments[i].b[j]);
+        }
+    }
+    while (levels.back().size() > NODE_SIZE) {
+        const std::vector<Box>& below = levels.back();
+        std::vector<Box> level((below.size() + NODE_SIZE - 1)/NODE_SIZE);
+        for (int i = 0; i < level.size(); i++) {
+            Box& box = level[i];
+            box = below[i*NODE_SIZE];
+            int end = std::min((int)below.size(), (i + 1)*NODE_SIZE);
+            for (int c = i*NODE_SIZE + 1; c < end; c++) {
+                for (int j = 0; j < 3; j++) {
+                    box.min[j] = std::min(box.min[j], below[c].min[j]);
+                    box.max[j] = std::max(box.max[j], below[c].max[j]);
+                }
+            }
+        }
+        levels.push_back(level);
+    }
+}
+
+float SegmentIndex::boxDistance(const Box& box, const float* p) {
+    float sum = 0;
+    for (int j = 0; j < 3; j++) {
+        float d = std::max(0.0f, std::max(box.min[j] - p[j], p[j] - box.max[j]));
+        sum += d*d;
+    }
+    return sum;
+}
+
+float SegmentIndex::segmentDistance(const Segment& segment, const float* p, float& t) {
+    float ab[3], ap[3];
+    float len2 = 0, dot = 0;
+    for (int j = 0; j < 3; j++) {
+        ab[j] = segment.b[j] - segment.a[j];
+        ap[j] = p[j] - segment.a[j];
+        len2 += ab[j]*ab[j];
+        dot += ab[j]*ap[j];
+    }
+    t = len2 > 0 ? std::max(0.0f, std::min(1.0f, dot/len2)) : 0;
+    float sum = 0;
+    for (int j = 0; j < 3; j++) {
+        float d = ap[j] - t*ab[j];
+        sum += d*d;
+    }
+    return sum;
+}
+
+bool SegmentIndex::Nearest(const std::vector<float>& point, EdgePoint& result) const {
+    if (segments.empty()) {
+        return false;
+    }
+    float p[3];
+    for (int j = 0; j < 3; j++) {
+        p[j] = j < point.size() ? point[j] : 0;
+    }
+
+    // entries are (squared distance, level, index); level -1 is an exact
+    // segment distance, so the first one popped is the nearest segment
+    struct Entry {
+        float distance;
+        int level;
+        int index;
+        bool operator>(const Entry& other) const { return distance > other.distance; }
+    };
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry> > queue;
+    int top = levels.size() - 1;
+    for (int i = 0; i < levels[top].size(); i++) {
+        queue.push({boxDistance(levels[top][i], p), top, i});
+    }
+
+    while (!queue.empty()) {
+        Entry entry = queue.top();
+        queue.pop();
+        if (entry.level < 0) {
+            const Segment& segment = segments[entry.index];
+            float t;
+            float d = segmentDistance(segment, p, t);
+            result.from = segment.from;
+            result.to = segment.to;
+            result.t = t;
+            result.position.resize(3);
+            for (int j = 0; j < 3; j++) {
+                result.position[j] = segment.a[j] + t*(segment.b[j] - segment.a[j]);
+            }
+            result.distance = std::sqrt(d);
+            return true;
+        }
+        if (entry.level == 0) {
+            float t;
+            queue.push({segmentDistance(segments[entry.index], p, t), -1, entry.index});
+            continue;
+        }
+        const std::vector<Box>& below = levels[entry.level - 1];
+        int end = std::min((int)below.size(), (entry.index + 1)*NODE_SIZE);
+        for (int c = entry.index*NODE_SIZE; c < end; c++) {
+            queue.push({boxDistance(below[c], p), entry.level - 1, c});
+        }
+    }
+    return false;
+}
+
+
+MemoryReport SegmentIndex::GetMemoryReport() const {
+    MemoryReport report;
+    report.Add("segments", MemoryReport::Of(segments));
+    report.Add("boxes", MemoryReport::Of(levels));
+    for (const std::vector<Box>& level : levels) {
+        report.Add("boxes", MemoryReport::Of(level));
+    }
+    return report;
+}
+
+}
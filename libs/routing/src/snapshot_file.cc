@@ -0,0 +1,163 @@
+#include "snapshot_file.h"
+#include "impl/simple_graph.h"
+
+#include <cstring>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace routing {
+
+static const char MAGIC[] = "RSNAP001";
+static const int MAGIC_SIZE = 8;
+
+SnapshotWriter::SnapshotWriter(const std::string& file) : file(file), numNodes(0), numEdges(0), lastSource(0) {
+    out = fopen(file.c_str(), "wb");
+    if (!out) {
+        throw std::runtime_error("unable to create snapshot " + file);
+    }
+    int counts[2] = {0, 0};
+    write(MAGIC, MAGIC_SIZE);
+    write(counts, sizeof(counts));
+}
+
+SnapshotWriter::~SnapshotWriter() {
+    if (out) {
+        fclose(out);
+    }
+}
+
+void SnapshotWriter::write(const void* data, size_t size) {
+    if (fwrite(data, 1, size, out) != size) {
+        throw std::runtime_error("unable to write snapshot " + file);
+    }
+}
+
+void SnapshotWriter::AddNode(const std::string& name, float x, float y, float z) {
+    if (numEdges > 0) {
+        throw std::logic_error("snapshot nodes must be added before edges");
+    }
+    float position[3] = {x, y, z};
+    unsigned int length = name.size();
+    write(position, sizeof(position));
+    write(&length, sizeof(length));
+    write(name.data(), length);
+    numNodes++;
+}
+
+void SnapshotWriter::AddEdge(int from, int to) {
+    if (from < lastSource || from >= numNodes || to < 0 || to >= numNodes) {
+        throw std::invalid_argument("snapshot edges must be sorted by source and between added nodes");
+    }
+    if (degree.empty()) {
+        degree.assign(numNodes, 0);
+    }
+    write(&to, sizeof(to));
+    degree[from]++;
+    lastSource = from;
+    numEdges++;
+}
+
+void SnapshotWriter::Finish() {
+    degree.resize(numNodes, 0);
+    int offset = 0;
+    write(&offset, sizeof(offset));
+    for (int i = 0; i < numNodes; i++) {
+        offset += degree[i];
+        write(&offset, sizeof(offset));
+    }
+    int counts[2] = {numNodes, numEdges};
+    fseek(out, MAGIC_SIZE, SEEK_SET);
+    write(counts, sizeof(counts));
+    if (fclose(out) != 0) {
+        out = NULL;
+        throw std::runtime_error("unable to write snapshot " + file);
+    }
+    out = NULL;
+}
+
+void SnapshotFile::Write(const std::string& file, const IGraph* graph) {
+    const std::vector<IGraphNode*>& nodes = graph->GetNodes();
+    std::unordered_map<const IGraphNode*, int> indices;
+    SnapshotWriter writer(file);
+    for (int i = 0; i < nodes.size(); i++) {
+        std::vector<float> pos = nodes[i]->GetPosition();
+        pos.resize(3, 0.0f);
+        writer.AddNode(nodes[i]->GetName(), pos[0], pos[1], pos[2]);
+        indices[nodes[i]] = i;
+    }
+    for (int i = 0; i < nodes.size(); i++) {
+        for (IGraphNode* neighbor : nodes[i]->GetNeighbors()) {
+            auto it = indices.find(neighbor);
+            if (it != indices.end()) {
+                writer.AddEdge(i, it->second);
+            }
+        }
+    }
+    writer.Finish();
+}
+
+IGraph* SnapshotFile::Read(const std::string& file) {
+    FILE* in = fopen(file.c_str(), "rb");
+    if (!in) {
+        throw std::runtime_error("unable to open snapshot " + file);
+    }
+
+    SimpleGraph* graph = new SimpleGraph();
+    std::vector<SimpleGraphNode*> nodes;
+    auto read = [&](void* data, size_t size) {
+        if (fread(data, 1, size, in) != size) {
+            fclose(in);
+            delete graph;
+            throw std::runtime_error("truncated snapshot " + file);
+        }
+    };
+
+    char magic[MAGIC_SIZE];
+    int counts[2];
+    read(magic, MAGIC_SIZE);
+    read(counts, sizeof(counts));
+    if (memcmp(magic, MAGIC, MAGIC_SIZE) != 0 || counts[0] < 0 || counts[1] < 0) {
+        fclose(in);
+        delete graph;
+        throw std::runtime_error("not a graph snapshot: " + file);
+    }
+
+    std::string name;
+    for (int i = 0; i < counts[0]; i++) {
+        float position[3];
+        unsigned int length;
+        read(position, sizeof(position));
+        read(&length, sizeof(length));
+        name.resize(length);
+        read(&name[0], length);
+        SimpleGraphNode* node = new SimpleGraphNode(name, std::vector<float>(position, position + 3));
+        graph->AddNode(node);
+        nodes.push_back(node);
+    }
+
+    std::vector<int> targets(counts[1]);
+    std::vector<int> offsets(counts[0] + 1);
+    read(targets.data(), targets.size()*sizeof(int));
+    read(offsets.data(), offsets.size()*sizeof(int));
+    fclose(in);
+
+    for (int i = 0; i < counts[0]; i++) {
+        for (int e = offsets[i]; e < offsets[i + 1]; e++) {
+            if (e < 0 || e >= counts[1] || targets[e] < 0 || targets[e] >= counts[0]) {
+                delete graph;
+                throw std::runtime_error("corrupt snapshot " + file);
+            }
+            nodes[i]->AddNeighbor(nodes[targets[e]]);
+        }
+    }
+    return graph;
+}
+
+IGraph* SnapshotGraphFactory::Create(const std::string& file) const {
+    if (file.size() < 5 || file.substr(file.size()-5) != ".snap") {
+        return NULL;
+    }
+    return SnapshotFile::Read(file);
+}
+
+}
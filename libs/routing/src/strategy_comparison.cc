@@ -0,0 +1,165 @@
+#include "strategy_comparison.h"
+#include "routing/dijkstra.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <limits>
+#include <random>
+
+namespace routing {
+
+StrategyComparison::StrategyComparison(const IGraph* graph) : graph(graph), reference(Dijkstra::Instance()) {}
+
+StrategyComparison::StrategyComparison(const IGraph* graph, const RoutingStrategy& reference) : graph(graph), reference(reference) {}
+
+void StrategyComparison::AddStrategy(const std::string& name, const RoutingStrategy& strategy, float epsilon, int budgetMs) {
+    Entry entry = {name, &strategy, epsilon, budgetMs};
+    strategies.push_back(entry);
+}
+
+void StrategyComparison::AddStrategies(const RoutingAPI& api) {
+    for (const RoutingStrategy* strategy : api.GetStrategies()) {
+        AddStrategy(strategy->GetName(), *strategy);
+    }
+}
+
+void StrategyComparison::AddPair(const std::vector<float>& src, const std::vector<float>& dest) {
+    Pair pair = {src, dest};
+    pairs.push_back(pair);
+}
+
+void StrategyComparison::AddRandomPairs(int count, unsigned seed) {
+    const std::vector<IGraphNode*>& nodes = graph->GetNodes();
+    if (nodes.size() < 2) {
+        return;
+    }
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<int> pick(0, nodes.size() - 1);
+    for (int i = 0; i < count; i++) {
+        int from = pick(rng);
+        int to = pick(rng);
+        while (to == from) {
+            to = pick(rng);
+        }
+        AddPair(nodes[from]->GetPosition(), nodes[to]->GetPosition());
+    }
+}
+
+StrategyComparison::Sample StrategyComparison::run(const RoutingStrategy& strategy, float epsilon, int budgetMs, int pair) const {
+    typedef std::chrono::steady_clock Clock;
+    QueryOptions options = budgetMs > 0 ? QueryOptions::Within(epsilon, std::chrono::milliseconds(budgetMs)) : QueryOptions::Bounded(epsilon);
+    QueryResult result;
+    Sample sample;
+    Clock::time_point start = Clock::now();
+    sample.path = graph->GetPath(pairs[pair].src, pairs[pair].dest, strategy, options, &result);
+    sample.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    sample.pair = pair;
+    sample.status = result.status;
+    sample.length = result.path.empty() ? std::numeric_limits<float>::infinity() : result.length;
+    sample.nodesSettled = result.stats.nodesSettled;
+    sample.ratio = 1;
+    return sample;
+}
+
+void StrategyComparison::Run() {
+    optimal.clear();
+    for (int i = 0; i < pairs.size(); i++) {
+        optimal.push_back(run(reference, 0, 0, i));
+    }
+
+    for (Entry& entry : strategies) {
+        entry.samples.clear();
+        for (int i = 0; i < pairs.size(); i++) {
+            Sample sample = run(*entry.strategy, entry.epsilon, entry.budgetMs, i);
+            float best = optimal[i].length;
+            if (std::isinf(sample.length)) {
+                sample.ratio = std::isinf(best) ? 1 : std::numeric_limits<float>::infinity();
+            }
+            else if (best > 0) {
+                sample.ratio = sample.length/best;
+            }
+            entry.samples.push_back(sample);
+        }
+    }
+}
+
+StrategyComparison::Summary StrategyComparison::Summarize(int strategy) const {
+    const std::vector<Sample>& samples = strategies[strategy].samples;
+    Summary summary = {(int)samples.size(), 0, 0, 0, 0, 0, 0, 0};
+    std::vector<double> micros;
+    int found = 0;
+    for (const Sample& sample : samples) {
+        micros.push_back(sample.seconds*1e6);
+        summary.meanSettled += sample.nodesSettled;
+        summary.meanMicros += sample.seconds*1e6;
+        if (std::isinf(sample.ratio)) {
+            summary.failures++;
+        }
+        else if (!std::isinf(sample.length)) {
+            summary.meanRatio += sample.ratio;
+            summary.maxRatio = std::max(summary.maxRatio, sample.ratio);
+            found++;
+        }
+    }
+    if (samples.empty()) {
+        return summary;
+    }
+    summary.meanRatio = found ? summary.meanRatio/found : 0;
+    summary.meanSettled /= samples.size();
+    summary.meanMicros /= samples.size();
+    std::sort(micros.begin(), micros.end());
+    summary.p50Micros = micros[(micros.size() - 1)/2];
+    summary.p99Micros = micros[std::min<int>(micros.size() - 1, std::ceil(0.99*micros.size()) - 1)];
+    return summary;
+}
+
+std::vector<int> StrategyComparison::Worst(int strategy, int count) const {
+    const std::vector<Sample>& samples = strategies[strategy].samples;
+    std::vector<int> order(samples.size());
+    for (int i = 0; i < order.size(); i++) {
+        order[i] = i;
+    }
+    std::sort(order.begin(), order.end(), [&samples](int a, int b) {
+        if (samples[a].ratio != samples[b].ratio) {
+            return samples[a].ratio > samples[b].ratio;
+        }
+        return samples[a].seconds > samples[b].seconds;
+    });
+    order.resize(std::min<int>(count, order.size()));
+    return order;
+}
+
+void StrategyComparison::PrintSummary(std::ostream& out) const {
+    std::ios::fmtflags flags = out.flags();
+    std::streamsize precision = out.precision(4);
+    out << std::left << std::setw(16) << "strategy" << std::right
+        << std::setw(8) << "queries" << std::setw(9) << "failed"
+        << std::setw(11) << "mean ratio" << std::setw(11) << "max ratio"
+        << std::setw(13) << "mean settled" << std::setw(12) << "mean us"
+        << std::setw(12) << "p50 us" << std::setw(12) << "p99 us" << std::endl;
+    for (int i = 0; i < strategies.size(); i++) {
+        Summary summary = Summarize(i);
+        out << std::left << std::setw(16) << strategies[i].name << std::right
+            << std::setw(8) << summary.queries << std::setw(9) << summary.failures
+            << std::setw(11) << summary.meanRatio << std::setw(11) << summary.maxRatio
+            << std::setw(13) << summary.meanSettled << std::setw(12) << summary.meanMicros
+            << std::setw(12) << summary.p50Micros << std::setw(12) << summary.p99Micros << std::endl;
+    }
+    out.precision(precision);
+    out.flags(flags);
+}
+
+void StrategyComparison::WriteCsv(std::ostream& out) const {
+    out << "strategy,pair,status,length,optimal,ratio,settled,micros" << std::endl;
+    for (const Entry& entry : strategies) {
+        for (const Sample& sample : entry.samples) {
+            out << entry.name << "," << sample.pair << "," << sample.status << ","
+                << sample.length << "," << optimal[sample.pair].length << "," << sample.ratio << ","
+                << sample.nodesSettled << "," << sample.seconds*1e6 << std::endl;
+        }
+    }
+}
+
+}
@@ -15,9 +15,31 @@ class AstarStrategy : public PathStrategy {
    *
    * @param position Current position
    * @param destination End destination
-   * @param graph Graph/Nodes of the map
+   * @param graph Graph/Nodes of the map, or null while the map is loading;
+   * the path is planned in the background
+   * @param poiTable Precomputed routes; a trip between two of its points of
+   * interest takes the stored shortest path instead of a search
+   * @param epsilon Accept paths up to (1 + epsilon) times the shortest one
+   * @param budgetMs Time budget for the search in milliseconds; when it runs
+   * out the best path found so far is used
    */
   AstarStrategy(Vector3 position, Vector3 destination,
-                const routing::IGraph* graph);
+                std::shared_ptr<const routing::IGraph> graph,
+                std::shared_ptr<const routing::PoiTable> poiTable = nullptr,
+                float epsilon = 0.05f,
+                int budgetMs = 25);
+
+  /**
+   * @brief Get how much longer than the shortest path this path may be
+   *
+   * @return 1 for a proven shortest path, infinity if there is no guarantee
+   */
+  float GetBound() const { return bound; }
+
+ protected:
+  void OnPlanned(const routing::Route& route) { bound = route.result.bound; }
+
+ private:
+  float bound = 1;
 };
 #endif  // ASTAR_STRATEGY_H_
@@ -33,6 +33,14 @@ class BeelineStrategy : public IStrategy {
    */
   bool IsCompleted();
 
+  /**
+   * @brief Time until the destination is reached at the entity's speed
+   *
+   * @param entity Entity to move
+   * @return Seconds
+   */
+  double GetMaxStep(IEntity* entity);
+
  private:
   Vector3 position;
   Vector3 destination;
@@ -21,7 +21,7 @@ class CelebrationDecorator : public IStrategy {
 
 
   /**
-   * @brief Destructor
+   * @brief Destructor, deletes the decorated strategy
    */
   ~CelebrationDecorator();
 
@@ -38,6 +38,15 @@ class CelebrationDecorator : public IStrategy {
    * @return True if complete, false if not complete
    */
   virtual bool IsCompleted();
+
+  /**
+   * @brief The wrapped strategy's step until it completes, then short steps
+   * so the celebration animates smoothly
+   *
+   * @param entity Entity to move
+   * @return Seconds
+   */
+  virtual double GetMaxStep(IEntity* entity);
 };
 
 #endif  // CELEBRATION_DECORATOR_H_
@@ -0,0 +1,52 @@
+#ifndef COMMIT_BUFFER_H_
+#define COMMIT_BUFFER_H_
+
+#include <functional>
+#include <vector>
+
+/**
+ * @class CommitBuffer
+ * @brief Collects the actions entities defer while they are updated in
+ * parallel, to be run on one thread afterwards.
+ *
+ * Each worker fills its own buffer, so pushing needs no lock. Commit merges
+ * the buffers and runs the actions ordered by their key (the id of the
+ * entity that deferred them), then by the order they were pushed in. The
+ * result does not depend on how the entities were split between workers.
+ */
+class CommitBuffer {
+ public:
+  /**
+   * @brief Queue an action
+   * @param order Sort key, the id of the deferring entity
+   * @param action Action to run in the commit phase
+   */
+  void Push(int order, std::function<void()> action) {
+    actions.push_back(Action{order, static_cast<int>(actions.size()),
+                             std::move(action)});
+  }
+
+  /**
+   * @brief Number of queued actions
+   * @return The number of actions pushed since the last commit
+   */
+  int Size() const { return actions.size(); }
+
+  /**
+   * @brief Run and clear the actions of all buffers
+   * @param buffers One buffer per worker
+   * @return Number of actions run
+   */
+  static int Commit(std::vector<CommitBuffer>& buffers);
+
+ private:
+  struct Action {
+    int order;
+    int sequence;
+    std::function<void()> run;
+  };
+
+  std::vector<Action> actions;
+};
+
+#endif  // COMMIT_BUFFER_H_
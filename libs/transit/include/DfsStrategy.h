@@ -15,9 +15,10 @@ class DfsStrategy : public PathStrategy {
    *
    * @param position Current position
    * @param destination End destination
-   * @param graph Graph/Nodes of the map
+   * @param graph Graph/Nodes of the map, or null while the map is loading;
+   * the path is planned in the background
    */
   DfsStrategy(Vector3 position, Vector3 destination,
-              const routing::IGraph* graph);
+              std::shared_ptr<const routing::IGraph> graph);
 };
 #endif  // DFS_STRATEGY_H_
@@ -15,9 +15,13 @@ class DijkstraStrategy : public PathStrategy {
    *
    * @param position Current position
    * @param destination End destination
-   * @param graph Graph/Nodes of the map
+   * @param graph Graph/Nodes of the map, or null while the map is loading;
+   * the path is planned in the background
+   * @param poiTable Precomputed routes; a trip between two of its points of
+   * interest takes the stored shortest path instead of a search
    */
   DijkstraStrategy(Vector3 position, Vector3 destination,
-                   const routing::IGraph* graph);
+                   std::shared_ptr<const routing::IGraph> graph,
+                   std::shared_ptr<const routing::PoiTable> poiTable = nullptr);
 };
 #endif  // DIJKSTRA_STRATEGY_H_
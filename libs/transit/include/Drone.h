@@ -10,6 +10,8 @@
 #include "Weather.h"
 #define GLOBAL_WEATHER Weather::GetInstance()
 
+class TripScheduler;
+
 /**
  * @class Drone
  * @brief Represents a drone in a physical system. Drones move using euler
@@ -20,38 +22,15 @@ class Drone : public IEntity {
   /**
    * @brief Drones are created with a name
    * @param obj JSON object containing the drone's information
+   * @param store Store holding the drone's state
    */
-  Drone(JsonObject& obj);
+  Drone(JsonObject& obj, EntityStore& store);
 
   /**
    * @brief Destructor
    */
   ~Drone();
 
-  /**
-   * @brief Gets the speed of the drone
-   * @return The speed of the drone
-   */
-  float GetSpeed() const { return speed; }
-
-  /**
-   * @brief Gets the position of the drone
-   * @return The position of the drone
-   */
-  Vector3 GetPosition() const { return position; }
-
-  /**
-   * @brief Gets the direction of the drone
-   * @return The direction of the drone
-   */
-  Vector3 GetDirection() const { return direction; }
-
-  /**
-   * @brief Gets the destination of the drone
-   * @return The destination of the drone
-   */
-  Vector3 GetDestination() const { return destination; }
-
   /**
    * @brief Gets the color of the drone
    * @return The color of the drone
@@ -65,47 +44,24 @@ class Drone : public IEntity {
   JsonObject GetDetails() const { return details; }
 
   /**
-   * @brief Gets the availability of the drone
-   * @return The availability of the drone
-   */
-  bool GetAvailability() const { return available; }
-
-  /**
-   * @brief Gets the nearest entity in the scheduler
-   * @param scheduler Vector containing all the entities in the system
+   * @brief Starts a trip: fly to the robot, then deliver it to its
+   * destination with the robot's routing strategy
+   * @param robot The robot to pick up
    */
-  void GetNearestEntity(std::vector<IEntity*> scheduler);
+  void Pickup(IEntity* robot);
 
   /**
    * @brief Updates the drone's position
    * @param dt Delta time
-   * @param scheduler Vector containing all the entities in the system
    */
-  void Update(double dt, std::vector<IEntity*> scheduler);
+  void Update(double dt);
 
   /**
-   * @brief Sets the position of the drone
-   * @param pos_ The new position of the drone
+   * @brief Longest time step the entity can take in one Update without
+   * overshooting its next waypoint
+   * @return Seconds; infinity if any step size is fine
    */
-  void SetPosition(Vector3 pos_) { position = pos_; }
-
-  /**
-   * @brief Sets the direction of the drone
-   * @param dir_ The new direction of the drone
-   */
-  void SetDirection(Vector3 dir_) { direction = dir_; }
-
-  /**
-   * @brief Sets the destination of the drone
-   * @param des_ The new destination of the drone
-   */
-  void SetDestination(Vector3 des_) { destination = des_; }
-
-  /**
-   * @brief Sets the speed of the drone
-   * @param spe_ The new speed of the drone
-   */
-  void SetSpeed(float spe_) { speed = spe_; }
+  double GetMaxStep();
 
   /**
    * @brief Sets the color of the drone
@@ -119,6 +75,13 @@ class Drone : public IEntity {
    */
   void SetPublisher(IPublisher* pub_) { toPublisher = pub_; }
 
+  /**
+   * @brief Sets the scheduler the drone takes trips from, and registers
+   * with it if the drone is idle
+   * @param trips The scheduler; the drone registers again after every trip
+   */
+  void SetTripScheduler(TripScheduler* trips);
+
   /**
    * @brief Rotates the drone
    * @param angle The angle by which the drone should be rotated
@@ -144,15 +107,17 @@ class Drone : public IEntity {
   Drone& operator=(const Drone& drone) = delete;
 
  private:
+  /**
+   * @brief Sends a message to the drone's subscribers once the update is
+   * committed
+   * @param message The message
+   */
+  void Publish(const std::string& message);
+
   JsonObject details;
-  Vector3 position;
-  Vector3 direction;
   std::string color = "None";  // None means default color
   float jumpHeight = 0;
   bool goUp = true;  // jump helper
-  Vector3 destination;
-  float speed;
-  bool available;
   bool pickedUp;
   bool run = true;
   bool emergency = false;
@@ -160,7 +125,7 @@ class Drone : public IEntity {
   IStrategy* toRobot = nullptr;
   IStrategy* toFinalDestination = nullptr;
   IPublisher* toPublisher = nullptr;
-  std::string name = details["name"];
+  TripScheduler* trips = nullptr;
   std::string robotName = "NULL";
 };
 
@@ -19,10 +19,11 @@ class DroneFactory : public IEntityFactory {
   /**
    * @brief Creates entity using the given JSON object, if possible.
    * @param entity - JsonObject to be used to create the new entity.
+   * @param store - Store that will hold the entity's state.
    * @return Entity that was created if it was created successfully, or a
    *nullpointer if creation failed.
    **/
-  IEntity* CreateEntity(JsonObject& entity);
+  IEntity* CreateEntity(JsonObject& entity, EntityStore& store);
 };
 
 #endif
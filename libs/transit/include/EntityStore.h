@@ -0,0 +1,136 @@
+#ifndef ENTITY_STORE_H_
+#define ENTITY_STORE_H_
+
+#include <cstdint>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "math/vector3.h"
+
+/**
+ * @brief What an entity is, stored next to its hot state so loops over the
+ * store can filter without asking the entity.
+ */
+enum class EntityKind : uint8_t { DRONE, ROBOT, HUMAN, SATELLITE, WEATHER };
+
+/**
+ * @brief Where an entity is in its life; robots become DELIVERED once a drone
+ * drops them off, which makes them fair game for the tornado.
+ */
+enum class EntityStatus : uint8_t { NONE, DELIVERED };
+
+/**
+ * @class EntityStore
+ * @brief Holds the hot state of every entity of a simulation in contiguous
+ * component arrays, one slot per entity.
+ *
+ * Slots are dense: removing an entity moves the last slot into its place, so
+ * a loop over [0, Size()) touches every live entity and nothing else.
+ * Entities keep a stable Handle instead, which the store maps to their
+ * current slot. Component references are invalidated by the next Add.
+ */
+class EntityStore {
+ public:
+  /** @brief Stable reference to a slot, reused after Remove */
+  typedef int Handle;
+
+  /** @brief State flag: the entity can be assigned a trip */
+  static const uint8_t AVAILABLE = 1;
+
+  /**
+   * @brief Allocates a slot with zeroed components and a speed factor of 1
+   * @param id Entity id, see IEntity::GetId
+   * @param kind What the entity is
+   * @return Handle of the new slot
+   */
+  Handle Add(int id, EntityKind kind);
+
+  /**
+   * @brief Frees a slot, moving the last slot into its place
+   * @param handle Handle returned by Add
+   */
+  void Remove(Handle handle);
+
+  /**
+   * @brief Number of live entities
+   * @return The number of slots in use
+   */
+  int Size() const { return ids.size(); }
+
+  /**
+   * @brief Current slot of a handle
+   * @param handle Handle returned by Add
+   * @return Index into the component arrays
+   */
+  int SlotOf(Handle handle) const { return slots[handle]; }
+
+  Vector3& Position(Handle handle) { return positions[slots[handle]]; }
+  const Vector3& Position(Handle handle) const {
+    return positions[slots[handle]];
+  }
+  Vector3& Direction(Handle handle) { return directions[slots[handle]]; }
+  const Vector3& Direction(Handle handle) const {
+    return directions[slots[handle]];
+  }
+  Vector3& Destination(Handle handle) { return destinations[slots[handle]]; }
+  const Vector3& Destination(Handle handle) const {
+    return destinations[slots[handle]];
+  }
+  float& Speed(Handle handle) { return speeds[slots[handle]]; }
+  float Speed(Handle handle) const { return speeds[slots[handle]]; }
+  float& SpeedFactor(Handle handle) { return speedFactors[slots[handle]]; }
+  float SpeedFactor(Handle handle) const {
+    return speedFactors[slots[handle]];
+  }
+  uint8_t& State(Handle handle) { return states[slots[handle]]; }
+  uint8_t State(Handle handle) const { return states[slots[handle]]; }
+  EntityKind Kind(Handle handle) const { return kinds[slots[handle]]; }
+  EntityStatus& Status(Handle handle) { return statuses[slots[handle]]; }
+  EntityStatus Status(Handle handle) const {
+    return statuses[slots[handle]];
+  }
+
+  /**
+   * @brief Shared copy of a name, so entities hold a pointer instead of a
+   * string of their own
+   * @param name The name
+   * @return The copy; equal names give the same pointer, which stays valid
+   * as long as the store
+   */
+  const std::string* Intern(const std::string& name) {
+    return &*names.insert(name).first;
+  }
+
+  /** @name Component arrays, indexed by slot */
+  ///@{
+  std::vector<Vector3>& GetPositions() { return positions; }
+  std::vector<Vector3>& GetDirections() { return directions; }
+  std::vector<Vector3>& GetDestinations() { return destinations; }
+  std::vector<float>& GetSpeeds() { return speeds; }
+  std::vector<float>& GetSpeedFactors() { return speedFactors; }
+  std::vector<uint8_t>& GetStates() { return states; }
+  std::vector<EntityStatus>& GetStatuses() { return statuses; }
+  const std::vector<EntityKind>& GetKinds() const { return kinds; }
+  const std::vector<int>& GetIds() const { return ids; }
+  ///@}
+
+ private:
+  std::vector<Vector3> positions;
+  std::vector<Vector3> directions;
+  std::vector<Vector3> destinations;
+  std::vector<float> speeds;
+  // scales speeds, 1 unless the weather slows or hastens the entity
+  std::vector<float> speedFactors;
+  std::vector<uint8_t> states;
+  std::vector<EntityStatus> statuses;
+  std::vector<EntityKind> kinds;
+  std::vector<int> ids;
+  // handle of the entity in each slot, and slot of each handle (-1 if free)
+  std::vector<Handle> handles;
+  std::vector<int> slots;
+  std::vector<Handle> freeHandles;
+  std::unordered_set<std::string> names;
+};
+
+#endif  // ENTITY_STORE_H_
@@ -13,38 +13,15 @@ class Human : public IEntity {
   /**
    * @brief Constructor
    * @param obj JSON object containing the human's information
+   * @param store Store holding the human's state
    */
-  Human(JsonObject& obj);
+  Human(JsonObject& obj, EntityStore& store);
 
   /**
    * @brief Destructor
    */
   ~Human();
 
-  /**
-   * @brief Gets the speed of the human
-   * @return The speed of the human
-   */
-  float GetSpeed() const { return speed; }
-
-  /**
-   * @brief Gets the position of the human
-   * @return The position of the human
-   */
-  Vector3 GetPosition() const { return position; }
-
-  /**
-   * @brief Gets the direction of the human
-   * @return The direction of the human
-   */
-  Vector3 GetDirection() const { return direction; }
-
-  /**
-   * @brief Gets the destination of the human
-   * @return The destination of the human
-   */
-  Vector3 GetDestination() const { return destination; }
-
   /**
    * @brief Gets the information of the human
    * @return The information of the human
@@ -54,33 +31,18 @@ class Human : public IEntity {
   /**
    * @brief Updates the human's position
    * @param dt Delta time
-   * @param scheduler Vector containing all the entities in the system
-   */
-  void Update(double dt, std::vector<IEntity*> scheduler);
-
-  /**
-   * @brief Sets the position of the human
-   * @param pos_ The new position of the human
-   */
-  void SetPosition(Vector3 pos_) { position = pos_; }
-
-  /**
-   * @brief Sets the direction of the human
-   * @param dir_ The new direction of the human
-   */
-  void SetDirection(Vector3 dir_) { direction = dir_; }
-
-  /**
-   * @brief Sets the destination of the human
-   * @param des_ The new destination of the human
    */
-  void SetDestination(Vector3 des_) { destination = des_; }
+  void Update(double dt);
 
   /**
-   * @brief Sets the speed of the human
-   * @param spe_ The new speed of the human
+   * @brief Longest time step the entity can take in one Update without
+   * overshooting its next waypoint
+   * @return Seconds; infinity if any step size is fine
    */
-  void SetSpeed(float spe_) { speed = spe_; }
+  double GetMaxStep() {
+    return toDestination ? toDestination->GetMaxStep(this)
+                         : IEntity::GetMaxStep();
+  }
 
   /**
    * @brief Generates a new random destination for the human
@@ -90,10 +52,6 @@ class Human : public IEntity {
 
  private:
   JsonObject details;
-  Vector3 position;
-  Vector3 direction;
-  Vector3 destination;
-  float speed;
   IStrategy* toDestination = nullptr;
 };
 
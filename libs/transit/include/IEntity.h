@@ -1,9 +1,16 @@
 #ifndef ENTITY_H_
 #define ENTITY_H_
 
+#include <functional>
+#include <limits>
+#include <memory>
+#include <random>
 #include <vector>
 
+#include "CommitBuffer.h"
+#include "EntityStore.h"
 #include "graph.h"
+#include "poi_table.h"
 #include "math/vector3.h"
 #include "util/json.h"
 
@@ -11,6 +18,8 @@
 
 using namespace routing;
 
+class TripScheduler;
+
 /**
  * @class IEntity
  * @brief Represents an entity in a physical system.
@@ -19,22 +28,35 @@ using namespace routing;
  * and details. It also has a speed, which determines how fast the entity moves
  * in the physical system. Subclasses of IEntity can override the `Update`
  * function to implement their own movement behavior.
+ *
+ * Position, direction, destination, speed and availability live in an
+ * EntityStore slot; the entity is a view over that slot, so code that has to
+ * visit every entity can loop over the store's arrays instead.
  */
 class IEntity {
  public:
   /**
-   * @brief Constructor that assigns a unique ID to the entity.
+   * @brief Constructor that assigns a unique ID to the entity and a slot in
+   * the store.
+   * @param store Store holding the entity's state, must outlive the entity
+   * @param kind What the entity is
    */
-  IEntity() {
+  IEntity(EntityStore& store, EntityKind kind)
+      : store(&store), name(store.Intern("")) {
     static int currentId = 0;
     id = currentId;
     currentId++;
+    handle = store.Add(id, kind);
+    generator.seed(id + 1);
   }
 
   /**
-   * @brief Virtual destructor for IEntity.
+   * @brief Virtual destructor for IEntity, frees the store slot.
    */
-  virtual ~IEntity() { delete graph; }
+  virtual ~IEntity() { store->Remove(handle); }
+
+  IEntity(const IEntity& entity) = delete;
+  IEntity& operator=(const IEntity& entity) = delete;
 
   /**
    * @brief Gets the ID of the entity.
@@ -42,26 +64,51 @@ class IEntity {
    */
   virtual int GetId() const { return id; }
 
+  /**
+   * @brief Gets what the entity is.
+   * @return The kind of the entity.
+   */
+  EntityKind GetKind() const { return store->Kind(handle); }
+
+  /**
+   * @brief Gets the name the entity was created with.
+   * @return The name, empty if it had none.
+   */
+  const std::string& GetName() const { return *name; }
+
+  /**
+   * @brief Gets where the entity is in its life.
+   * @return The status of the entity.
+   */
+  EntityStatus GetStatus() const { return store->Status(handle); }
+
+  /**
+   * @brief Sets where the entity is in its life.
+   * @param status The new status.
+   */
+  void SetStatus(EntityStatus status) { store->Status(handle) = status; }
+
   /**
    * @brief Gets the position of the entity.
    * @return The position of the entity.
    */
-  virtual Vector3 GetPosition() const = 0;
+  Vector3 GetPosition() const { return store->Position(handle); }
 
   /**
    * @brief Gets the direction of the entity.
    * @return The direction of the entity.
    */
-  virtual Vector3 GetDirection() const = 0;
+  Vector3 GetDirection() const { return store->Direction(handle); }
 
   /**
    * @brief Gets the destination of the entity.
    * @return The destination of the entity.
    */
-  virtual Vector3 GetDestination() const = 0;
+  Vector3 GetDestination() const { return store->Destination(handle); }
 
   /**
-   * @brief Gets the details of the entity.
+   * @brief Gets the details of the entity, as sent to the view. This copies
+   * JSON; the simulation itself uses the typed getters.
    * @return The details of the entity.
    */
   virtual JsonObject GetDetails() const = 0;
@@ -73,16 +120,20 @@ class IEntity {
   virtual std::string GetColor() const { return "None"; }
 
   /**
-   * @brief Gets the speed of the entity.
+   * @brief Gets the speed of the entity, scaled by its speed factor.
    * @return The speed of the entity.
    */
-  virtual float GetSpeed() const = 0;
+  float GetSpeed() const {
+    return store->Speed(handle) * store->SpeedFactor(handle);
+  }
 
   /**
    * @brief Gets the availability of the entity.
    * @return The availability of the entity.
    */
-  virtual bool GetAvailability() const {}
+  bool GetAvailability() const {
+    return store->State(handle) & EntityStore::AVAILABLE;
+  }
 
   /**
    * @brief Gets the Strategy Name
@@ -100,44 +151,83 @@ class IEntity {
    * @brief Sets the availability of the entity.
    * @param choice The desired availability of the entity.
    */
-  virtual void SetAvailability(bool choice) {}
+  void SetAvailability(bool choice) {
+    if (choice) {
+      store->State(handle) |= EntityStore::AVAILABLE;
+    } else {
+      store->State(handle) &= ~EntityStore::AVAILABLE;
+    }
+  }
 
   /**
    * @brief Updates the entity's position in the physical system.
    * @param dt The time step of the update.
-   * @param scheduler The list of all entities in the system.
    */
-  virtual void Update(double dt, std::vector<IEntity*> scheduler) {}
+  virtual void Update(double dt) {}
+
+  /**
+   * @brief Longest time step the entity can take in one Update without
+   * overshooting its next waypoint
+   * @return Seconds; infinity if any step size is fine
+   */
+  virtual double GetMaxStep() {
+    return std::numeric_limits<double>::infinity();
+  }
+
+  /**
+   * @brief Sets where Defer queues actions during an Update.
+   * @param commits Buffer of the worker running the Update, or nullptr to
+   * run deferred actions at once.
+   */
+  void SetCommitBuffer(CommitBuffer* commits) { this->commits = commits; }
 
   /**
    * @brief Sets the graph object used by the entity in the simulation.
+   *
+   * The graph is shared with the rest of the process and is never deleted
+   * by the entity; holding the handle keeps that map version alive.
    * @param graph The IGraph object to be used.
    */
-  void SetGraph(const IGraph* graph) { this->graph = graph; }
+  void SetGraph(std::shared_ptr<const IGraph> graph) { this->graph = graph; }
+
+  /**
+   * @brief Sets the precomputed routes between points of interest on the
+   * current graph, used instead of a search for trips between two of them.
+   * @param poiTable The table, or null if the map has none.
+   */
+  void SetPoiTable(std::shared_ptr<const routing::PoiTable> poiTable) {
+    this->poiTable = poiTable;
+  }
 
   /**
    * @brief Sets the position of the entity.
    * @param pos_ The desired position of the entity.
    */
-  virtual void SetPosition(Vector3 pos_) {}
+  void SetPosition(Vector3 pos_) { store->Position(handle) = pos_; }
 
   /**
    *@brief Sets the direction of the entity.
    *@param dir_ The new direction of the entity.
    */
-  virtual void SetDirection(Vector3 dir_) {}
+  void SetDirection(Vector3 dir_) { store->Direction(handle) = dir_; }
 
   /**
    *@brief Sets the destination of the entity.
    *@param des_ The new destination of the entity.
    */
-  virtual void SetDestination(Vector3 des_) {}
+  void SetDestination(Vector3 des_) { store->Destination(handle) = des_; }
 
   /**
    * @brief Sets the speed of the entity
    * @param spe_ The new speed of the entity
    */
-  virtual void SetSpeed(float spe_) {}
+  void SetSpeed(float spe_) { store->Speed(handle) = spe_; }
+
+  /**
+   * @brief Sets what the speed of the entity is scaled by, see Weather
+   * @param factor The new factor, 1 for the speed as set
+   */
+  void SetSpeedFactor(float factor) { store->SpeedFactor(handle) = factor; }
 
   /**
    * @brief Sets the color of the drone
@@ -151,6 +241,12 @@ class IEntity {
    */
   virtual void SetPublisher(IPublisher* pub_) {}
 
+  /**
+   * @brief Sets the scheduler the entity takes trips from
+   * @param trips The scheduler, not owned
+   */
+  virtual void SetTripScheduler(TripScheduler* trips) {}
+
   /**
    * @brief Rotates the entity
    * @param angle The angle to rotate the entity by.
@@ -167,17 +263,56 @@ class IEntity {
    * @brief Generates a random float between the given
    *                        minimum and maximum values.
    *
+   * Every entity draws from its own generator, seeded by its id, so the
+   * values do not depend on the order entities are updated in.
+   *
    * @param Min The minimum value of the range.
    * @param Max The maximum value of the range.
    * @return The random float between the minimum and maximum values.
    */
   virtual float Random(float Min, float Max) {
-    return ((float(rand()) / float(RAND_MAX)) * (Max - Min)) + Min;
+    return std::uniform_real_distribution<float>(Min, Max)(generator);
   }
 
  protected:
+  /**
+   * @brief Sets name, position, direction and speed from the "name",
+   * "position", "direction" and "speed" fields of an entity description.
+   * @param obj The entity description.
+   */
+  void Init(JsonObject& obj) {
+    if (obj.Contains("name")) {
+      name = store->Intern(obj["name"]);
+    }
+    JsonArray pos(obj["position"]);
+    SetPosition({pos[0], pos[1], pos[2]});
+    JsonArray dir(obj["direction"]);
+    SetDirection({dir[0], dir[1], dir[2]});
+    SetSpeed(obj["speed"]);
+  }
+
+  /**
+   * @brief Runs an action that touches other entities or the controller.
+   * While the model updates entities in parallel such actions are queued and
+   * run one at a time in its commit phase, after every entity has moved.
+   * @param action The action.
+   */
+  void Defer(std::function<void()> action) {
+    if (commits) {
+      commits->Push(id, std::move(action));
+    } else {
+      action();
+    }
+  }
+
   int id;
-  const IGraph* graph;
+  CommitBuffer* commits = nullptr;
+  EntityStore* store;
+  EntityStore::Handle handle;
+  const std::string* name;  // interned in the store
+  std::shared_ptr<const IGraph> graph;
+  std::shared_ptr<const routing::PoiTable> poiTable;
+  std::default_random_engine generator;
 };
 
 #endif
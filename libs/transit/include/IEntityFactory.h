@@ -17,10 +17,11 @@ class IEntityFactory {
   /**
    * @brief Creates entity using the given JSON object, if possible.
    * @param entity - JsonObject to be used to create the new entity.
+   * @param store - Store that will hold the entity's state.
    * @return Entity that was created if it was created successfully, or a
    *nullpointer if creation failed.
    **/
-  virtual IEntity* CreateEntity(JsonObject& entity) = 0;
+  virtual IEntity* CreateEntity(JsonObject& entity, EntityStore& store) = 0;
 };
 
 #endif
@@ -1,6 +1,8 @@
 #ifndef I_STRATEGY_H_
 #define I_STRATEGY_H_
 
+#include <limits>
+
 #include "IEntity.h"
 
 /**
@@ -8,6 +10,11 @@
  */
 class IStrategy {
  public:
+  /**
+   * @brief Virtual destructor, strategies are deleted through this interface
+   */
+  virtual ~IStrategy() {}
+
  /**
   * @brief Move toward next position
   * @param entity Entity to move
@@ -20,6 +27,16 @@ class IStrategy {
    * @return True if complete, false if not complete 
    */
   virtual bool IsCompleted() = 0;
+
+  /**
+   * @brief Longest time step one Move can take without overshooting the
+   * point the entity is heading for
+   * @param entity Entity to move
+   * @return Seconds; infinity if any step size is fine
+   */
+  virtual double GetMaxStep(IEntity* entity) {
+    return std::numeric_limits<double>::infinity();
+  }
 };
 
 #endif
@@ -16,11 +16,6 @@ class JumpDecorator : public CelebrationDecorator {
    */
   JumpDecorator(IStrategy* strategy) : CelebrationDecorator(strategy) {}
 
-  /**
-   * @brief JumpDecorator Destructor
-   */
-  ~JumpDecorator();
-
   /**
    * @brief Move the entity with the jump behavior for 4 seconds.
    * 
@@ -1,16 +1,60 @@
 #ifndef PATH_STRATEGY_H_
 #define PATH_STRATEGY_H_
 
+#include <future>
+#include <memory>
+
 #include "IStrategy.h"
+#include "poi_table.h"
+#include "route_service.h"
 
 /**
  * @brief this class inherits from the IStrategy class and is represents
- * a movement strategy where the entity simply moves along the given path
+ * a movement strategy where the entity simply moves along the given path.
+ * The path can also be planned in the background, in which case the entity
+ * stays where it is until the route is ready.
  */
 class PathStrategy : public IStrategy {
  protected:
   std::vector<std::vector<float>> path;
   int index;
+  /** @brief Route being computed, valid while planning */
+  std::future<routing::Route> planned;
+
+  /**
+   * @brief Queue a route query on the shared RouteService and wait in the
+   * planning state until it is done
+   *
+   * @param graph Graph to route on
+   * @param position Current position
+   * @param destination End destination
+   * @param strategy Routing algorithm, must outlive the query
+   * @param epsilon Accept paths up to (1 + epsilon) times the shortest one
+   * @param budgetMs Time budget for the search in milliseconds, 0 for none
+   */
+  void Plan(std::shared_ptr<const routing::IGraph> graph, Vector3 position,
+            Vector3 destination, const routing::RoutingStrategy& strategy,
+            float epsilon = 0, int budgetMs = 0);
+
+  /**
+   * @brief Take the route from a table of precomputed routes instead of
+   * planning one, if both ends are points of interest in it
+   *
+   * @param table Precomputed routes, may be null
+   * @param position Current position
+   * @param destination End destination
+   * @return True if the path was set from the table
+   */
+  bool Lookup(const routing::PoiTable* table, Vector3 position,
+              Vector3 destination);
+
+  /**
+   * @brief Called once when the planned route arrives, before the path is
+   * followed
+   *
+   * @param route The finished query
+   */
+  virtual void OnPlanned(const routing::Route& route) {}
 
  public:
   /**
@@ -35,6 +79,22 @@ class PathStrategy : public IStrategy {
    * @return True if complete, false if not complete
    */
   virtual bool IsCompleted();
+
+  /**
+   * @brief Check if the route is still being computed
+   *
+   * @return True while planning; picks the route up once it is ready
+   */
+  bool IsPlanning();
+
+  /**
+   * @brief Time until the next point of the path is reached at the entity's
+   * speed
+   *
+   * @param entity Entity to move
+   * @return Seconds; infinity while planning or once completed
+   */
+  virtual double GetMaxStep(IEntity* entity);
 };
 
 #endif  // PATH_STRATEGY_H_
@@ -19,8 +19,9 @@ class Robot : public IEntity {
   /**
    * @brief Constructor
    * @param obj JSON object containing the robot's information
+   * @param store Store holding the robot's state
    */
-  Robot(JsonObject& obj);
+  Robot(JsonObject& obj, EntityStore& store);
 
   /**
    * @brief Destructor
@@ -28,41 +29,12 @@ class Robot : public IEntity {
   ~Robot() override = default;
 
   /**
-   * @brief Gets the robot's position
-   * @return The robot's position
-   */
-  Vector3 GetPosition() const { return position; }
-
-  /**
-   * @brief Gets the robot's direction
-   * @return The robot's direction
-   */
-  Vector3 GetDirection() const { return direction; }
-
-  /**
-   * @brief Gets the robot's destination
-   * @return The robot's destination
-   */
-  Vector3 GetDestination() const { return destination; }
-
-  /**
-   * @brief Gets the robot's availability
-   * @return The robot's availability
-   */
-  bool GetAvailability() const { return available; }
-
-  /**
-   * @brief Gets the robot's details
+   * @brief Gets the robot's details, with its status as "delete" once
+   * delivered and "NULL" before
    * @return The robot's details
    */
   JsonObject GetDetails() const override;
 
-  /**
-   * @brief Gets the robot's speed
-   * @return The robot's speed
-   */
-  float GetSpeed() const { return speed; }
-
   /**
    * @brief Get the Strategy Name
    * @return Streategy name
@@ -76,48 +48,14 @@ class Robot : public IEntity {
    */
   void SetStrategyName(std::string stratName_) { stratName = stratName_; }
 
-  /**
-   * @brief Sets the robot's availability
-   * @param choice The new availability of the robot
-   */
-  void SetAvailability(bool choice);
-
-  /**
-   * @brief Sets the robot's position
-   * @param pos_ The new position of the robot
-   */
-  void SetPosition(Vector3 pos_) { position = pos_; }
-
-  /**
-   * @brief Sets the robot's direction
-   * @param dir_ The new direction of the robot
-   */
-  void SetDirection(Vector3 dir_) { direction = dir_; }
-
-  /**
-   * @brief Sets the robot's destination
-   * @param des_ The new destination of the robot
-   */
-  void SetDestination(Vector3 des_) { destination = des_; }
-
   /**
    * @brief Rotates the robot
    * @param angle The angle by which the robot should be rotated
    */
   void Rotate(double angle);
 
-  /**
-   * @brief Makes the robot available for deletion
-   */
-  void AvailableToDelete() { details["status"] = "delete"; }
-
  private:
   JsonObject details;
-  Vector3 position;
-  Vector3 direction;
-  Vector3 destination;
-  float speed;
-  bool available;
   std::string stratName;
 };
 
@@ -13,37 +13,14 @@ class Satellite : public IEntity {
   /**
    * @brief Constructor
    * @param obj JSON object containing the satellite's information
+   * @param store Store holding the satellite's state
    */
-  Satellite(JsonObject& obj);
+  Satellite(JsonObject& obj, EntityStore& store);
 
   /**
    * @brief Destructor
    */
   ~Satellite();
-  /**
-   * @brief Gets the speed of the satellite
-   * @return The speed of the satellite
-   */
-  float GetSpeed() const { return speed; }
-
-  /**
-   * @brief Gets the position of the satellite
-   * @return The position of the satellite
-   */
-  Vector3 GetPosition() const { return position; }
-
-  /**
-   * @brief Gets the direction of the satellite
-   * @return The direction of the satellite
-   */
-  Vector3 GetDirection() const { return direction; }
-
-  /**
-   * @brief Gets the destination of the satellite
-   * @return The destination of the satellite
-   */
-  Vector3 GetDestination() const { return destination; }
-
   /**
    * @brief Gets the information of the satellite
    * @return The information of the satellite
@@ -53,27 +30,18 @@ class Satellite : public IEntity {
   /**
    * @brief Updates the satellite's position
    * @param dt Delta time
-   * @param scheduler Vector containing all the entities in the system
-   */
-  void Update(double dt, std::vector<IEntity*> scheduler);
-
-  /**
-   * @brief Sets the position of the satellite
-   * @param pos_ The new position of the satellite
-   */
-  void SetPosition(Vector3 pos_) { position = pos_; }
-
-  /**
-   * @brief Sets the direction of the satellite
-   * @param dir_ The new direction of the satellite
    */
-  void SetDirection(Vector3 dir_) { direction = dir_; }
+  void Update(double dt);
 
   /**
-   * @brief Sets the destination of the satellite
-   * @param des_ The new destination of the satellite
+   * @brief Longest time step the entity can take in one Update without
+   * overshooting its next waypoint
+   * @return Seconds; infinity if any step size is fine
    */
-  void SetDestination(Vector3 des_) { destination = des_; }
+  double GetMaxStep() {
+    return toDestination ? toDestination->GetMaxStep(this)
+                         : IEntity::GetMaxStep();
+  }
 
   /**
    * @brief Generates a new random destination for the satallite
@@ -89,10 +57,6 @@ class Satellite : public IEntity {
 
  private:
   JsonObject details;
-  Vector3 position;
-  Vector3 direction;
-  Vector3 destination;
-  float speed;
   IStrategy* toDestination = nullptr;
 };
 
@@ -0,0 +1,136 @@
+#ifndef SIMULATION_LOOP_H_
+#define SIMULATION_LOOP_H_
+
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+#include "SimulationModel.h"
+
+/**
+ * @brief Steps a SimulationModel at a fixed rate on its own thread, whether
+ * or not any client is connected or polling.
+ *
+ * Every tick advances simulated time by speed / rate seconds. Ticks that
+ * fall behind the wall clock are caught up, but never more than
+ * MAX_CATCH_UP at once, so a stall does not turn into a burst. Anything that
+ * touches the model from another thread must hold Lock().
+ *
+ * A tick is run as rounds of at most MAX_ROUND simulated seconds and stops
+ * early once it has used up its wall-clock budget, so at high speeds the
+ * simulation falls behind real time instead of stalling the server.
+ */
+class SimulationLoop {
+ public:
+  /** @brief Most overdue ticks run back to back before the rest are dropped */
+  static const int MAX_CATCH_UP = 5;
+  /** @brief Longest model update run at once, in simulated seconds */
+  static constexpr double MAX_ROUND = 0.1;
+
+  /**
+   * @brief Counters describing how the loop has kept up
+   */
+  struct Stats {
+    /** @brief Ticks run since Start */
+    long ticks = 0;
+    /** @brief Model updates run since Start */
+    long rounds = 0;
+    /** @brief Entity sub-steps taken since Start */
+    long steps = 0;
+    /** @brief Entity sub-steps taken by the last tick */
+    int lastSteps = 0;
+    /** @brief Ticks that ran out of budget before covering their time */
+    long overruns = 0;
+    /** @brief Simulated seconds since Start */
+    double simTime = 0;
+    /** @brief Simulated seconds skipped by ticks that overran */
+    double droppedTime = 0;
+    /** @brief Wall-clock seconds taken by the last tick */
+    double lastTickSeconds = 0;
+    /** @brief Wall-clock seconds taken by the slowest tick */
+    double maxTickSeconds = 0;
+  };
+
+  /**
+   * @brief Construct a stopped loop
+   *
+   * @param model Model to step, must outlive the loop
+   * @param rate Ticks per wall-clock second
+   */
+  SimulationLoop(SimulationModel& model, double rate = 30);
+
+  /**
+   * @brief Stops the loop
+   */
+  ~SimulationLoop();
+
+  /**
+   * @brief Start ticking
+   *
+   * @param onTick Called on the loop thread after every tick, with the model
+   * still locked, e.g. to publish the new state
+   */
+  void Start(std::function<void()> onTick);
+
+  /**
+   * @brief Finish the current tick and join the loop thread
+   */
+  void Stop();
+
+  /**
+   * @brief Lock the model against the loop
+   *
+   * @return The held lock
+   */
+  std::unique_lock<std::mutex> Lock() {
+    return std::unique_lock<std::mutex>(mutex);
+  }
+
+  /**
+   * @brief Set how many simulated seconds pass per wall-clock second
+   *
+   * @param speed Speed multiplier, 1 for real time
+   */
+  void SetSpeed(double speed) { this->speed = speed; }
+  double GetSpeed() const { return speed; }
+  double GetRate() const { return rate; }
+
+  /**
+   * @brief Set how long a tick may spend updating the model
+   *
+   * @param seconds Wall-clock seconds; the first round of a tick always runs
+   */
+  void SetBudget(double seconds) { budget = seconds; }
+  double GetBudget() const { return budget; }
+
+  /**
+   * @brief Counters since Start
+   *
+   * @return A consistent copy
+   */
+  Stats GetStats() const {
+    std::lock_guard<std::mutex> lock(statsMutex);
+    return stats;
+  }
+
+  SimulationLoop(const SimulationLoop&) = delete;
+  SimulationLoop& operator=(const SimulationLoop&) = delete;
+
+ private:
+  void Run();
+  void Tick();
+
+  SimulationModel& model;
+  double rate;
+  std::atomic<double> speed;
+  std::atomic<double> budget;
+  std::atomic<bool> running;
+  std::function<void()> onTick;
+  std::mutex mutex;
+  Stats stats;
+  mutable std::mutex statsMutex;
+  std::thread thread;
+};
+
+#endif  // SIMULATION_LOOP_H_
@@ -6,8 +6,11 @@
 #include "CompositeFactory.h"
 #include "Drone.h"
 #include "Robot.h"
+#include "TripScheduler.h"
 #include "graph.h"
+#include "graph_store.h"
 #include "DronePublisher.h"
+#include "util/job_system.h"
 
 #include "Weather.h"
 #define GLOBAL_WEATHER Weather::GetInstance()
@@ -26,8 +29,10 @@ class SimulationModel {
  public:
   /**
    * @brief Default constructor that create the SimulationModel object
+   * @param controller Receives the model's events
+   * @param threads Threads entities are updated on, <= 0 for one per core
    **/
-  SimulationModel(IController& controller);
+  SimulationModel(IController& controller, int threads = 0);
 
   /**
    * @brief Destructor
@@ -35,10 +40,12 @@ class SimulationModel {
   ~SimulationModel();
 
   /**
-   * @brief Set the Graph for the SimulationModel
-   * @param graph Type IGraph* contain the new graph for SimulationModel
+   * @brief Set the store the SimulationModel takes its graph from. The store
+   * may still be loading; entities pick the graph up once it is published and
+   * again whenever a new map version is swapped in.
+   * @param graphs Process-wide graph store, not owned by the model
    **/
-  void SetGraph(const IGraph* graph) { this->graph = graph; }
+  void SetGraphStore(const routing::GraphStore* graphs);
 
   /**
    * @brief Creates a new simulation entitiy
@@ -55,10 +62,56 @@ class SimulationModel {
   void ScheduleTrip(JsonObject& details);
 
   /**
-   * @brief Update the simulation
+   * @brief Wall-clock seconds spent in each phase of Update, summed over
+   * every call
+   */
+  struct PhaseTimes {
+    /** @brief Map updates and the weather's transitions and models */
+    double weather = 0;
+    /** @brief Entity updates, in parallel */
+    double entities = 0;
+    /** @brief Deferred actions and the spatial index */
+    double commit = 0;
+    /** @brief Tornado strikes and trip dispatch */
+    double dispatch = 0;
+    /** @brief Entity updates sent to the controller */
+    double view = 0;
+  };
+
+  /** @brief Smallest sub-step an entity is advanced by */
+  static constexpr double MIN_STEP = 0.01;
+  /** @brief Entities updated as one job; fewer are updated serially */
+  static const int UPDATE_GRAIN = 32;
+
+  /**
+   * @brief Update the simulation. Each entity is advanced in sub-steps no
+   * longer than its GetMaxStep(), so fast entities do not overshoot their
+   * waypoints while idle ones take dt in a single step. Entities are updated
+   * in parallel; what they Defer, such as drones reporting back idle, runs
+   * in a serial commit phase afterwards, followed by the weather's removals
+   * and the dispatch of waiting trips.
    * @param dt Type double contain the time since update was last called.
+   * @return Number of entity sub-steps taken
    **/
-  void Update(double dt);
+  int Update(double dt);
+
+  /**
+   * @brief Time spent in Update so far
+   * @return The time of each phase
+   **/
+  const PhaseTimes& GetPhaseTimes() const { return phases; }
+
+  /**
+   * @brief The scheduler trips are dispatched by, e.g. for its statistics
+   * @return The scheduler
+   **/
+  const TripScheduler& GetTripScheduler() const { return trips; }
+
+  /**
+   * @brief Threads entities are updated on
+   * @return The number of threads, at least one
+   **/
+  int GetNumThreads() const { return jobs.NumThreads(); }
 
   // Adds a new factory
   /**
@@ -68,10 +121,28 @@ class SimulationModel {
   void AddFactory(IEntityFactory* factory);
 
  protected:
+  /**
+   * @brief Hands the store's current graph to every entity if the store has
+   * published a new version since the last call
+   **/
+  void SyncGraph();
+
+
   IController& controller;
+  // state of every entity below, declared first so it outlives them
+  EntityStore store;
   std::vector<IEntity*> entities;
-  std::vector<IEntity*> scheduler;
-  const IGraph* graph;
+  TripScheduler trips;
+  // where every entity is
+  SpatialHash entityIndex;
+  routing::JobSystem jobs;
+  // deferred actions, one buffer per job system worker
+  std::vector<CommitBuffer> commits;
+  const routing::GraphStore* graphs = nullptr;
+  std::shared_ptr<const IGraph> graph;
+  std::shared_ptr<const routing::PoiTable> poiTable;
+  int graphVersion = 0;
+  PhaseTimes phases;
   CompositeFactory* compFactory;
 };
 
@@ -0,0 +1,111 @@
+#ifndef SPATIAL_HASH_H_
+#define SPATIAL_HASH_H_
+
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+#include "IEntity.h"
+
+/**
+ * @class SpatialHash
+ * @brief Uniform grid over the ground plane (x, z) that finds the entities
+ * near a point without looking at the others.
+ *
+ * Only occupied cells are stored. Entities are not tracked automatically:
+ * call Update after an entity moves, which only touches the grid when it
+ * crossed into another cell. Distances are measured in 3D.
+ */
+class SpatialHash {
+ public:
+  /** @brief Selects which entities a query may return */
+  typedef std::function<bool(const IEntity*)> Filter;
+
+  /**
+   * @brief Create an empty grid
+   * @param cellSize Edge length of a cell; queries are fastest when their
+   * radius is about one cell
+   */
+  explicit SpatialHash(float cellSize = 100);
+
+  /**
+   * @brief Add an entity at its current position
+   * @param entity The entity, not owned
+   */
+  void Insert(IEntity* entity);
+
+  /**
+   * @brief Remove an entity; does nothing if it is not in the grid
+   * @param entity The entity
+   */
+  void Remove(const IEntity* entity);
+
+  /**
+   * @brief Move an entity to the cell of its current position
+   * @param entity An entity in the grid
+   */
+  void Update(IEntity* entity);
+
+  /**
+   * @brief Whether an entity is in the grid
+   * @param entity The entity
+   * @return True if it was inserted and not removed since
+   */
+  bool Contains(const IEntity* entity) const {
+    return entries.count(entity->GetId()) > 0;
+  }
+
+  /**
+   * @brief Number of entities in the grid
+   * @return The number of entities
+   */
+  int Size() const { return entries.size(); }
+
+  /**
+   * @brief Entities within a distance of a point, in no particular order
+   * @param center The point
+   * @param radius The distance
+   * @param result Cleared, then filled with the entities found
+   * @param filter Optional; entities it rejects are skipped
+   */
+  void Radius(Vector3 center, float radius, std::vector<IEntity*>& result,
+              const Filter& filter = nullptr) const;
+
+  /**
+   * @brief The k entities closest to a point, nearest first
+   * @param center The point
+   * @param k How many to find at most
+   * @param result Cleared, then filled with the entities found
+   * @param filter Optional; entities it rejects are skipped
+   */
+  void Nearest(Vector3 center, int k, std::vector<IEntity*>& result,
+               const Filter& filter = nullptr) const;
+
+  /**
+   * @brief The entity closest to a point
+   * @param center The point
+   * @param filter Optional; entities it rejects are skipped
+   * @return The entity, or nullptr if no entity passes the filter
+   */
+  IEntity* Nearest(Vector3 center, const Filter& filter = nullptr) const;
+
+ private:
+  struct Entry {
+    int64_t cell;
+    int slot;  // index in the cell's list
+  };
+
+  int CellCoordinate(float value) const;
+  static int64_t Key(int x, int z) {
+    return (static_cast<int64_t>(x) << 32) | static_cast<uint32_t>(z);
+  }
+
+  float cellSize;
+  std::unordered_map<int64_t, std::vector<IEntity*>> cells;
+  std::unordered_map<int, Entry> entries;  // by entity id
+  // cell coordinates every entity has been in so far, to bound searches
+  int minX, maxX, minZ, maxZ;
+};
+
+#endif  // SPATIAL_HASH_H_
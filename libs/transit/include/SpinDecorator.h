@@ -16,11 +16,6 @@ class SpinDecorator : public CelebrationDecorator {
    */
   SpinDecorator(IStrategy* strategy) : CelebrationDecorator(strategy) {}
 
-  /**
-   * @brief SpinDecorator Destructor
-   */
-  ~SpinDecorator();
-
   /**
    * @brief Move the entity with the spin behavior for 4 seconds.
    * 
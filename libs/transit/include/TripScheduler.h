@@ -0,0 +1,181 @@
+#ifndef TRIP_SCHEDULER_H_
+#define TRIP_SCHEDULER_H_
+
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "IEntity.h"
+#include "SpatialHash.h"
+#include "graph_snapshot.h"
+
+class Drone;
+
+/**
+ * @class TripScheduler
+ * @brief Matches scheduled trips with idle drones.
+ *
+ * Robots are found by name through an index. Trips wait in FIFO queues, one
+ * per priority. Idle drones register themselves and are kept in a spatial
+ * index; drones never poll. Waiting trips are assigned in batches: each
+ * batch is solved as a minimum-cost assignment of trips to idle drones, so
+ * the total pickup distance is minimal instead of depending on the order
+ * drones happen to ask for work. A batch is solved when trips arrive and
+ * every DISPATCH_INTERVAL seconds while trips wait, which picks up the
+ * drones freed since. Trips already handed out are not revisited.
+ */
+class TripScheduler {
+ public:
+  /** @brief Seconds between two batches while trips are waiting */
+  static constexpr double DISPATCH_INTERVAL = 1.0;
+  /** @brief Most trips assigned in one solve */
+  static const int MAX_BATCH = 64;
+  /** @brief Idle drones nearest to each trip considered for it */
+  static const int CANDIDATES = 4;
+  /**
+   * @brief Pickup distance a second of waiting is worth when more trips
+   * of a priority wait than there are drones, so far trips are not starved
+   */
+  static constexpr double WAIT_WEIGHT = 10;
+
+  /** @brief Totals over every trip dispatched so far */
+  struct Stats {
+    long scheduled = 0;
+    long dispatched = 0;
+    long delivered = 0;
+    // seconds trips waited for a drone
+    double waited = 0;
+    // estimated distance drones fly to their robots
+    double pickupDistance = 0;
+    // seconds from scheduling to delivery, over the delivered trips
+    double tripTime = 0;
+  };
+
+  /**
+   * @brief Make a robot schedulable under its name
+   * @param robot The robot, not owned
+   */
+  void AddRobot(IEntity* robot);
+
+  /**
+   * @brief Forget a robot that left the simulation, along with its trip
+   * @param robot The robot
+   */
+  void RemoveRobot(const IEntity* robot);
+
+  /**
+   * @brief Find a robot by name
+   * @param name The robot's name
+   * @return The first robot added under that name that is still available
+   * and has no trip waiting, or nullptr
+   */
+  IEntity* FindRobot(const std::string& name) const;
+
+  /**
+   * @brief Queue a trip for a robot; the robot is picked up where it is
+   * @param name Name of the robot
+   * @param end Where the robot is delivered
+   * @param strategy Routing strategy used for the delivery
+   * @param priority Trips with a higher priority are dispatched first
+   * @return False if no such robot is waiting for a trip
+   */
+  bool Schedule(const std::string& name, Vector3 end,
+                const std::string& strategy, int priority = 0);
+
+  /**
+   * @brief Register a drone that is ready for a trip
+   * @param drone The drone, not owned; it must stay where it is until it is
+   * dispatched
+   */
+  void AddDrone(Drone* drone);
+
+  /**
+   * @brief Record that a drone delivered its robot; the drone is ready for
+   * the next trip
+   * @param drone The drone, see AddDrone
+   * @param robot The robot it delivered
+   */
+  void Delivered(Drone* drone, const IEntity* robot);
+
+  /**
+   * @brief Sets the map pickup distances are measured on. They follow the
+   * roads when the snapshot has hub labels and are straight lines otherwise.
+   * @param snapshot The map, may be null
+   */
+  void SetRoadNetwork(std::shared_ptr<const routing::GraphSnapshot> snapshot);
+
+  /**
+   * @brief Advance the scheduler's clock and dispatch if trips arrived
+   * since the last batch or DISPATCH_INTERVAL has passed
+   * @param dt Seconds since the last call
+   * @return Number of trips dispatched
+   */
+  int Update(double dt);
+
+  /**
+   * @brief Assign waiting trips to idle drones now, highest priority first
+   * @return Number of trips dispatched
+   */
+  int Dispatch();
+
+  /**
+   * @brief Number of trips waiting for a drone
+   * @return The number of trips
+   */
+  int GetPending() const { return queued.size(); }
+
+  /**
+   * @brief Number of drones waiting for a trip
+   * @return The number of drones
+   */
+  int GetIdleDrones() const { return idle.Size(); }
+
+  /**
+   * @brief Totals over every trip dispatched so far
+   * @return The totals
+   */
+  const Stats& GetStats() const { return stats; }
+
+ private:
+  struct Trip {
+    int id;  // of the robot
+    IEntity* robot;
+    double time;  // when it was scheduled
+  };
+
+  // where a position joins the road network: the closest point on an edge
+  // and the edge's two ends
+  struct Anchor {
+    Vector3 position;
+    float gap;  // from the position to the edge
+    int nodes[2];  // -1 if there is no road network
+    float along[2];  // from the edge point to each end
+  };
+
+  int Solve(std::deque<Trip>& waiting);
+  std::vector<Drone*> Candidates(const std::vector<Trip>& batch) const;
+  Anchor AnchorOf(Vector3 position) const;
+  double PickupDistance(const Anchor& from, const Anchor& to) const;
+
+  std::unordered_map<std::string, std::vector<IEntity*>> robots;
+  // waiting trips by priority, highest first
+  std::map<int, std::deque<Trip>, std::greater<int>> pending;
+  // ids of the robots with a trip in pending; entries of robots removed
+  // since are skipped when they come up
+  std::unordered_set<int> queued;
+  // when the trips handed out were scheduled, by robot id
+  std::unordered_map<int, double> underway;
+  SpatialHash idle;
+  std::shared_ptr<const routing::GraphSnapshot> roads;
+  double now = 0;
+  double nextDispatch = 0;
+  bool arrived = false;
+  Stats stats;
+};
+
+#endif  // TRIP_SCHEDULER_H_
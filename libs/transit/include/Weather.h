@@ -1,16 +1,32 @@
 #ifndef WEATHER_H_
 #define WEATHER_H_
 
+#include "SpatialHash.h"
 #include "WeatherGFX.h"
 #include "IController.h"
 #include "WeatherPublisher.h"
+#include <cstdint>
+#include <map>
 #include <random>
+#include <vector>
+
+/**
+ * @brief The weathers the simulation cycles through
+ */
+enum class WeatherKind : uint8_t {
+  NORMAL, SNOW, TORNADO, RAIN, HOT, HURRICANE
+};
 
 /**
  * @class Weather
  * @brief This class is responsible for simulating weather behavior
  *in the physical system
  *
+ * A state machine over WeatherKind. A weather's effects are applied once
+ * when it begins and undone once when it ends: speeds are changed through
+ * each entity's speed factor, and entities taken out of the view are put
+ * back. In between, Update does constant work.
+ *
  * Implemented via Singleton design pattern.
  */
 class Weather {
@@ -34,65 +50,36 @@ class Weather {
   static Weather* GetInstance();
 
   /**
-   * @brief Updates the weather cycle,
-   *        applies the current weather behavior for 60 seconds
+   * @brief Updates the weather cycle; once the current weather is
+   *        completed, ends it and begins the next one
    *
    * @param dt Delta time
-   * @param entities Vector containing all the entities in the system
-   */
-  void Update(double dt, std::vector<IEntity*>& entities);
-
-  /**
-   * @brief Represents the behavior for a "normal" weather
-   */
-  void Normal();
-
-  /**
-   * @brief Represents the behavior for a "heavy snow" weather
-   * @param entities Vector containing all the entities in the system
-   */
-  void Snow(std::vector<IEntity*>& entities);
-
-  /**
-   * @brief Represents the behavior for a "tornado" weather
-   * @param entities Vector containing all the entities in the system
-   */
-  void Tornado(std::vector<IEntity*>& entities);
-
-  /**
-   * @brief Represents the behavior for a "light rain" weather
-   */
-  void Rain();
-
-  /**
-   * @brief Represents the behavior for a "blazing hot" weather
-   * @param entities Vector containing all the entities in the system
-   */
-  void Hot(std::vector<IEntity*>& entities);
-
-  /**
-   * @brief Represents the behavior for a "hurricane" weather
-   * @param entities Vector containing all the entities in the system
+   * @param entities Store holding all the entities in the system
+   * @param CON Allows us to update the front-end view
+   * @param ENT Vector containing all the entities in the system
    */
-  void Hurricane(std::vector<IEntity*>& entities);
+  void Update(double dt, EntityStore& entities, IController& CON,
+              std::vector<IEntity*>& ENT);
 
   /**
-   * @brief Reverts the behavior changes of a weather
-   * @param entities Vector containing all the entities in the system
+   * @brief Applies the current weather to an entity that was added
+   *        after the weather began
+   * @param entity The new entity, at its natural speed
+   * @param CON Allows us to update the front-end view
    */
-  void Revert(std::vector<IEntity*>& entities);
+  void Join(IEntity& entity, IController& CON);
 
   /**
    * @brief Gets the current weather
    * @return The current weather
    */
-  std::string Forecast();
+  WeatherKind Forecast() const { return current; }
 
   /**
    * @brief Checks if the current weather is completed by checking the time
    * @return True if complete, false if not complete
    **/
-  bool IsCompleted();
+  bool IsCompleted() const;
 
   /**
    * @brief Creates all weather models
@@ -110,35 +97,16 @@ class Weather {
   void UpdateGFX(double dt, IController& CON);
 
   /**
-   * @brief Weathers with front-end changes get called from here
-   * @param c Constant to index current entity
-   * @param CON Allows us to update the front-end view
-   * @param ENT Vector containing all the entities in the system
-   **/
-  void Run(const int c, IController& CON, std::vector<IEntity*>& ENT);
-
-  /**
-   * @brief Deletes entities in the system based on set requirements
-   * @param c Constant to index current entity
-   * @param CON Allows us to update the front-end view
-   * @param ENT Vector containing all the entities in the system
-   **/
-  void TornadoAct(const int c, IController& CON, std::vector<IEntity*>& ENT);
-
-  /**
-   * @brief Removes entities from the front-end view
-   * @param c Constant to index current entity
+   * @brief Deletes the humans and delivered robots within reach of the
+   * tornado, found through the spatial index
    * @param CON Allows us to update the front-end view
    * @param ENT Vector containing all the entities in the system
+   * @param index Spatial index over ENT; the deleted entities leave it too
+   * @return The deleted entities
    **/
-  void HurricaneAct(const int c, IController& CON, std::vector<IEntity*>& ENT);
-
-  /**
-   * @brief Reverses any front-end changes by the previous weather
-   * @param CON Allows us to update the front-end view
-   * @param ENT Vector containing all the entities in the system
-   **/
-  void Reverse(IController& CON, std::vector<IEntity*>& ENT);
+  std::vector<IEntity*> TornadoStrike(IController& CON,
+                                      std::vector<IEntity*>& ENT,
+                                      SpatialHash& index);
 
   /**
    * @brief Gets the publisher for weather
@@ -158,20 +126,49 @@ class Weather {
   JsonObject RemoveHelper(const IEntity& ENT, const std::string& VU);
 
  private:
-  explicit Weather() : time(0.0), index(0) {
-    weather = {
-      "normal", "snow", "tornado",
-      "rain", "hot", "hurricane"
-    };
-  }
-  JsonObject details;
-  std::vector<std::string> weather;
-  float time;
-  int index;
-  bool run = true;
-  std::map<int, float> prev;
-  std::map<std::string, IEntity*> GFX;
-  std::string restore = "none";
+  explicit Weather() {}
+
+  /**
+   * @brief Applies the effects of the current weather as it begins
+   */
+  void Enter(EntityStore& entities, IController& CON,
+             std::vector<IEntity*>& ENT);
+
+  /**
+   * @brief Undoes the effects of the current weather as it ends
+   */
+  void Exit(EntityStore& entities, IController& CON);
+
+  /**
+   * @brief What the current weather scales an entity's speed by
+   * @param kind What the entity is
+   * @param speed The entity's natural speed
+   * @return The factor, 1 if the entity is not affected
+   */
+  float SpeedFactor(EntityKind kind, float speed) const;
+
+  /**
+   * @brief Takes an entity out of the view until the weather ends
+   */
+  void Hide(IEntity& entity, IController& CON);
+
+  /**
+   * @brief The model of a weather
+   * @return The model, or nullptr if the scene has none
+   */
+  IEntity* Model(WeatherKind kind) const;
+
+  WeatherKind current = WeatherKind::NORMAL;
+  // false until the first weather has begun
+  bool begun = false;
+  float time = 0.0;
+  // holds the weather models, apart from the simulated entities
+  EntityStore gfxStore;
+  std::map<WeatherKind, IEntity*> GFX;
+  // whether the current weather's model is in the view
+  bool shown = false;
+  // entities taken out of the view by the current weather
+  std::vector<IEntity*> hidden;
   std::default_random_engine GEN;
   /*
     decides weather occurrence { normal, snow, tornado, rain, hot, hurricane }
@@ -17,69 +17,29 @@ class WeatherGFX : public IEntity {
   /**
    * @brief Constructor
    * @param obj The JSON object containing the weather's information
+   * @param store Store holding the weather's state
    */
-  WeatherGFX(JsonObject& obj);
+  WeatherGFX(JsonObject& obj, EntityStore& store);
 
   /**
    * @brief Destructor
    */
   ~WeatherGFX() override = default;
 
-  /**
-   * @brief Get the weather's position
-   * @return The weather's position
-   */
-  Vector3 GetPosition() const { return position; }
-
-  /**
-   * @brief Get the weather's direction
-   * @return The the weather's direction
-   */
-  Vector3 GetDirection() const { return direction; }
-
-  /**
-   * @brief Get the weather's destination
-   * @return The the weather's destination
-   */
-  Vector3 GetDestination() const { return destination; }
-
   /**
    * @brief Get the weather's details
    * @return The weather's details
    */
   JsonObject GetDetails() const { return details; }
 
-  /**
-   * @brief Get the weather's speed
-   * @return The weather's speed
-   */
-  float GetSpeed() const { return speed; }
-
   /**
    * @brief Updates the weather's position
    * @param dt Delta time
-   * @param IGNORE Filler argument for polymorphism purposes
-   */
-  void Update(double dt, std::vector<IEntity*> IGNORE) override;
-
-  /**
-   * @brief Sets the position of the weather
-   * @param pos_ The new position of the weather
-   */
-  void SetPosition(Vector3 pos_) { position = pos_; }
-
-  /**
-   * @brief Sets the direction of the weather
-   * @param dir_ The new direction of the weather
    */
-  void SetDirection(Vector3 dir_) { direction = dir_; }
+  void Update(double dt) override;
 
  private:
   JsonObject details;
-  Vector3 position;
-  Vector3 direction;
-  Vector3 destination;
-  float speed;
   IStrategy* toDestination = nullptr;
 };
 
@@ -14,6 +14,12 @@ void BeelineStrategy::Move(IEntity* entity, double dt) {
   entity->SetDirection(dir);
 }
 
+double BeelineStrategy::GetMaxStep(IEntity* entity) {
+  if (IsCompleted() || entity->GetSpeed() <= 0)
+    return IStrategy::GetMaxStep(entity);
+  return position.Distance(destination) / entity->GetSpeed();
+}
+
 bool BeelineStrategy::IsCompleted() {
   return position.Distance(destination) < 4.0;
 }
@@ -10,6 +10,13 @@ CelebrationDecorator::~CelebrationDecorator() {
   delete strategy;
 }
 
+double CelebrationDecorator::GetMaxStep(IEntity* entity) {
+  if (!strategy->IsCompleted()) {
+    return strategy->GetMaxStep(entity);
+  }
+  return IsCompleted() ? IStrategy::GetMaxStep(entity) : 0.05;
+}
+
 bool CelebrationDecorator::IsCompleted() {
   if (time >= 4.0) {
     return true;
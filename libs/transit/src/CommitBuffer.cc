@@ -0,0 +1,25 @@
+#include "CommitBuffer.h"
+
+#include <algorithm>
+
+int CommitBuffer::Commit(std::vector<CommitBuffer>& buffers) {
+  std::vector<Action*> merged;
+  for (CommitBuffer& buffer : buffers) {
+    for (Action& action : buffer.actions) {
+      merged.push_back(&action);
+    }
+  }
+  // an entity is updated by a single worker, so its actions come from one
+  // buffer and the sequence keeps them in the order they were pushed
+  std::sort(merged.begin(), merged.end(), [](const Action* a, const Action* b) {
+    return a->order != b->order ? a->order < b->order
+                                : a->sequence < b->sequence;
+  });
+  for (Action* action : merged) {
+    action->run();
+  }
+  for (CommitBuffer& buffer : buffers) {
+    buffer.actions.clear();
+  }
+  return merged.size();
+}
@@ -1,8 +1,10 @@
 #include "CompositeFactory.h"
 
-IEntity* CompositeFactory::CreateEntity(JsonObject& entity) {
+IEntity* CompositeFactory::CreateEntity(JsonObject& entity,
+                                        EntityStore& store) {
   for (int i = 0; i < componentFactories.size(); i++) {
-    IEntity* createdEntity = componentFactories.at(i)->CreateEntity(entity);
+    IEntity* createdEntity =
+      componentFactories.at(i)->CreateEntity(entity, store);
     if (createdEntity != nullptr) {
       return createdEntity;
     }
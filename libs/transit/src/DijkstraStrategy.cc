@@ -2,8 +2,15 @@
 #include "routing/dijkstra.h"
 
 DijkstraStrategy::DijkstraStrategy(Vector3 pos, Vector3 des,
-                                   const routing::IGraph* g) {
-  std::vector<float> start = {pos[0], pos[1], pos[2]};
-  std::vector<float> end   = {des[0], des[1], des[2]};
-  path = g->GetPath(start, end, Dijkstra::Instance());
+                                   std::shared_ptr<const routing::IGraph> g,
+                                   std::shared_ptr<const routing::PoiTable> poiTable) {
+  if (!g) {
+    // the map is not loaded yet, head straight for the destination
+    path = {{des[0], des[1], des[2]}};
+    return;
+  }
+  if (Lookup(poiTable.get(), pos, des)) {
+    return;
+  }
+  Plan(g, pos, des, Dijkstra::Instance());
 }
@@ -2,7 +2,6 @@
 #include "Drone.h"
 
 #include <cmath>
-#include <limits>
 
 #include "AstarStrategy.h"
 #include "BeelineStrategy.h"
@@ -10,58 +9,49 @@
 #include "DijkstraStrategy.h"
 #include "JumpDecorator.h"
 #include "SpinDecorator.h"
+#include "TripScheduler.h"
 
-Drone::Drone(JsonObject& obj) : details(obj) {
-  JsonArray pos(obj["position"]);
-  position = {pos[0], pos[1], pos[2]};
-  JsonArray dir(obj["direction"]);
-  direction = {dir[0], dir[1], dir[2]};
-
-  speed = obj["speed"];
-
-  available = true;
+Drone::Drone(JsonObject& obj, EntityStore& store)
+    : IEntity(store, EntityKind::DRONE), details(obj) {
+  Init(obj);
+  SetAvailability(true);
 }
 
 Drone::~Drone() {
-  // Delete dynamically allocated variables
-  delete graph;
-  delete nearestEntity;
+  // Delete dynamically allocated variables; the robot belongs to the model
   delete toRobot;
   delete toFinalDestination;
   delete toPublisher;
 }
 
-void Drone::GetNearestEntity(std::vector<IEntity*> scheduler) {
-  float minDis = std::numeric_limits<float>::max();
-  for (auto entity : scheduler) {
-    if (entity->GetAvailability()) {
-      float disToEntity = this->position.Distance(entity->GetPosition());
-      if (disToEntity <= minDis) {
-        minDis = disToEntity;
-        nearestEntity = entity;
-      }
-    }
+void Drone::SetTripScheduler(TripScheduler* trips) {
+  this->trips = trips;
+  if (trips && GetAvailability()) {
+    trips->AddDrone(this);
   }
+}
 
+void Drone::Pickup(IEntity* robot) {
+  nearestEntity = robot;
   if (nearestEntity) {
-    std::string ret = nearestEntity->GetDetails()["name"];
-    robotName = ret;
+    robotName = nearestEntity->GetName();
 
     // set availability to the nearest entity
     nearestEntity->SetAvailability(false);
-    available = false;
+    SetAvailability(false);
     pickedUp = false;
 
-    destination = nearestEntity->GetPosition();
+    Vector3 destination = nearestEntity->GetPosition();
     Vector3 finalDestination = nearestEntity->GetDestination();
+    SetDestination(destination);
 
-    toRobot = new BeelineStrategy(position, destination);
+    toRobot = new BeelineStrategy(GetPosition(), destination);
 
     std::string strat = nearestEntity->GetStrategyName();
     if (strat == "astar")
       toFinalDestination =
         new JumpDecorator(new AstarStrategy
-        (destination, finalDestination, graph));
+        (destination, finalDestination, graph, poiTable));
     else if (strat == "dfs")
       toFinalDestination =
         new SpinDecorator(new JumpDecorator
@@ -69,27 +59,22 @@ void Drone::GetNearestEntity(std::vector<IEntity*> scheduler) {
     else if (strat == "dijkstra")
       toFinalDestination =
         new JumpDecorator(new SpinDecorator
-        (new DijkstraStrategy(destination, finalDestination, graph)));
+        (new DijkstraStrategy(destination, finalDestination, graph,
+                              poiTable)));
     else
       toFinalDestination = new BeelineStrategy(destination, finalDestination);
   }
 }
 
-void Drone::Update(double dt, std::vector<IEntity*> scheduler) {
-  if (available) {
-    GetNearestEntity(scheduler);
-  }
-
+void Drone::Update(double dt) {
   UpdateHelper();
 
   if (toRobot) {
     toRobot->Move(this, dt);
-    toPublisher->SendEvents(
-      name + ": Picking up the robot \"" + robotName + "\"\n\n");
+    Publish(GetName() + ": Picking up the robot \"" + robotName + "\"\n\n");
 
     if (toRobot->IsCompleted()) {
-      toPublisher->SendEvents(
-        name + ": Picked up the robot \"" + robotName + "\"\n\n");
+      Publish(GetName() + ": Picked up the robot \"" + robotName + "\"\n\n");
       delete toRobot;
       toRobot = nullptr;
       pickedUp = true;
@@ -98,34 +83,59 @@ void Drone::Update(double dt, std::vector<IEntity*> scheduler) {
   } else if (toFinalDestination) {
     toFinalDestination->Move(this, dt);
 
-    if (nearestEntity && pickedUp) {
-      toPublisher->SendEvents(
-        name + ": Delivering the robot \"" + robotName + "\"\n\n");
-      nearestEntity->SetPosition(position);
-      nearestEntity->SetDirection(direction);
+    // the robot is another entity's slot, so it is carried in the commit
+    // phase
+    IEntity* robot = nearestEntity;
+    if (robot && pickedUp) {
+      Publish(GetName() + ": Delivering the robot \"" + robotName + "\"\n\n");
+      Vector3 position = GetPosition();
+      Vector3 direction = GetDirection();
+      Defer([robot, position, direction]() {
+        robot->SetPosition(position);
+        robot->SetDirection(direction);
+      });
     }
 
     if (toFinalDestination->IsCompleted()) {
-      dynamic_cast<Robot*>(nearestEntity)->AvailableToDelete();
-      toPublisher->SendEvents(
-        name + ": Delivered the robot \"" + robotName + "\"\n\n");
+      Defer([robot]() { robot->SetStatus(EntityStatus::DELIVERED); });
+      Publish(GetName() + ": Delivered the robot \"" + robotName + "\"\n\n");
+      if (trips) {
+        // ready for the next trip once the update is committed
+        Defer([this, robot]() { trips->Delivered(this, robot); });
+      }
       delete toFinalDestination;
       toFinalDestination = nullptr;
       nearestEntity = nullptr;
-      available = true;
+      SetAvailability(true);
       pickedUp = false;
       run = true;
     }
   }
 }
 
+void Drone::Publish(const std::string& message) {
+  Defer([this, message]() { toPublisher->SendEvents(message); });
+}
+
+double Drone::GetMaxStep() {
+  if (toRobot) {
+    return toRobot->GetMaxStep(this);
+  }
+  if (toFinalDestination) {
+    return toFinalDestination->GetMaxStep(this);
+  }
+  return IEntity::GetMaxStep();
+}
+
 void Drone::Rotate(double angle) {
+  Vector3& direction = store->Direction(handle);
   Vector3 dirTmp = direction;
   direction.x = dirTmp.x * std::cos(angle) - dirTmp.z * std::sin(angle);
   direction.z = dirTmp.x * std::sin(angle) + dirTmp.z * std::cos(angle);
 }
 
 void Drone::Jump(double height) {
+  Vector3& position = store->Position(handle);
   if (goUp) {
     position.y += height;
     jumpHeight += height;
@@ -142,34 +152,34 @@ void Drone::Jump(double height) {
 }
 
 void Drone::UpdateHelper() {
-  if (GLOBAL_WEATHER->Forecast() == "snow") {
+  if (GLOBAL_WEATHER->Forecast() == WeatherKind::SNOW) {
     if (toRobot) {
       if (run) {
         delete toRobot;
-        toRobot = new AstarStrategy(position, destination, graph);
+        toRobot = new AstarStrategy(GetPosition(), GetDestination(), graph);
         emergency = true;
         run = false;
       }
       if (emergency && GLOBAL_WEATHER->IsCompleted()) {
         delete toRobot;
-        toRobot = new BeelineStrategy(position, destination);
+        toRobot = new BeelineStrategy(GetPosition(), GetDestination());
         emergency = false;
         run = true;
       }
     }
-  } else if (GLOBAL_WEATHER->Forecast() == "hot") {
+  } else if (GLOBAL_WEATHER->Forecast() == WeatherKind::HOT) {
     if (!toRobot && toFinalDestination) {
       if (run) {
         delete toFinalDestination;
         toFinalDestination =
-          new BeelineStrategy(position, nearestEntity->GetDestination());
+          new BeelineStrategy(GetPosition(), nearestEntity->GetDestination());
         emergency = true;
         run = false;
       }
       if (emergency && GLOBAL_WEATHER->IsCompleted()) {
         delete toFinalDestination;
-        toFinalDestination = new SpinDecorator(
-          new AstarStrategy(position, nearestEntity->GetDestination(), graph));
+        toFinalDestination = new SpinDecorator(new AstarStrategy(
+          GetPosition(), nearestEntity->GetDestination(), graph));
         emergency = false;
         run = true;
       }
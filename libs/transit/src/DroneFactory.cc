@@ -1,10 +1,11 @@
 #include "DroneFactory.h"
 
-IEntity* DroneFactory::CreateEntity(JsonObject& entity) {
+IEntity* DroneFactory::CreateEntity(JsonObject& entity,
+                                    EntityStore& store) {
   std::string type = entity["type"];
   if (type.compare("drone") == 0) {
     std::cout << "Drone Created" << std::endl;
-    return new Drone(entity);
+    return new Drone(entity, store);
   }
   return nullptr;
 }
@@ -0,0 +1,56 @@
+#include "EntityStore.h"
+
+const uint8_t EntityStore::AVAILABLE;
+
+EntityStore::Handle EntityStore::Add(int id, EntityKind kind) {
+  Handle handle;
+  if (freeHandles.empty()) {
+    handle = slots.size();
+    slots.push_back(-1);
+  } else {
+    handle = freeHandles.back();
+    freeHandles.pop_back();
+  }
+  slots[handle] = ids.size();
+  handles.push_back(handle);
+  positions.push_back(Vector3());
+  directions.push_back(Vector3());
+  destinations.push_back(Vector3());
+  speeds.push_back(0);
+  speedFactors.push_back(1);
+  states.push_back(0);
+  statuses.push_back(EntityStatus::NONE);
+  kinds.push_back(kind);
+  ids.push_back(id);
+  return handle;
+}
+
+void EntityStore::Remove(Handle handle) {
+  int slot = slots[handle];
+  int last = ids.size() - 1;
+  if (slot != last) {
+    positions[slot] = positions[last];
+    directions[slot] = directions[last];
+    destinations[slot] = destinations[last];
+    speeds[slot] = speeds[last];
+    speedFactors[slot] = speedFactors[last];
+    states[slot] = states[last];
+    statuses[slot] = statuses[last];
+    kinds[slot] = kinds[last];
+    ids[slot] = ids[last];
+    handles[slot] = handles[last];
+    slots[handles[slot]] = slot;
+  }
+  positions.pop_back();
+  directions.pop_back();
+  destinations.pop_back();
+  speeds.pop_back();
+  speedFactors.pop_back();
+  states.pop_back();
+  statuses.pop_back();
+  kinds.pop_back();
+  ids.pop_back();
+  handles.pop_back();
+  slots[handle] = -1;
+  freeHandles.push_back(handle);
+}
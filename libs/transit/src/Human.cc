@@ -6,26 +6,23 @@
 
 #include "AstarStrategy.h"
 
-Human::Human(JsonObject& obj) : details(obj) {
-  JsonArray pos(obj["position"]);
-  position = {pos[0], pos[1], pos[2]};
-  JsonArray dir(obj["direction"]);
-  direction = {dir[0], dir[1], dir[2]};
-
-  speed = obj["speed"];
+Human::Human(JsonObject& obj, EntityStore& store)
+    : IEntity(store, EntityKind::HUMAN), details(obj) {
+  Init(obj);
 }
 
 Human::~Human() {
   // Delete dynamically allocated variables
-  delete graph;
+  delete toDestination;
 }
 
 void Human::CreateNewDestination() {
-    destination = {Random(-1400, 1500), position.y, Random(-800, 800)};
-    toDestination = new AstarStrategy(position, destination, graph);
+    SetDestination({Random(-1400, 1500), GetPosition().y, Random(-800, 800)});
+    delete toDestination;
+    toDestination = new AstarStrategy(GetPosition(), GetDestination(), graph);
 }
 
-void Human::Update(double dt, std::vector<IEntity*> scheduler) {
+void Human::Update(double dt) {
     if (toDestination) {
         if ( toDestination->IsCompleted() ) {
             CreateNewDestination();
@@ -1,10 +1,11 @@
 #include "HumanFactory.h"
 
-IEntity* HumanFactory::CreateEntity(JsonObject& entity) {
+IEntity* HumanFactory::CreateEntity(JsonObject& entity,
+                                    EntityStore& store) {
   std::string type = entity["type"];
   if (type.compare("human") == 0) {
     std::cout << "Human Created" << std::endl;
-    return new Human(entity);
+    return new Human(entity, store);
   }
   return nullptr;
 }
@@ -1,10 +1,59 @@
 #include "PathStrategy.h"
 
+#include <chrono>
+#include <iostream>
+
 PathStrategy::PathStrategy(std::vector<std::vector<float>> p)
   : path(p), index(0) {}
 
+void PathStrategy::Plan(std::shared_ptr<const routing::IGraph> graph,
+                        Vector3 pos, Vector3 des,
+                        const routing::RoutingStrategy& strategy,
+                        float epsilon, int budgetMs) {
+  std::vector<float> start = {pos[0], pos[1], pos[2]};
+  std::vector<float> end   = {des[0], des[1], des[2]};
+  path.clear();
+  index = 0;
+  planned = routing::RouteService::Shared().Request(graph, start, end,
+                                                    strategy, epsilon,
+                                                    budgetMs);
+}
+
+bool PathStrategy::Lookup(const routing::PoiTable* table, Vector3 pos,
+                          Vector3 des) {
+  std::vector<std::vector<float>> route;
+  if (!table || !table->Lookup({pos[0], pos[1], pos[2]},
+                               {des[0], des[1], des[2]}, route)) {
+    return false;
+  }
+  path = route;
+  index = 0;
+  planned = std::future<routing::Route>();
+  return true;
+}
+
+bool PathStrategy::IsPlanning() {
+  if (!planned.valid()) {
+    return false;
+  }
+  if (planned.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+    return true;
+  }
+  try {
+    routing::Route route = planned.get();
+    path = route.path;
+    OnPlanned(route);
+  }
+  catch (const std::exception& e) {
+    // nothing to follow, the entity simply stays put
+    std::cerr << "Route planning failed: " << e.what() << std::endl;
+    path.clear();
+  }
+  return false;
+}
+
 void PathStrategy::Move(IEntity* entity, double dt) {
-  if (IsCompleted())
+  if (IsPlanning() || IsCompleted())
     return;
 
   Vector3 vi(path[index][0], path[index][1], path[index][2]);
@@ -17,6 +66,14 @@ void PathStrategy::Move(IEntity* entity, double dt) {
     index++;
 }
 
+double PathStrategy::GetMaxStep(IEntity* entity) {
+  // the entity stays put while its route is planned
+  if (IsPlanning() || IsCompleted() || entity->GetSpeed() <= 0)
+    return IStrategy::GetMaxStep(entity);
+  Vector3 vi(path[index][0], path[index][1], path[index][2]);
+  return entity->GetPosition().Distance(vi) / entity->GetSpeed();
+}
+
 bool PathStrategy::IsCompleted() {
-  return index >= path.size();
+  return !IsPlanning() && index >= path.size();
 }
@@ -1,20 +1,19 @@
 #include "Robot.h"
 
-Robot::Robot(JsonObject &obj) : details(obj) {
-  JsonArray pos(obj["position"]);
-  position = {pos[0], pos[1], pos[2]};
-  JsonArray dir(obj["direction"]);
-  direction = {dir[0], dir[1], dir[2]};
-  speed = obj["speed"];
-  available = true;
-  details["status"] = "NULL";
+Robot::Robot(JsonObject &obj, EntityStore& store)
+    : IEntity(store, EntityKind::ROBOT), details(obj) {
+  Init(obj);
+  SetAvailability(true);
 }
 
-JsonObject Robot::GetDetails() const { return details; }
-
-void Robot::SetAvailability(bool choice) { available = choice; }
+JsonObject Robot::GetDetails() const {
+  JsonObject result = details;
+  result["status"] = GetStatus() == EntityStatus::DELIVERED ? "delete" : "NULL";
+  return result;
+}
 
 void Robot::Rotate(double angle) {
+  Vector3& direction = store->Direction(handle);
   Vector3 dirTmp = direction;
   direction.x = dirTmp.x * std::cos(angle) - dirTmp.z * std::sin(angle);
   direction.z = dirTmp.x * std::sin(angle) + dirTmp.z * std::cos(angle);
@@ -1,10 +1,11 @@
 #include "RobotFactory.h"
 
-IEntity* RobotFactory::CreateEntity(JsonObject& entity) {
+IEntity* RobotFactory::CreateEntity(JsonObject& entity,
+                                    EntityStore& store) {
   std::string type = entity["type"];
   if (type.compare("robot") == 0) {
     std::cout << "Robot Created" << std::endl;
-    return new Robot(entity);
+    return new Robot(entity, store);
   }
   return nullptr;
 }
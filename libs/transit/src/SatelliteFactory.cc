@@ -1,10 +1,11 @@
 #include "SatelliteFactory.h"
 
-IEntity* SatelliteFactory::CreateEntity(JsonObject& entity) {
+IEntity* SatelliteFactory::CreateEntity(JsonObject& entity,
+                                        EntityStore& store) {
   std::string type = entity["type"];
   if (type.compare("satellite") == 0) {
     std::cout << "Satellite Created" << std::endl;
-    return new Satellite(entity);
+    return new Satellite(entity, store);
   }
   return nullptr;
 }
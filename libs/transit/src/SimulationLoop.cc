@@ -0,0 +1,84 @@
+#include "SimulationLoop.h"
+
+#include <algorithm>
+#include <chrono>
+
+const int SimulationLoop::MAX_CATCH_UP;
+
+SimulationLoop::SimulationLoop(SimulationModel& model, double rate)
+  : model(model), rate(rate), speed(1), budget(0.8 / rate),
+    running(false) {}
+
+SimulationLoop::~SimulationLoop() { Stop(); }
+
+void SimulationLoop::Start(std::function<void()> onTick) {
+  Stop();
+  this->onTick = onTick;
+  running = true;
+  thread = std::thread([this]() { Run(); });
+}
+
+void SimulationLoop::Stop() {
+  running = false;
+  if (thread.joinable()) {
+    thread.join();
+  }
+}
+
+void SimulationLoop::Run() {
+  typedef std::chrono::steady_clock Clock;
+  const Clock::duration period =
+    std::chrono::duration_cast<Clock::duration>(
+      std::chrono::duration<double>(1.0 / rate));
+  Clock::time_point next = Clock::now();
+  while (running) {
+    Tick();
+    next += period;
+    Clock::time_point now = Clock::now();
+    if (now - next > MAX_CATCH_UP * period) {
+      // too far behind, drop the missed ticks instead of bursting
+      next = now;
+    }
+    std::this_thread::sleep_until(next);
+  }
+}
+
+void SimulationLoop::Tick() {
+  typedef std::chrono::steady_clock Clock;
+  Clock::time_point start = Clock::now();
+  const Clock::time_point deadline = start +
+    std::chrono::duration_cast<Clock::duration>(
+      std::chrono::duration<double>(budget.load()));
+
+  double delta = speed / rate;
+  double done = 0;
+  int rounds = 0;
+  int steps = 0;
+  std::unique_lock<std::mutex> lock(mutex);
+  // at least one round per tick, so the simulation always makes progress
+  while (done < delta && (rounds == 0 || Clock::now() < deadline)) {
+    double round = std::min(MAX_ROUND, delta - done);
+    steps += model.Update(round);
+    done += round;
+    rounds++;
+  }
+  double seconds =
+    std::chrono::duration<double>(Clock::now() - start).count();
+  {
+    std::lock_guard<std::mutex> statsLock(statsMutex);
+    stats.ticks++;
+    stats.rounds += rounds;
+    stats.steps += steps;
+    stats.lastSteps = steps;
+    stats.simTime += done;
+    if (done < delta) {
+      stats.overruns++;
+      stats.droppedTime += delta - done;
+    }
+    stats.lastTickSeconds = seconds;
+    stats.maxTickSeconds = std::max(stats.maxTickSeconds, seconds);
+  }
+  if (onTick) {
+    onTick();
+  }
+}
@@ -1,12 +1,27 @@
 #include "SimulationModel.h"
 
+#include <algorithm>
+#include <chrono>
+#include <numeric>
+
 #include "DroneFactory.h"
 #include "RobotFactory.h"
 #include "HumanFactory.h"
 #include "SatelliteFactory.h"
 
-SimulationModel::SimulationModel(IController& controller)
-    : controller(controller) {
+const int SimulationModel::UPDATE_GRAIN;
+
+typedef std::chrono::steady_clock Clock;
+
+// adds the seconds since start to phase and restarts the clock
+static void Lap(Clock::time_point& start, double& phase) {
+  Clock::time_point now = Clock::now();
+  phase += std::chrono::duration<double>(now - start).count();
+  start = now;
+}
+
+SimulationModel::SimulationModel(IController& controller, int threads)
+    : controller(controller), jobs(threads), commits(jobs.NumThreads()) {
   compFactory = new CompositeFactory();
   AddFactory(new DroneFactory());
   AddFactory(new RobotFactory());
@@ -20,21 +35,42 @@ SimulationModel::~SimulationModel() {
   for (int i = 0; i < entities.size(); i++) {
     delete entities[i];
   }
-  for (int i = 0; i < scheduler.size(); i++) {
-    delete scheduler[i];
-  }
-  delete graph;
   delete compFactory;
 }
 
+void SimulationModel::SetGraphStore(const routing::GraphStore* graphs) {
+  this->graphs = graphs;
+  SyncGraph();
+}
+
+void SimulationModel::SyncGraph() {
+  if (!graphs || graphs->GetVersion() == graphVersion) {
+    return;
+  }
+  std::shared_ptr<const routing::GraphSnapshot> snapshot = graphs->Get();
+  if (!snapshot) {
+    return;
+  }
+  graph = routing::GraphSnapshot::GraphOf(snapshot);
+  poiTable = snapshot->GetPoiTable();
+  graphVersion = snapshot->GetVersion();
+  trips.SetRoadNetwork(snapshot);
+  for (auto entity : entities) {
+    entity->SetGraph(graph);
+    entity->SetPoiTable(poiTable);
+  }
+  std::cout << "Using graph " << snapshot->GetSource() << " (version "
+            << graphVersion << ")" << std::endl;
+}
+
 void SimulationModel::CreateEntity(JsonObject& entity) {
   if (GLOBAL_WEATHER->CreateGFX(entity, controller)) { return; }
 
   std::string type = entity["type"];
 
   // humans aren't spawned correctly when there speed is 0
-  if (GLOBAL_WEATHER->Forecast() != "normal" &&
-      GLOBAL_WEATHER->Forecast() != "rain") {
+  WeatherKind weather = GLOBAL_WEATHER->Forecast();
+  if (weather != WeatherKind::NORMAL && weather != WeatherKind::RAIN) {
     if (type == "human") {
       std::cout << "[!] Bad weather condition, " <<
       entity["name"] << " not added!" << std::endl;
@@ -46,17 +82,24 @@ void SimulationModel::CreateEntity(JsonObject& entity) {
   JsonArray position = entity["position"];
   std::cout << name << ": " << position << std::endl;
 
-  IEntity* myNewEntity = compFactory->CreateEntity(entity);
+  SyncGraph();
+  IEntity* myNewEntity = compFactory->CreateEntity(entity, store);
   myNewEntity->SetGraph(graph);
+  myNewEntity->SetPoiTable(poiTable);
 
   // Call AddEntity to add it to the view
   controller.AddEntity(*myNewEntity);
   entities.push_back(myNewEntity);
+  entityIndex.Insert(myNewEntity);
+  GLOBAL_WEATHER->Join(*myNewEntity, controller);
 
   if (type == "drone") {
     IPublisher* eventManager = new DronePublisher();
     eventManager->Subscribe(&controller);
     myNewEntity->SetPublisher(eventManager);
+    myNewEntity->SetTripScheduler(&trips);
+  } else if (type == "robot") {
+    trips.AddRobot(myNewEntity);
   }
 }
 
@@ -67,33 +110,64 @@ void SimulationModel::ScheduleTrip(JsonObject& details) {
   JsonArray end = details["end"];
   std::cout << name << ": " << start << " --> " << end << std::endl;
 
-  for (auto entity : entities) {  // Add the entity to the scheduler
-    JsonObject detailsTemp = entity->GetDetails();
-    std::string nameTemp = detailsTemp["name"];
-    std::string typeTemp = detailsTemp["type"];
-    if (name.compare(nameTemp) == 0 && typeTemp.compare("robot") == 0 &&
-        entity->GetAvailability()) {
-      std::string strategyName = details["search"];
-      entity->SetDestination(Vector3(end[0], end[1], end[2]));
-      entity->SetStrategyName(strategyName);
-      scheduler.push_back(entity);
-      break;
-    }
+  std::string strategyName = details["search"];
+  int priority = 0;
+  if (details.Contains("priority")) {
+    priority = static_cast<int>(static_cast<double>(details["priority"]));
   }
+  // dispatched with the other trips that arrive before the next update
+  trips.Schedule(name, Vector3(end[0], end[1], end[2]), strategyName,
+                 priority);
   controller.SendEventToView("TripScheduled", details);
 }
 
 /// Updates the simulation
-void SimulationModel::Update(double dt) {
-  GLOBAL_WEATHER->Update(dt, entities);
+int SimulationModel::Update(double dt) {
+  Clock::time_point start = Clock::now();
+  SyncGraph();
+  GLOBAL_WEATHER->Update(dt, store, controller, entities);
   GLOBAL_WEATHER->UpdateGFX(dt, controller);
+  Lap(start, phases.weather);
 
-  for (int i = 0; i < entities.size(); i++) {
-    GLOBAL_WEATHER->Run(i, controller, entities);
-    entities[i]->Update(dt, scheduler);
-    controller.UpdateEntity(*entities[i]);
+  std::vector<int> steps(jobs.NumThreads(), 0);
+  jobs.ParallelFor(entities.size(), UPDATE_GRAIN,
+                   [&](int begin, int end, int worker) {
+    int taken = 0;
+    for (int i = begin; i < end; i++) {
+      IEntity* entity = entities[i];
+      entity->SetCommitBuffer(&commits[worker]);
+      for (double left = dt; left > 0; taken++) {
+        double step = std::min(left,
+                               std::max(MIN_STEP, entity->GetMaxStep()));
+        entity->Update(step);
+        left -= step;
+      }
+      entity->SetCommitBuffer(nullptr);
+    }
+    steps[worker] += taken;
+  });
+  Lap(start, phases.entities);
+
+  CommitBuffer::Commit(commits);
+  for (IEntity* entity : entities) {
+    entityIndex.Update(entity);
+  }
+  Lap(start, phases.commit);
+
+  for (IEntity* entity :
+       GLOBAL_WEATHER->TornadoStrike(controller, entities, entityIndex)) {
+    if (entity->GetKind() == EntityKind::ROBOT) {
+      trips.RemoveRobot(entity);
+    }
+  }
+  // drones that finished a trip registered in the commit phase
+  trips.Update(dt);
+  Lap(start, phases.dispatch);
+  for (IEntity* entity : entities) {
+    controller.UpdateEntity(*entity);
   }
-  GLOBAL_WEATHER->Reverse(controller, entities);
+  Lap(start, phases.view);
+  return std::accumulate(steps.begin(), steps.end(), 0);
 }
 
 void SimulationModel::AddFactory(IEntityFactory* factory) {
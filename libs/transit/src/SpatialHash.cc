@@ -0,0 +1,181 @@
+#include "SpatialHash.h"
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstdlib>
+#include <queue>
+
+SpatialHash::SpatialHash(float cellSize)
+    : cellSize(cellSize), minX(INT_MAX), maxX(INT_MIN), minZ(INT_MAX),
+      maxZ(INT_MIN) {}
+
+int SpatialHash::CellCoordinate(float value) const {
+  return static_cast<int>(std::floor(value / cellSize));
+}
+
+void SpatialHash::Insert(IEntity* entity) {
+  if (Contains(entity)) {
+    Update(entity);
+    return;
+  }
+  Vector3 position = entity->GetPosition();
+  int x = CellCoordinate(position.x);
+  int z = CellCoordinate(position.z);
+  minX = std::min(minX, x);
+  maxX = std::max(maxX, x);
+  minZ = std::min(minZ, z);
+  maxZ = std::max(maxZ, z);
+  std::vector<IEntity*>& cell = cells[Key(x, z)];
+  entries[entity->GetId()] = Entry{Key(x, z), static_cast<int>(cell.size())};
+  cell.push_back(entity);
+}
+
+void SpatialHash::Remove(const IEntity* entity) {
+  std::unordered_map<int, Entry>::iterator found =
+    entries.find(entity->GetId());
+  if (found == entries.end()) {
+    return;
+  }
+  Entry entry = found->second;
+  entries.erase(found);
+
+  std::vector<IEntity*>& cell = cells[entry.cell];
+  cell[entry.slot] = cell.back();
+  cell.pop_back();
+  if (entry.slot < cell.size()) {
+    entries[cell[entry.slot]->GetId()].slot = entry.slot;
+  }
+  if (cell.empty()) {
+    cells.erase(entry.cell);
+  }
+}
+
+void SpatialHash::Update(IEntity* entity) {
+  std::unordered_map<int, Entry>::const_iterator found =
+    entries.find(entity->GetId());
+  if (found == entries.end()) {
+    return;
+  }
+  Vector3 position = entity->GetPosition();
+  if (found->second.cell ==
+      Key(CellCoordinate(position.x), CellCoordinate(position.z))) {
+    return;
+  }
+  Remove(entity);
+  Insert(entity);
+}
+
+void SpatialHash::Radius(Vector3 center, float radius,
+                         std::vector<IEntity*>& result,
+                         const Filter& filter) const {
+  result.clear();
+  int x0 = std::max(minX, CellCoordinate(center.x - radius));
+  int x1 = std::min(maxX, CellCoordinate(center.x + radius));
+  int z0 = std::max(minZ, CellCoordinate(center.z - radius));
+  int z1 = std::min(maxZ, CellCoordinate(center.z + radius));
+  if (x0 > x1 || z0 > z1) {
+    return;
+  }
+
+  auto visit = [&](const std::vector<IEntity*>& cell) {
+    for (IEntity* entity : cell) {
+      if ((!filter || filter(entity)) &&
+          center.Distance(entity->GetPosition()) <= radius) {
+        result.push_back(entity);
+      }
+    }
+  };
+  if ((x1 - x0 + 1) * static_cast<int64_t>(z1 - z0 + 1) > cells.size()) {
+    // a large radius covers more cells than are occupied
+    for (const auto& cell : cells) {
+      int x = static_cast<int>(cell.first >> 32);
+      int z = static_cast<int32_t>(cell.first & 0xffffffff);
+      if (x >= x0 && x <= x1 && z >= z0 && z <= z1) {
+        visit(cell.second);
+      }
+    }
+    return;
+  }
+  for (int x = x0; x <= x1; x++) {
+    for (int z = z0; z <= z1; z++) {
+      auto cell = cells.find(Key(x, z));
+      if (cell != cells.end()) {
+        visit(cell->second);
+      }
+    }
+  }
+}
+
+void SpatialHash::Nearest(Vector3 center, int k,
+                          std::vector<IEntity*>& result,
+                          const Filter& filter) const {
+  result.clear();
+  if (k <= 0 || entries.empty()) {
+    return;
+  }
+  // farthest candidate on top; ties go to the lower id
+  typedef std::pair<float, IEntity*> Candidate;
+  auto closer = [](const Candidate& a, const Candidate& b) {
+    return a.first != b.first ? a.first < b.first
+                              : a.second->GetId() < b.second->GetId();
+  };
+  std::priority_queue<Candidate, std::vector<Candidate>, decltype(closer)>
+    best(closer);
+
+  auto visit = [&](int x, int z) {
+    auto cell = cells.find(Key(x, z));
+    if (cell == cells.end()) {
+      return;
+    }
+    for (IEntity* entity : cell->second) {
+      if (filter && !filter(entity)) {
+        continue;
+      }
+      Candidate candidate(center.Distance(entity->GetPosition()), entity);
+      if (best.size() < k) {
+        best.push(candidate);
+      } else if (closer(candidate, best.top())) {
+        best.pop();
+        best.push(candidate);
+      }
+    }
+  };
+
+  // rings of cells around the center's cell; every cell of ring r is more
+  // than (r - 1) cells away, so the search stops once that is farther than
+  // the k-th candidate or the ring has left the occupied area
+  int cx = CellCoordinate(center.x);
+  int cz = CellCoordinate(center.z);
+  int rings = std::max(std::max(std::abs(cx - minX), std::abs(maxX - cx)),
+                       std::max(std::abs(cz - minZ), std::abs(maxZ - cz)));
+  for (int r = 0; r <= rings; r++) {
+    if (best.size() == k && best.top().first <= (r - 1) * cellSize) {
+      break;
+    }
+    if (r == 0) {
+      visit(cx, cz);
+      continue;
+    }
+    for (int d = -r; d <= r; d++) {
+      visit(cx + d, cz - r);
+      visit(cx + d, cz + r);
+    }
+    for (int d = -r + 1; d <= r - 1; d++) {
+      visit(cx - r, cz + d);
+      visit(cx + r, cz + d);
+    }
+  }
+
+  result.resize(best.size());
+  for (int i = result.size() - 1; i >= 0; i--) {
+    result[i] = best.top().second;
+    best.pop();
+  }
+}
+
+IEntity* SpatialHash::Nearest(Vector3 center, const Filter& filter) const {
+  std::vector<IEntity*> result;
+  Nearest(center, 1, result, filter);
+  return result.empty() ? nullptr : result[0];
+}
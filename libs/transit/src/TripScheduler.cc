@@ -0,0 +1,240 @@
+#include "TripScheduler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "Drone.h"
+#include "segment_index.h"
+#include "util/assignment.h"
+
+const int TripScheduler::MAX_BATCH;
+const int TripScheduler::CANDIDATES;
+
+void TripScheduler::AddRobot(IEntity* robot) {
+  robots[robot->GetName()].push_back(robot);
+}
+
+void TripScheduler::RemoveRobot(const IEntity* robot) {
+  auto found = robots.find(robot->GetName());
+  if (found == robots.end()) {
+    return;
+  }
+  std::vector<IEntity*>& named = found->second;
+  named.erase(std::remove(named.begin(), named.end(), robot), named.end());
+  if (named.empty()) {
+    robots.erase(found);
+  }
+  queued.erase(robot->GetId());
+  underway.erase(robot->GetId());
+}
+
+IEntity* TripScheduler::FindRobot(const std::string& name) const {
+  auto found = robots.find(name);
+  if (found == robots.end()) {
+    return nullptr;
+  }
+  for (IEntity* robot : found->second) {
+    if (robot->GetAvailability() && queued.count(robot->GetId()) == 0) {
+      return robot;
+    }
+  }
+  return nullptr;
+}
+
+bool TripScheduler::Schedule(const std::string& name, Vector3 end,
+                             const std::string& strategy, int priority) {
+  IEntity* robot = FindRobot(name);
+  if (!robot) {
+    return false;
+  }
+  robot->SetDestination(end);
+  robot->SetStrategyName(strategy);
+  pending[priority].push_back(Trip{robot->GetId(), robot, now});
+  queued.insert(robot->GetId());
+  arrived = true;
+  stats.scheduled++;
+  return true;
+}
+
+void TripScheduler::AddDrone(Drone* drone) {
+  idle.Insert(drone);
+}
+
+void TripScheduler::Delivered(Drone* drone, const IEntity* robot) {
+  auto trip = underway.find(robot->GetId());
+  if (trip != underway.end()) {
+    stats.delivered++;
+    stats.tripTime += now - trip->second;
+    underway.erase(trip);
+  }
+  AddDrone(drone);
+}
+
+void TripScheduler::SetRoadNetwork(
+    std::shared_ptr<const routing::GraphSnapshot> snapshot) {
+  roads = snapshot;
+}
+
+int TripScheduler::Update(double dt) {
+  now += dt;
+  if (!arrived && now < nextDispatch) {
+    return 0;
+  }
+  arrived = false;
+  nextDispatch = now + DISPATCH_INTERVAL;
+  return Dispatch();
+}
+
+int TripScheduler::Dispatch() {
+  int dispatched = 0;
+  auto tier = pending.begin();
+  while (tier != pending.end() && idle.Size() > 0) {
+    int solved = Solve(tier->second);
+    dispatched += solved;
+    if (tier->second.empty()) {
+      tier = pending.erase(tier);
+    } else if (solved == 0) {
+      break;
+    }
+  }
+  return dispatched;
+}
+
+int TripScheduler::Solve(std::deque<Trip>& waiting) {
+  // the oldest trips, skipping those of robots removed since
+  std::vector<Trip> batch;
+  while (!waiting.empty() && batch.size() < MAX_BATCH) {
+    if (queued.count(waiting.front().id)) {
+      batch.push_back(waiting.front());
+    }
+    waiting.pop_front();
+  }
+  if (batch.empty()) {
+    return 0;
+  }
+
+  std::vector<Drone*> drones = Candidates(batch);
+  std::vector<Anchor> robotAnchors;
+  for (const Trip& trip : batch) {
+    robotAnchors.push_back(AnchorOf(trip.robot->GetPosition()));
+  }
+  std::vector<Anchor> droneAnchors;
+  for (Drone* drone : drones) {
+    droneAnchors.push_back(AnchorOf(drone->GetPosition()));
+  }
+  int rows = batch.size();
+  int cols = drones.size();
+  std::vector<double> distances(rows * cols);
+  std::vector<double> cost(rows * cols);
+  for (int i = 0; i < rows; i++) {
+    // only decides between trips when there are fewer drones than trips
+    double credit = WAIT_WEIGHT * (now - batch[i].time);
+    for (int j = 0; j < cols; j++) {
+      distances[i * cols + j] =
+        PickupDistance(droneAnchors[j], robotAnchors[i]);
+      cost[i * cols + j] = distances[i * cols + j] - credit;
+    }
+  }
+  std::vector<int> match = routing::SolveAssignment(cost, rows, cols);
+
+  int solved = 0;
+  for (int i = 0; i < rows; i++) {
+    if (match[i] < 0) {
+      continue;
+    }
+    Drone* drone = drones[match[i]];
+    queued.erase(batch[i].id);
+    idle.Remove(drone);
+    drone->Pickup(batch[i].robot);
+    underway[batch[i].id] = batch[i].time;
+    stats.dispatched++;
+    stats.waited += now - batch[i].time;
+    stats.pickupDistance += distances[i * cols + match[i]];
+    solved++;
+  }
+  // the trips left over go back in front, in their order
+  for (int i = rows - 1; i >= 0; i--) {
+    if (match[i] < 0) {
+      waiting.push_front(batch[i]);
+    }
+  }
+  return solved;
+}
+
+std::vector<Drone*> TripScheduler::Candidates(
+    const std::vector<Trip>& batch) const {
+  // roads are never shorter than the straight line, so the drones nearest
+  // in a straight line are the likely best; widen the search until there
+  // are enough of them for every trip
+  int wanted = std::min<int>(batch.size(), idle.Size());
+  std::vector<Drone*> drones;
+  std::vector<IEntity*> nearest;
+  std::unordered_set<int> seen;
+  for (int k = CANDIDATES; ; k *= 2) {
+    drones.clear();
+    seen.clear();
+    for (const Trip& trip : batch) {
+      idle.Nearest(trip.robot->GetPosition(), k, nearest);
+      for (IEntity* entity : nearest) {
+        if (seen.insert(entity->GetId()).second) {
+          // only drones are added to the index
+          drones.push_back(static_cast<Drone*>(entity));
+        }
+      }
+    }
+    if (drones.size() >= wanted || k >= idle.Size()) {
+      return drones;
+    }
+  }
+}
+
+TripScheduler::Anchor TripScheduler::AnchorOf(Vector3 position) const {
+  Anchor anchor;
+  anchor.position = position;
+  anchor.gap = 0;
+  anchor.nodes[0] = anchor.nodes[1] = -1;
+  anchor.along[0] = anchor.along[1] = 0;
+  if (!roads || !roads->GetHubLabels()) {
+    return anchor;
+  }
+  routing::EdgePoint point;
+  if (!roads->GetGraph()->NearestEdgePoint(
+        {position.x, position.y, position.z}, point)) {
+    return anchor;
+  }
+  const routing::CompactGraph& compact =
+    roads->GetHubLabels()->GetCompactGraph();
+  const routing::IGraphNode* ends[2] = {point.from, point.to};
+  Vector3 onEdge(point.position[0], point.position[1], point.position[2]);
+  anchor.gap = position.Distance(onEdge);
+  for (int i = 0; i < 2; i++) {
+    std::vector<float> end = ends[i]->GetPosition();
+    anchor.nodes[i] = compact.IndexOf(ends[i]);
+    anchor.along[i] = onEdge.Distance(Vector3(end[0], end[1], end[2]));
+  }
+  return anchor;
+}
+
+double TripScheduler::PickupDistance(const Anchor& from,
+                                     const Anchor& to) const {
+  Vector3 start = from.position;
+  double straight = start.Distance(to.position);
+  double road = std::numeric_limits<double>::infinity();
+  for (int a = 0; a < 2; a++) {
+    for (int b = 0; b < 2; b++) {
+      if (from.nodes[a] < 0 || to.nodes[b] < 0) {
+        continue;
+      }
+      double distance = from.along[a] +
+        roads->GetHubLabels()->Distance(from.nodes[a], to.nodes[b]) +
+        to.along[b];
+      road = std::min(road, distance);
+    }
+  }
+  // no road network, or no road between them
+  if (!std::isfinite(road)) {
+    return straight;
+  }
+  return from.gap + road + to.gap;
+}
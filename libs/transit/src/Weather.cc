@@ -14,187 +14,147 @@ Weather* Weather::GetInstance() {
   return &GLOBAL_WEATHER;
 }
 
+// indexed by WeatherKind
+static const char* const NAMES[] = {
+  "normal", "snow", "tornado", "rain", "hot", "hurricane"
+};
+static const char* const ANNOUNCEMENTS[] = {
+  "Weather: Default \U0001F601\n\n",
+  "Weather: Heavy Snow! \U0001F328\n\n",
+  "Weather: Tornado Warning! \U0001F32A\n\n",
+  "Weather: Light Rain \U0001F327\n\n",
+  "Weather: Blazing Hot! \U0001FAE0\n\n",
+  "Weather: Hurricane Warning! \U0001F6A8\n\n"
+};
+
 /*
   Weather::Update is called from SimulationModel::Update,
   which makes this is a repeated call.
 
-  Weather::Update calls each type of weather, which goes on and
-  applies it's own unique effect to the simulation, only if the
-  forecast condition is met.
-
   Upon weather completion:
-  (1) if any changes were made, then we revert them.
+  (1) the weather's effects are undone,
   (2) reset the time,
-  (3) get a new weather based on it's probability
+  (3) get a new weather based on it's probability, and apply its
+      effects.
+
+  Effects are only applied and undone on these transitions, so in
+  between an update just advances the time.
 */
-void Weather::Update(double dt, std::vector<IEntity*>& entities) {
-  if (IsCompleted()) {
-    if (Forecast() != "normal") {
-      Revert(entities);
-    }
+void Weather::Update(double dt, EntityStore& entities, IController& CON,
+                     std::vector<IEntity*>& ENT) {
+  if (!begun) {
+    Enter(entities, CON, ENT);
+    begun = true;
+  } else if (IsCompleted()) {
+    Exit(entities, CON);
     time = 0.0;
-    index = val(GEN);
-    run = true;
+    current = static_cast<WeatherKind>(val(GEN));
+    Enter(entities, CON, ENT);
   }
-
-  Normal();
-  Snow(entities);
-  Tornado(entities);
-  Rain();
-  Hot(entities);
-  Hurricane(entities);
-
   time += dt;
 }
 
-void Weather::Normal() {
-  if (Forecast() == "normal") {
-    if (run) {
-      toPublisher->SendEvents("Weather: Default \U0001F601\n\n");
-      run = false;
-    }
+void Weather::Join(IEntity& entity, IController& CON) {
+  // a new entity's factor is 1, so GetSpeed is its natural speed
+  entity.SetSpeedFactor(SpeedFactor(entity.GetKind(), entity.GetSpeed()));
+  if (current == WeatherKind::HURRICANE ||
+      (current == WeatherKind::TORNADO &&
+       entity.GetKind() == EntityKind::SATELLITE)) {
+    Hide(entity, CON);
   }
 }
 
-/*
-  Weather::Snow applies a "heavy snow" weather condition,
-  
-  All entities, except for humans, are slowed down to 50%
-  of their natural speed.
-
-  Whereas, human entities stop moving. We do this for safety
-  pre-cautions. We wouldn't want our beloved humans to get hurt
-  by slipping on ice.
-*/
-void Weather::Snow(std::vector<IEntity*>& entities) {
-  if (Forecast() == "snow") {
-    if (run) {
-      toPublisher->SendEvents("Weather: Heavy Snow! \U0001F328\n\n");
-      run = false;
-    }
-    // all entities speed cuts to half,
-    for (int i = 0; i < entities.size(); ++i) {
-      float speed = entities[i]->GetSpeed();
-      if (prev[entities[i]->GetId()] == 0) {
-        if (speed > 10.0) {
-          prev[entities[i]->GetId()] = speed;
-          entities[i]->SetSpeed(speed / 2.0);
-        }
-      }
-      // except humans => stop moving
-      details = entities[i]->GetDetails();
-      std::string type = details["type"];
-      if (type == "human") {
-        if (speed > 1) {
-          prev[entities[i]->GetId()] = speed;
-          entities[i]->SetSpeed(0.0);
-        }
-      }
-    }
-  }
+// only snow, tornadoes, hurricanes and the heat change speeds
+static bool ChangesSpeeds(WeatherKind kind) {
+  return kind != WeatherKind::NORMAL && kind != WeatherKind::RAIN;
 }
 
-/*
-  Weather::Tornado gives a tornado warning.
-
-  All entities are to stop moving, take cover and wait for
-  the tornado to pass.
-
-  Our very own Satellite, is to go back into orbit, since
-  replacing one requires a hefty sum. We wouldn't want it to 
-  get destroyed now would we?
-*/
-void Weather::Tornado(std::vector<IEntity*>& entities) {
-  if (Forecast() == "tornado") {
-    if (run) {
-      toPublisher->SendEvents("Weather: Tornado Warning! \U0001F32A\n\n");
-      run = false;
+void Weather::Enter(EntityStore& entities, IController& CON,
+                    std::vector<IEntity*>& ENT) {
+  toPublisher->SendEvents(ANNOUNCEMENTS[static_cast<int>(current)]);
+  if (ChangesSpeeds(current)) {
+    std::vector<float>& factors = entities.GetSpeedFactors();
+    const std::vector<float>& speeds = entities.GetSpeeds();
+    const std::vector<EntityKind>& kinds = entities.GetKinds();
+    for (int i = 0; i < entities.Size(); ++i) {
+      factors[i] = SpeedFactor(kinds[i], speeds[i]);
     }
-    // all entities stop moving
-    for (int i = 0; i < entities.size(); ++i) {
-      float speed = entities[i]->GetSpeed();
-      if (speed > 1) {
-        prev[entities[i]->GetId()] = speed;
-        entities[i]->SetSpeed(0.0);
-      }
+  }
+  // our very own satellite goes back into orbit during a tornado, and
+  // a hurricane takes everything out of the view
+  for (IEntity* entity : ENT) {
+    if (current == WeatherKind::HURRICANE ||
+        (current == WeatherKind::TORNADO &&
+         entity->GetKind() == EntityKind::SATELLITE)) {
+      Hide(*entity, CON);
     }
   }
 }
 
-void Weather::Rain() {
-  if (Forecast() == "rain") {
-    if (run) {
-      toPublisher->SendEvents("Weather: Light Rain \U0001F327\n\n");
-      run = false;
-    }
+void Weather::Exit(EntityStore& entities, IController& CON) {
+  if (ChangesSpeeds(current)) {
+    std::vector<float>& factors = entities.GetSpeedFactors();
+    std::fill(factors.begin(), factors.end(), 1.0f);
+  }
+  if (shown) {
+    CON.RemoveEntity(RemoveHelper(*Model(current), "RemoveFromView"));
+    shown = false;
   }
+  for (IEntity* entity : hidden) {
+    CON.RemoveEntity(RemoveHelper(*entity, "AddToView"));
+  }
+  hidden.clear();
 }
 
 /*
-  Weather::Hot applies a "blazing hot" weather condition,
+  Weather::SpeedFactor gives the effect of each weather on speeds.
+
+  Heavy snow slows all entities down to 50% of their natural speed,
+  except for humans, who stop moving. We do this for safety
+  pre-cautions. We wouldn't want our beloved humans to get hurt
+  by slipping on ice.
+
+  During a tornado or a hurricane all entities are to stop moving,
+  take cover and wait for it to pass.
 
-  All entities, except satellite, are to speed up. We want
-  to get to our destinations as soon as possible, because this
-  weather isn't to play around with.
+  When it is blazing hot all entities speed up. We want to get to
+  our destinations as soon as possible, because this weather isn't
+  to play around with.
+
+  Only drones and humans move under their own power: robots are
+  carried and satellites keep their orbit.
 */
-void Weather::Hot(std::vector<IEntity*>& entities) {
-  if (Forecast() == "hot") {
-    if (run) {
-      toPublisher->SendEvents("Weather: Blazing Hot! \U0001FAE0\n\n");
-      run = false;
-    }
-    // entities, except satellite, speed gets doubled
-    for (int i = 0; i < entities.size(); ++i) {
-      details = entities[i]->GetDetails();
-      std::string type = details["type"];
-      if (type != "satellite") {
-        float speed = entities[i]->GetSpeed();
-        if (prev.count(entities[i]->GetId()) == 0) {
-          prev[entities[i]->GetId()] = speed;
-          entities[i]->SetSpeed(speed * 2.0);
-        }
-      }
-    }
+float Weather::SpeedFactor(EntityKind kind, float speed) const {
+  if (kind != EntityKind::DRONE && kind != EntityKind::HUMAN) {
+    return 1.0;
   }
-}
-
-void Weather::Hurricane(std::vector<IEntity*>& entities) {
-  if (Forecast() == "hurricane") {
-    if (run) {
-      toPublisher->SendEvents("Weather: Hurricane Warning! \U0001F6A8\n\n");
-      run = false;
-    }
-    // all entities stop moving
-    for (int i = 0; i < entities.size(); ++i) {
-      float speed = entities[i]->GetSpeed();
-      if (speed > 1) {
-        prev[entities[i]->GetId()] = speed;
-        entities[i]->SetSpeed(0.0);
+  switch (current) {
+    case WeatherKind::SNOW:
+      if (kind == EntityKind::HUMAN) {
+        return 0.0;
       }
-    }
+      return speed > 10.0 ? 0.5 : 1.0;
+    case WeatherKind::TORNADO:
+    case WeatherKind::HURRICANE:
+      return 0.0;
+    case WeatherKind::HOT:
+      return 2.0;
+    default:
+      return 1.0;
   }
 }
 
-/*
-  Weather::Revert uses std::map which has all the entities
-  default speeds stored into it. Before any changes were made
-  to the entities we saved their previous info and now to revert
-  back those changes we just reapply their defaults.
-*/
-void Weather::Revert(std::vector<IEntity*>& entities) {
-  for (int i = 0; i < entities.size(); ++i) {
-    if (prev.find(entities[i]->GetId()) != prev.end()) {
-      entities[i]->SetSpeed(prev[entities[i]->GetId()]);
-    }
-  }
-  prev.clear();
+void Weather::Hide(IEntity& entity, IController& CON) {
+  hidden.push_back(&entity);
+  CON.RemoveEntity(RemoveHelper(entity, "RemoveFromView"));
 }
 
-std::string Weather::Forecast() {
-  return weather.at(index);
+IEntity* Weather::Model(WeatherKind kind) const {
+  auto found = GFX.find(kind);
+  return found == GFX.end() ? nullptr : found->second;
 }
 
-bool Weather::IsCompleted() {
+bool Weather::IsCompleted() const {
   return time > 60.0;
 }
 
@@ -207,17 +167,16 @@ bool Weather::IsCompleted() {
 */
 bool Weather::CreateGFX(JsonObject& obj, IController& CON) {
   std::string type = obj["type"];
-  if (
-    type.compare("hot") == 0 ||
-    type.compare("snow") == 0 ||
-    type.compare("rain") == 0 ||
-    type.compare("tornado") == 0 ||
-    type.compare("hurricane") == 0
-  ) {
-    GFX[type] = new WeatherGFX(obj);
-    CON.AddEntity(*GFX.at(type));
-    return true;
-  } return false;
+  // the normal weather has no model
+  for (int kind = 1; kind < 6; ++kind) {
+    if (type == NAMES[kind]) {
+      IEntity* model = new WeatherGFX(obj, gfxStore);
+      GFX[static_cast<WeatherKind>(kind)] = model;
+      CON.AddEntity(*model);
+      return true;
+    }
+  }
+  return false;
 }
 
 /*
@@ -230,41 +189,18 @@ bool Weather::CreateGFX(JsonObject& obj, IController& CON) {
   through here.
 */
 void Weather::UpdateGFX(double dt, IController& CON) {
-  if (Forecast() == "snow") {
-    if (restore == "none") {
-      restore = "snow";
-      CON.RemoveEntity(RemoveHelper(*GFX.at(restore), "AddToView"));
-    }
-
-  } else if (Forecast() == "tornado") {
-    if (restore == "none") {
-      restore = "tornado";
-      CON.RemoveEntity(RemoveHelper(*GFX.at(restore), "AddToView"));
-    }
-    if (restore == "tornado") {
-      GFX.at("tornado")->Update(dt, {GFX.at("tornado")});
-      CON.UpdateEntity(*GFX.at("tornado"));
-    }
-
-  } else if (Forecast() == "rain") {
-    if (restore == "none") {
-      restore = "rain";
-      CON.RemoveEntity(RemoveHelper(*GFX.at(restore), "AddToView"));
-    }
-
-  } else if (Forecast() == "hot") {
-    if (restore == "none") {
-      restore = "hot";
-      CON.RemoveEntity(RemoveHelper(*GFX.at(restore), "AddToView"));
-    }
-
-  } else if (Forecast() == "hurricane") {
-    if (time > 10.0) {
-      if (restore == "none") {
-        restore = "hurricane";
-        CON.RemoveEntity(RemoveHelper(*GFX.at(restore), "AddToView"));
-      }
-    }
+  IEntity* model = Model(current);
+  if (!model) {
+    return;
+  }
+  // the hurricane only shows up after 10 seconds
+  if (!shown && (current != WeatherKind::HURRICANE || time > 10.0)) {
+    CON.RemoveEntity(RemoveHelper(*model, "AddToView"));
+    shown = true;
+  }
+  if (current == WeatherKind::TORNADO) {
+    model->Update(dt);
+    CON.UpdateEntity(*model);
   }
 }
 
@@ -284,88 +220,33 @@ JsonObject Weather::RemoveHelper(const IEntity& ENT, const std::string& VU) {
 }
 
 /*
-  Responsible for weather model behaviors with entities.
-
-  Weather::TornadoAct takes care of scenarios where the tornado
-  makes contact with any of the entities,
-
-  Weather::HurricaneAct removes all entities from the view for its
-  period of weather.
+  Weather::TornadoStrike takes care of scenarios where the tornado
+  makes contact with any of the entities.
 */
 using namespace std;
-void Weather::Run(const int c, IController& CON, vector<IEntity*>& ENT) {
-  TornadoAct(c, CON, ENT);
-  HurricaneAct(c, CON, ENT);
-}
-
-void Weather::TornadoAct(
-  const int c, IController& CON, vector<IEntity*>& ENT) {
-  if (Forecast() == "tornado") {
-    string type = ENT[c]->GetDetails()["type"];
-
-    if (type == "satellite" && GFX.count(type) == 0) {
-      GFX[type] = ENT[c];
-      JsonObject details;
-      CON.RemoveEntity(RemoveHelper(*ENT[c], "RemoveFromView"));
-    } else if (type == "robot") {
-      string status = ENT[c]->GetDetails()["status"];
-      if (status == "delete") {
-        Vector3 pos(ENT[c]->GetPosition());
-        Vector3 GFXPos(GFX.at("tornado")->GetPosition());
-        if (GFXPos.Distance(pos) < 100) {
-          string name = ENT[c]->GetDetails()["name"];
-          CON.RemoveEntity(RemoveHelper(*ENT[c], "NotAssigned"));
-          ENT.erase(ENT.begin() + c);
-          toPublisher->SendEvents(
-            "Tornado: Erased " + name + " \U0001F494\n\n");
-        }
-      }
-    } else if (type == "human") {
-      Vector3 pos(ENT[c]->GetPosition());
-      Vector3 GFXPos(GFX.at("tornado")->GetPosition());
-      if (GFXPos.Distance(pos) < 100) {
-        string name = ENT[c]->GetDetails()["name"];
-        CON.RemoveEntity(RemoveHelper(*ENT[c], "NotAssigned"));
-        ENT.erase(ENT.begin() + c);
-        toPublisher->SendEvents("Tornado: Erased " + name + " \U0001F494\n\n");
-      }
-    }
+vector<IEntity*> Weather::TornadoStrike(
+  IController& CON, vector<IEntity*>& ENT, SpatialHash& index) {
+  vector<IEntity*> struck;
+  IEntity* tornado = Model(WeatherKind::TORNADO);
+  if (current != WeatherKind::TORNADO || !tornado) {
+    return struck;
   }
-}
-
-void Weather::HurricaneAct(int c, IController& CON, vector<IEntity*>& ENT) {
-  if (Forecast() == "hurricane") {
-    string tag = std::to_string(ENT[c]->GetId());
-    if (GFX.count(tag) == 0) {
-      GFX[tag] = ENT[c];
-      CON.RemoveEntity(RemoveHelper(*ENT[c], "RemoveFromView"));
-    }
-  }
-}
-
-/*
-  Called in SimulationModel::Update
-
-  Ensures, all the front-end changes are reveresed after weather changes.
-*/
-void Weather::Reverse(IController& CON, vector<IEntity*>& ENT) {
-  if (restore != "none" && IsCompleted()) {
-    CON.RemoveEntity(RemoveHelper(*GFX.at(restore), "RemoveFromView"));
-    restore = "none";
-  }
-
-  if (Forecast() == "tornado" && IsCompleted()) {
-    if (GFX.count("satellite") == 1) {
-      CON.RemoveEntity(RemoveHelper(*GFX.at("satellite"), "AddToView"));
-      GFX.erase("satellite");
-    }
-  } else if (Forecast() == "hurricane" && IsCompleted()) {
-    for (int i = 0; i < ENT.size(); i++) {
-      string tag = std::to_string(ENT[i]->GetId());
-      if (GFX.count(tag) == 1) {
-        CON.RemoveEntity(RemoveHelper(*ENT[i], "AddToView"));
-        GFX.erase(tag);
-      }
-    }
+  index.Radius(tornado->GetPosition(), 100, struck,
+               [](const IEntity* entity) {
+    if (entity->GetKind() == EntityKind::HUMAN) {
+      return true;
+    }
+    if (entity->GetKind() == EntityKind::ROBOT) {
+      return entity->GetStatus() == EntityStatus::DELIVERED;
+    }
+    return false;
+  });
+  for (IEntity* entity : struck) {
+    const string& name = entity->GetName();
+    CON.RemoveEntity(RemoveHelper(*entity, "NotAssigned"));
+    ENT.erase(std::find(ENT.begin(), ENT.end(), entity));
+    index.Remove(entity);
+    toPublisher->SendEvents("Tornado: Erased " + name + " \U0001F494\n\n");
   }
+  return struck;
 }
@@ -0,0 +1,41 @@
+#include <utility>
+#include <vector>
+
+#include "CommitBuffer.h"
+#include "gtest/gtest.h"
+
+TEST(CommitBufferTest, CommitsByEntityThenPushOrder) {
+  std::vector<std::pair<int, int> > log;
+  auto record = [&log](int entity, int step) {
+    return [&log, entity, step]() { log.push_back({entity, step}); };
+  };
+
+  // entities spread over three workers' buffers, out of id order
+  std::vector<CommitBuffer> buffers(3);
+  buffers[0].Push(7, record(7, 0));
+  buffers[2].Push(2, record(2, 0));
+  buffers[0].Push(7, record(7, 1));
+  buffers[1].Push(5, record(5, 0));
+  buffers[2].Push(2, record(2, 1));
+  buffers[0].Push(1, record(1, 0));
+  buffers[2].Push(2, record(2, 2));
+  buffers[1].Push(5, record(5, 1));
+
+  EXPECT_EQ(8, CommitBuffer::Commit(buffers));
+  std::vector<std::pair<int, int> > expected = {
+    {1, 0}, {2, 0}, {2, 1}, {2, 2}, {5, 0}, {5, 1}, {7, 0}, {7, 1}};
+  EXPECT_EQ(expected, log);
+  for (const CommitBuffer& buffer : buffers) {
+    EXPECT_EQ(0, buffer.Size());
+  }
+}
+
+TEST(CommitBufferTest, RunsEachActionOnce) {
+  std::vector<CommitBuffer> buffers(2);
+  std::vector<int> log;
+  buffers[1].Push(3, [&log]() { log.push_back(3); });
+  buffers[0].Push(4, [&log]() { log.push_back(4); });
+  EXPECT_EQ(2, CommitBuffer::Commit(buffers));
+  EXPECT_EQ(0, CommitBuffer::Commit(buffers));
+  EXPECT_EQ(std::vector<int>({3, 4}), log);
+}
@@ -0,0 +1,101 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "util/job_system.h"
+
+using routing::JobSystem;
+
+namespace {
+
+// Runs one loop and checks that every index in [0, count) was visited once,
+// by ranges of at most grain items, on valid worker ids.
+void ExpectCoverage(JobSystem& jobs, int count, int grain) {
+  std::vector<std::atomic<int> > hits(count);
+  for (std::atomic<int>& hit : hits) {
+    hit = 0;
+  }
+  std::atomic<bool> badRange(false);
+  jobs.ParallelFor(count, grain, [&](int begin, int end, int worker) {
+    if (begin >= end || end - begin > std::max(grain, 1) || worker < 0 ||
+        worker >= jobs.NumThreads()) {
+      badRange = true;
+    }
+    for (int i = begin; i < end; i++) {
+      hits[i]++;
+    }
+  });
+  EXPECT_FALSE(badRange) << "count " << count << " grain " << grain;
+  for (int i = 0; i < count; i++) {
+    ASSERT_EQ(1, hits[i].load()) << "index " << i << " of " << count
+                                 << ", grain " << grain;
+  }
+}
+
+}  // namespace
+
+TEST(JobSystemTest, CoversEveryIndexOnce) {
+  for (int threads : {1, 2, 3, 8}) {
+    JobSystem jobs(threads);
+    ASSERT_EQ(threads, jobs.NumThreads());
+    for (int grain : {0, 1, 7, 64, 5000}) {
+      for (int count : {0, 1, 2, 63, 1000, 10007}) {
+        ExpectCoverage(jobs, count, grain);
+      }
+    }
+  }
+}
+
+TEST(JobSystemTest, RethrowsTheBodysException) {
+  JobSystem jobs(4);
+  std::atomic<int> ran(0);
+  EXPECT_THROW(jobs.ParallelFor(1000, 10,
+                                [&](int begin, int end, int worker) {
+                                  ran += end - begin;
+                                  if (begin <= 500 && 500 < end) {
+                                    throw std::runtime_error("item 500");
+                                  }
+                                }),
+               std::runtime_error);
+  // the other ranges still ran, and the system takes the next loop
+  EXPECT_EQ(1000, ran.load());
+  ExpectCoverage(jobs, 1000, 10);
+
+  JobSystem single(1);
+  EXPECT_THROW(single.ParallelFor(10, 1,
+                                  [](int begin, int end, int worker) {
+                                    throw std::logic_error("inline");
+                                  }),
+               std::logic_error);
+}
+
+TEST(JobSystemTest, RunsBackToBackLoops) {
+  JobSystem jobs(4);
+  // loops this small are usually over before the other workers wake up, so
+  // they join a later loop (or none) instead of the one that woke them
+  for (int loop = 0; loop < 2000; loop++) {
+    ExpectCoverage(jobs, 1 + loop % 9, 1);
+  }
+}
+
+TEST(JobSystemTest, WaitsForSlowRanges) {
+  JobSystem jobs(3);
+  for (int loop = 0; loop < 20; loop++) {
+    std::atomic<int> running(0);
+    std::atomic<int> total(0);
+    jobs.ParallelFor(12, 1, [&](int begin, int end, int worker) {
+      running++;
+      if (worker != 0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+      }
+      total += end - begin;
+      running--;
+    });
+    ASSERT_EQ(0, running.load());
+    ASSERT_EQ(12, total.load());
+  }
+}